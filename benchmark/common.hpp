@@ -0,0 +1,51 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef BENCHMARK_COMMON_HPP
+#define BENCHMARK_COMMON_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+// Run the function the given number of times and return the best time in seconds.
+template<typename Fun>
+double measure(Fun&& fun, int repeats = 5)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fun();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Print a single line of the benchmark report.
+inline void report(const std::string& name, double seconds, double baseline_seconds)
+{
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(4)
+              << seconds << " s"
+              << std::setw(10) << std::setprecision(2)
+              << baseline_seconds / seconds << "x" << std::endl;
+}
+
+// Prevent the compiler from optimizing away the given value.
+template<typename T>
+void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the throughput of the CSV parsers on a generated 16 MB CSV with
+// numeric, textual, quoted and escaped fields. The scan of the structural
+// characters is measured separately for the scalar loop and detail::find_either
+// (which uses SSE2 or AVX2 depending on the compiler flags, e.g., -march=native).
+// Finally, the parsed dataframe is written back by write_csv and write_csv_parallel.
+
+#include "../common.hpp"
+
+#include <cxtream/core/csv.hpp>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace cxtream;
+
+std::string generate_csv(std::size_t size)
+{
+    std::mt19937 gen{1000003};
+    std::uniform_int_distribution<int> int_dist{0, 100000};
+    std::uniform_real_distribution<double> real_dist{-1000, 1000};
+    std::uniform_int_distribution<int> word_dist{0, 5};
+    const char* words[] = {"alpha", "beta", "gamma delta", "epsilon", "zeta", "eta theta iota"};
+    std::ostringstream out;
+    out << "id,count,value,name,description,score,category,note\n";
+    for (long i = 0; static_cast<std::size_t>(out.tellp()) < size; ++i) {
+        out << i << ',' << int_dist(gen) << ',' << real_dist(gen) << ','
+            << words[word_dist(gen)] << ','
+            << '"' << words[word_dist(gen)] << ", " << words[word_dist(gen)] << '"' << ','
+            << real_dist(gen) << ',' << words[word_dist(gen)] << ',';
+        if (i % 10 == 0) out << R"("escaped \"quote\"")";
+        else out << words[word_dist(gen)];
+        out << '\n';
+    }
+    return out.str();
+}
+
+void report_throughput(const std::string& name, double seconds, double baseline_seconds,
+                       std::size_t bytes)
+{
+    report(name, seconds, baseline_seconds);
+    std::cout << std::setw(40) << "" << std::setw(12) << std::setprecision(3)
+              << bytes / seconds / 1e9 << " GB/s" << std::endl;
+}
+
+// count the fields by iterating over all the rows
+template<typename Rng>
+std::size_t count_fields(Rng&& rng)
+{
+    std::size_t n = 0;
+    for (auto&& row : rng) n += row.size();
+    return n;
+}
+
+int main()
+{
+    const std::string csv = generate_csv(16 << 20);
+    const char* first = csv.data();
+    const char* last = csv.data() + csv.size();
+
+    double scalar_scan = measure([first, last]() {
+        std::size_t n = 0;
+        for (const char* it = first; ; ++it) {
+            while (it != last && *it != ',' && *it != '\n') ++it;
+            if (it == last) break;
+            ++n;
+        }
+        do_not_optimize(n);
+    });
+
+    double simd_scan = measure([first, last]() {
+        std::size_t n = 0;
+        for (const char* it = first; ; ++it) {
+            it = detail::find_either(it, last, ',', '\n');
+            if (it == last) break;
+            ++n;
+        }
+        do_not_optimize(n);
+    });
+
+    double istream_range = measure([&csv]() {
+        std::istringstream in{csv};
+        do_not_optimize(count_fields(csv_istream_range{in}));
+    }, 3);
+
+    double buffer_range = measure([&csv]() {
+        do_not_optimize(count_fields(csv_buffer_range{csv}));
+    }, 3);
+
+    double istream_read_csv = measure([&csv]() {
+        std::istringstream in{csv};
+        do_not_optimize(detail::read_csv_rows(csv_istream_range{in}, 0, true));
+    }, 3);
+
+    double buffer_read_csv = measure([&csv]() {
+        std::istringstream in{csv};
+        do_not_optimize(read_csv(in));
+    }, 3);
+
+    std::istringstream csv_in{csv};
+    const dataframe<> df = read_csv(csv_in);
+
+    double sequential_write = measure([&df]() {
+        std::ostringstream out;
+        write_csv(out, df);
+        do_not_optimize(out.str().size());
+    }, 3);
+
+    double parallel_write = measure([&df]() {
+        std::ostringstream out;
+        write_csv_parallel(out, df);
+        do_not_optimize(out.str().size());
+    }, 3);
+
+    std::cout << "parsing of " << csv.size() / double(1 << 20) << " MB of CSV" << std::endl;
+    report_throughput("scalar scan of separators and newlines", scalar_scan, scalar_scan,
+                      csv.size());
+    report_throughput("detail::find_either scan", simd_scan, scalar_scan, csv.size());
+    report_throughput("csv_istream_range", istream_range, istream_range, csv.size());
+    report_throughput("csv_buffer_range", buffer_range, istream_range, csv.size());
+    report_throughput("read_csv using csv_istream_range", istream_read_csv, istream_read_csv,
+                      csv.size());
+    report_throughput("read_csv using csv_buffer_range", buffer_read_csv, istream_read_csv,
+                      csv.size());
+    report_throughput("write_csv", sequential_write, sequential_write, csv.size());
+    report_throughput("write_csv_parallel", parallel_write, sequential_write, csv.size());
+}
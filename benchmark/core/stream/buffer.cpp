@@ -0,0 +1,66 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the ordered and the unordered stream::buffer on a workload
+// where a few elements take much longer than the others (e.g., huge images
+// or cache misses on disk).
+
+#include "../../common.hpp"
+
+#include <cxtream/core/stream/buffer.hpp>
+
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <chrono>
+#include <thread>
+
+namespace cxs = cxtream::stream;
+using namespace std::chrono_literals;
+
+// every tenth element is twenty times slower than the others
+int load(int i)
+{
+    std::this_thread::sleep_for(i % 10 == 0 ? 20ms : 1ms);
+    return i;
+}
+
+int main()
+{
+    const int n_elements = 400;
+    const int n_buffered = 8;
+    cxtream::thread_pool pool{4};
+
+    auto consume = [](auto&& rng) {
+        long sum = 0;
+        for (int v : rng) {
+            // simulate the consumer work (e.g., a training step)
+            std::this_thread::sleep_for(500us);
+            sum += v;
+        }
+        do_not_optimize(sum);
+    };
+
+    double ordered = measure([&]() {
+        consume(ranges::view::iota(0, n_elements)
+          | ranges::view::transform(load)
+          | cxs::buffer(n_buffered, pool));
+    }, 3);
+
+    double unordered = measure([&]() {
+        consume(ranges::view::iota(0, n_elements)
+          | ranges::view::transform(load)
+          | cxs::buffer_unordered(n_buffered, pool));
+    }, 3);
+
+    std::cout << n_elements << " elements with skewed latency, " << n_buffered
+              << " buffered elements, " << pool.n_threads() << " threads" << std::endl;
+    report("buffer", ordered, ordered);
+    report("buffer_unordered", unordered, ordered);
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the padding of a batch of 128 sequences of lengths 1..512
+// using the former multi-pass implementation based on ndim_size and ndim_resize,
+// the single-pass ndim_pad_mask and the padding of a ragged array.
+
+#include "../../common.hpp"
+
+#include <cxtream/core/ragged.hpp>
+#include <cxtream/core/utility/vector.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace cxu = cxtream::utility;
+
+using batch_t = std::vector<std::vector<float>>;
+using mask_t = std::vector<std::vector<bool>>;
+
+// the former implementation of stream::pad
+void multi_pass_pad(batch_t& source, mask_t& mask)
+{
+    std::vector<std::vector<long>> source_size = cxu::ndim_size<2>(source);
+    cxu::ndim_resize<2>(mask, source_size, true);
+    // the former implementation of ndim_pad
+    std::vector<std::vector<long>> padded_size = cxu::ndim_size<2>(source);
+    long max_size = *std::max_element(padded_size[1].begin(), padded_size[1].end());
+    std::fill(padded_size[1].begin(), padded_size[1].end(), max_size);
+    cxu::ndim_resize<2>(source, padded_size, -1.f);
+    source_size = cxu::ndim_size<2>(source);
+    cxu::ndim_resize<2>(mask, source_size, false);
+}
+
+int main()
+{
+    const int batch_size = 128;
+    const int n_batches = 200;
+    std::mt19937 gen{1000003};
+    std::uniform_int_distribution<int> length_dist{1, 512};
+    batch_t data(batch_size);
+    for (auto& seq : data) seq.resize(length_dist(gen), 1.f);
+
+    double multi_pass = measure([&data]() {
+        for (int i = 0; i < n_batches; ++i) {
+            batch_t source = data;
+            mask_t mask;
+            multi_pass_pad(source, mask);
+            do_not_optimize(source);
+            do_not_optimize(mask);
+        }
+    });
+
+    double single_pass = measure([&data]() {
+        for (int i = 0; i < n_batches; ++i) {
+            batch_t source = data;
+            mask_t mask;
+            cxu::ndim_pad_mask<2>(source, mask, -1.f);
+            do_not_optimize(source);
+            do_not_optimize(mask);
+        }
+    });
+
+    cxtream::ragged<float, 2> ragged_data{data};
+    double ragged = measure([&ragged_data]() {
+        for (int i = 0; i < n_batches; ++i) {
+            cxtream::ragged<float, 2> source = ragged_data;
+            do_not_optimize(source.to_tensor(-1.f));
+            do_not_optimize(source.mask());
+        }
+    });
+
+    std::cout << "padding of " << n_batches << " batches of " << batch_size
+              << " sequences of length 1..512 (including the copy of the batch)" << std::endl;
+    report("ndim_size + ndim_resize + ndim_pad", multi_pass, multi_pass);
+    report("ndim_pad_mask", single_pass, multi_pass);
+    report("ragged::to_tensor + ragged::mask", ragged, multi_pass);
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the serial stream::transform with the parallel one
+// on a function which takes tens of microseconds per example.
+
+#include "../../common.hpp"
+
+#include <cxtream/core/stream/create.hpp>
+#include <cxtream/core/stream/transform.hpp>
+#include <cxtream/core/stream/unpack.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+CXTREAM_DEFINE_COLUMN(value, double)
+
+namespace cxs = cxtream::stream;
+using cxs::from; using cxs::to; using cxs::dim; using cxs::parallel;
+
+// simulate an expensive augmentation
+double expensive(double v)
+{
+    for (int i = 0; i < 20000; ++i) v = std::sin(v) + 1.;
+    return v;
+}
+
+int main()
+{
+    const int n_batches = 20;
+    const int batch_size = 256;
+    std::vector<double> data(n_batches * batch_size);
+    std::iota(data.begin(), data.end(), 0.);
+
+    double serial = measure([&data]() {
+        auto rng = data
+          | cxs::create<value>(batch_size)
+          | cxs::transform(from<value>, to<value>, expensive);
+        do_not_optimize(cxs::unpack(rng, from<value>));
+    }, 3);
+
+    std::cout << "stream::transform of " << n_batches << " batches of "
+              << batch_size << " examples using "
+              << cxtream::global_thread_pool().n_threads() << " threads" << std::endl;
+    report("serial", serial, serial);
+
+    auto run_parallel = [&data](auto p) {
+        return measure([&data, p]() {
+            auto rng = data
+              | cxs::create<value>(batch_size)
+              | cxs::transform(from<value>, to<value>, expensive, dim<1>, p);
+            do_not_optimize(cxs::unpack(rng, from<value>));
+        }, 3);
+    };
+    report("parallel<2>", run_parallel(parallel<2>), serial);
+    report("parallel<4>", run_parallel(parallel<4>), serial);
+    report("parallel<> (pool size + 1)", run_parallel(parallel<>), serial);
+}
@@ -0,0 +1,60 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the per-element overhead of a chain of ten cheap stream::transform
+// stages with and without the type erasure of the stream.
+
+#include "../../common.hpp"
+
+#include <cxtream/core/stream/create.hpp>
+#include <cxtream/core/stream/transform.hpp>
+
+#include <numeric>
+#include <vector>
+
+CXTREAM_DEFINE_COLUMN(value, double)
+
+namespace cxs = cxtream::stream;
+using cxs::from; using cxs::to;
+
+// a single cheap stage, with or without the type erasure of the stream
+template<bool TypeErased>
+auto stage()
+{
+    auto fun = [](double v) { return v + 1.; };
+    if constexpr (TypeErased) return cxs::transform(from<value>, to<value>, fun);
+    else return cxs::transform(from<value>, to<value>, fun, cxs::dim<1>, cxs::typed);
+}
+
+template<bool TypeErased>
+double run(const std::vector<double>& data)
+{
+    return measure([&data]() {
+        auto s = stage<TypeErased>();
+        auto rng = data
+          | cxs::create<value>(1)
+          | s | s | s | s | s | s | s | s | s | s;
+        double sum = 0;
+        for (auto&& tuple : rng) sum += std::get<value>(tuple).value()[0];
+        do_not_optimize(sum);
+    }, 5);
+}
+
+int main()
+{
+    const int n_examples = 100000;
+    std::vector<double> data(n_examples);
+    std::iota(data.begin(), data.end(), 0.);
+
+    std::cout << "ten chained stream::transform stages over " << n_examples
+              << " single-example batches" << std::endl;
+    double erased = run<true>(data);
+    report("type-erased (any_view)", erased, erased);
+    report("typed", run<false>(data), erased);
+}
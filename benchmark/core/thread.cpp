@@ -0,0 +1,101 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// Compare the throughput of thread_pool::enqueue with the original
+// boost::asio based implementation on tasks which do almost no work.
+
+#include "../common.hpp"
+
+#include <cxtream/core/thread.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/hana.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <experimental/optional>
+#include <future>
+#include <memory>
+#include <vector>
+
+// The original thread pool posting a packaged_task to boost::asio::io_service.
+class asio_thread_pool {
+private:
+    boost::asio::io_service service_;
+    std::experimental::optional<boost::asio::io_service::work> work_{service_};
+    boost::thread_group threads_;
+
+public:
+    asio_thread_pool(unsigned n_threads)
+    {
+        for (unsigned i = 0; i < n_threads; ++i) {
+            threads_.create_thread([this]() { return this->service_.run(); });
+        }
+    }
+
+    template<typename Fun, typename... Args>
+    std::future<std::result_of_t<Fun(Args...)>> enqueue(Fun fun, Args... args)
+    {
+        using Ret = std::result_of_t<Fun(Args...)>;
+        std::packaged_task<Ret(Args...)> task{fun};
+        std::future<Ret> future = task.get_future();
+        auto shared_task = std::make_shared<std::packaged_task<Ret(Args...)>>(std::move(task));
+        auto shared_args = std::make_shared<boost::hana::tuple<Args...>>(std::move(args)...);
+        auto asio_task = [task = std::move(shared_task), args = std::move(shared_args)]() {
+            return boost::hana::unpack(std::move(*args), std::move(*task));
+        };
+        service_.post(std::move(asio_task));
+        return future;
+    }
+
+    ~asio_thread_pool()
+    {
+        work_ = std::experimental::nullopt;
+        threads_.join_all();
+    }
+};
+
+// Enqueue the tasks in windows of the given size and wait for their results.
+template<typename Pool, typename Future>
+void run_tasks(Pool& pool, std::vector<Future>& futures, int n_tasks)
+{
+    const std::size_t window = futures.capacity();
+    long sum = 0;
+    for (int i = 0; i < n_tasks; ++i) {
+        futures.push_back(pool.enqueue([](int v) { return v + 1; }, i));
+        if (futures.size() == window) {
+            for (auto& future : futures) sum += future.get();
+            futures.clear();
+        }
+    }
+    for (auto& future : futures) sum += future.get();
+    futures.clear();
+    do_not_optimize(sum);
+}
+
+int main()
+{
+    const int n_tasks = 200000;
+    const std::size_t window = 256;
+
+    for (unsigned n_threads : {1u, 2u, 4u}) {
+        std::cout << n_tasks << " trivial tasks on " << n_threads << " threads" << std::endl;
+
+        asio_thread_pool asio_pool{n_threads};
+        std::vector<std::future<int>> asio_futures;
+        asio_futures.reserve(window);
+        double asio = measure([&]() { run_tasks(asio_pool, asio_futures, n_tasks); });
+        report("asio (" + std::to_string(long(n_tasks / asio)) + " tasks/s)", asio, asio);
+
+        cxtream::thread_pool pool{n_threads};
+        std::vector<cxtream::future<int>> futures;
+        futures.reserve(window);
+        double cxt = measure([&]() { run_tasks(pool, futures, n_tasks); });
+        report("thread_pool (" + std::to_string(long(n_tasks / cxt)) + " tasks/s)", cxt, asio);
+    }
+}
@@ -0,0 +1,17 @@
+function(add_benchmark EXECUTABLE_FILE_NAME SOURCE_FILE_NAME LIBRARIES)
+  add_executable(
+    ${EXECUTABLE_FILE_NAME}
+    ${SOURCE_FILE_NAME}
+  )
+
+  target_link_libraries(
+    ${EXECUTABLE_FILE_NAME}
+    cxtream_core
+    ${LIBRARIES}
+  )
+
+  target_include_directories(
+    ${EXECUTABLE_FILE_NAME}
+    PRIVATE ${Boost_INCLUDE_DIRS}
+  )
+endfunction()
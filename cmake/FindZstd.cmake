@@ -0,0 +1,22 @@
+cmake_minimum_required(VERSION 3.0)
+
+#############################
+# Set the following variables
+# Zstd_INCLUDE_DIRS
+# Zstd_LIBRARIES
+# Zstd_FOUND
+#############################
+
+find_path(Zstd_INCLUDE_DIR zstd.h)
+find_library(Zstd_LIBRARY NAMES zstd)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(
+  Zstd
+  REQUIRED_VARS Zstd_LIBRARY Zstd_INCLUDE_DIR
+)
+
+if(Zstd_FOUND)
+  set(Zstd_INCLUDE_DIRS ${Zstd_INCLUDE_DIR})
+  set(Zstd_LIBRARIES ${Zstd_LIBRARY})
+endif()
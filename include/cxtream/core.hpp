@@ -12,10 +12,13 @@
 
 #include <cxtream/core/base64.hpp>
 #include <cxtream/core/csv.hpp>
+#include <cxtream/core/csv_index.hpp>
 #include <cxtream/core/dataframe.hpp>
 #include <cxtream/core/groups.hpp>
 #include <cxtream/core/index_mapper.hpp>
+#include <cxtream/core/ragged.hpp>
 #include <cxtream/core/stream.hpp>
+#include <cxtream/core/tensor.hpp>
 #include <cxtream/core/thread.hpp>
 #include <cxtream/core/utility.hpp>
 
@@ -12,12 +12,18 @@
 #define CXTREAM_CORE_CSV_HPP
 
 #include <cxtream/core/dataframe.hpp>
+#include <cxtream/core/thread.hpp>
+#include <cxtream/core/utility/compression.hpp>
+#include <cxtream/core/utility/filesystem.hpp>
 
 #include <boost/algorithm/string.hpp>
-#include <range/v3/algorithm/find_first_of.hpp>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 #include <range/v3/view/drop.hpp>
 #include <range/v3/view/move.hpp>
 
+#include <algorithm>
 #include <cctype>
 #include <climits>
 #include <deque>
@@ -25,6 +31,14 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace cxtream {
@@ -38,6 +52,74 @@ namespace detail {
         return in;
     }
 
+    // Find the first occurrence of either of the two characters in [first, last).
+    //
+    // The characters are compared 32 (AVX2) or 16 (SSE2) bytes at a time and the
+    // position is extracted from the bitmask of the matches. The tail is scanned
+    // one character at a time. Returns last if there is no such character.
+    inline const char* find_either(const char* first, const char* last, char a, char b) noexcept
+    {
+#if defined(__AVX2__)
+        const __m256i a32 = _mm256_set1_epi8(a);
+        const __m256i b32 = _mm256_set1_epi8(b);
+        for (; last - first >= 32; first += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(
+              _mm256_cmpeq_epi8(block, a32), _mm256_cmpeq_epi8(block, b32)));
+            if (mask) return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i a16 = _mm_set1_epi8(a);
+        const __m128i b16 = _mm_set1_epi8(b);
+        for (; last - first >= 16; first += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            unsigned mask = _mm_movemask_epi8(_mm_or_si128(
+              _mm_cmpeq_epi8(block, a16), _mm_cmpeq_epi8(block, b16)));
+            if (mask) return first + __builtin_ctz(mask);
+        }
+#endif
+        for (; first != last; ++first) {
+            if (*first == a || *first == b) return first;
+        }
+        return last;
+    }
+
+    // Access to the characters already read to the buffer of a stream but not consumed yet.
+    //
+    // The get area of a stream buffer is protected, so it is accessed through
+    // the member pointers named in a derived class.
+    struct streambuf_peeker : std::streambuf {
+        static std::string_view buffered(std::streambuf& buffer)
+        {
+            const char* begin = (buffer.*&streambuf_peeker::gptr)();
+            const char* end = (buffer.*&streambuf_peeker::egptr)();
+            return {begin, static_cast<std::size_t>(end - begin)};
+        }
+    };
+
+    // Wrap the stream in utility::decompressing_istream if it starts as gzip or zstd data.
+    //
+    // The whole magic number is checked using the characters already buffered by
+    // the stream, so that nothing is consumed from it. If the magic number is not
+    // buffered (e.g., the stream is unbuffered), the stream is considered uncompressed.
+    inline std::shared_ptr<std::istream> open_decompressed(std::istream& in,
+                                                           thread_pool& pool = global_thread_pool())
+    {
+        std::streambuf* buffer = in.rdbuf();
+        if (!buffer) return nullptr;
+        // fill the buffer
+        if (std::char_traits<char>::eq_int_type(buffer->sgetc(), std::char_traits<char>::eof())) {
+            return nullptr;
+        }
+        std::string_view magic = streambuf_peeker::buffered(*buffer);
+        if (utility::detect_compression(magic) == utility::compression::none) return nullptr;
+        auto decompressed = std::make_shared<utility::decompressing_istream>(in, pool);
+        // report the decompression errors instead of only setting the badbit
+        decompressed->exceptions(std::istream::badbit);
+        return decompressed;
+    }
+
 }  // namespace detail
 
 /// \ingroup CSV
@@ -53,6 +135,11 @@ namespace detail {
 ///     // csv_rows == {{"Id", "A", R"("Quoted \"column\"")"}, {"1", "a1", "1.1"}}
 /// \endcode
 ///
+/// A gzip or zstd compressed stream is detected by its magic number and decompressed
+/// on the fly, see utility::decompressing_istream. The magic number has to be already
+/// buffered by the stream (e.g., file and string streams), nothing is consumed
+/// from an uncompressed stream.
+///
 /// \throws std::ios_base::failure if badbit is triggered.
 class csv_istream_range : public ranges::view_facade<csv_istream_range> {
 private:
@@ -63,6 +150,8 @@ private:
     enum class RowPosition{Normal, Last, End};
 
     std::istream* in_;
+    // the decompressing stream reading from the original stream, if it is compressed
+    std::shared_ptr<std::istream> decompressed_;
     char separator_;
     char quote_;
     char escape_;
@@ -171,18 +260,480 @@ public:
                                char quote = '"',
                                char escape = '\\')
       : in_{&in}
+      , decompressed_{detail::open_decompressed(in)}
+      , separator_{separator}
+      , quote_{quote}
+      , escape_{escape}
+    {
+        if (decompressed_) in_ = decompressed_.get();
+        next();
+    }
+};
+
+/// \ingroup CSV
+/// \brief Parse and iterate over CSV formatted rows from a contiguous character buffer.
+///
+/// The parsing rules are the same as for csv_istream_range, but the rows consist of
+/// std::string_view fields pointing directly into the buffer. Only the quoted fields
+/// containing an escape character are unescaped to an internal storage.
+/// The separators, newlines, quotes and escapes are searched for using SIMD
+/// instructions if they are enabled by the compiler (SSE2 or AVX2).
+/// The fields are valid until the range is advanced to the next row and
+/// the buffer has to outlive the range.
+///
+/// Usage:
+/// \code
+///     std::string_view simple_csv{"Id, A\n 1, a1"};
+///     csv_buffer_range csv_rows{simple_csv};
+///     // csv_rows == {{"Id", "A"}, {"1", "a1"}}
+/// \endcode
+///
+/// \throws std::ios_base::failure if a quoted field is not terminated.
+class csv_buffer_range : public ranges::view_facade<csv_buffer_range> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+    using single_pass = std::true_type;
+    enum class RowPosition{Normal, Last, End};
+
+    std::string_view buffer_;
+    std::size_t pos_ = 0;
+    char separator_;
+    char quote_;
+    char escape_;
+    // the owner of the buffer (e.g., a memory mapped file), if any
+    std::shared_ptr<const void> owner_;
+
+    std::vector<std::string_view> row_;
+    // the storage of the unescaped fields, the deque does not move the strings
+    std::deque<std::string> unescaped_;
+    std::size_t n_unescaped_ = 0;
+    RowPosition row_position_ = RowPosition::Normal;
+
+    class cursor {
+    private:
+        csv_buffer_range* rng_;
+
+    public:
+        cursor() = default;
+        explicit cursor(csv_buffer_range& rng) noexcept
+          : rng_{&rng}
+        {}
+
+        void next()
+        {
+            rng_->next();
+        }
+
+        const std::vector<std::string_view>& read() const noexcept
+        {
+            return rng_->row_;
+        }
+
+        bool equal(ranges::default_sentinel) const noexcept
+        {
+            return rng_->row_position_ == RowPosition::End;
+        }
+    };
+
+    static bool is_blank(char c) noexcept
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    static bool is_space(char c) noexcept
+    {
+        return is_blank(c) || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    // find the end of the field starting at the current position, move behind it
+    // and return the end along with whether the next separator is found
+    std::tuple<std::size_t, bool> skip_field()
+    {
+        const char* data = buffer_.data();
+        std::size_t end =
+          detail::find_either(data + pos_, data + buffer_.size(), separator_, '\n') - data;
+        bool has_next = end < buffer_.size() && buffer_[end] == separator_;
+        pos_ = std::min(end + 1, buffer_.size());
+        return {end, has_next};
+    }
+
+    // parse quoted csv field starting after the opening quote
+    std::string_view parse_quoted_field()
+    {
+        const char* data = buffer_.data();
+        const char* last = data + buffer_.size();
+        std::size_t begin = pos_;
+        // the fast path, no escape characters
+        pos_ = detail::find_either(data + pos_, last, escape_, quote_) - data;
+        if (pos_ < buffer_.size() && buffer_[pos_] != escape_) {
+            return buffer_.substr(begin, pos_++ - begin);
+        }
+        // the slow path, the field has to be copied
+        if (n_unescaped_ == unescaped_.size()) unescaped_.emplace_back();
+        std::string& field = unescaped_[n_unescaped_++];
+        field.assign(data + begin, pos_ - begin);
+        while (pos_ < buffer_.size()) {
+            // the escape character is at the current position
+            if (++pos_ == buffer_.size()) break;
+            field.push_back(buffer_[pos_++]);
+            // copy the run up to the next escape or quote character
+            std::size_t run_end = detail::find_either(data + pos_, last, escape_, quote_) - data;
+            field.append(data + pos_, run_end - pos_);
+            pos_ = run_end;
+            if (pos_ < buffer_.size() && buffer_[pos_] != escape_) {
+                ++pos_;
+                return field;
+            }
+        }
+        throw std::ios_base::failure{"Error while reading CSV field."};
+    }
+
+    // parse csv row
+    void next()
+    {
+        if (row_position_ == RowPosition::Last) {
+            row_position_ = RowPosition::End;
+            return;
+        }
+
+        row_.clear();
+        n_unescaped_ = 0;
+        bool has_next = true;
+        while (has_next) {
+            while (pos_ < buffer_.size() && is_blank(buffer_[pos_])) ++pos_;
+            // process quoted fields
+            if (pos_ < buffer_.size() && buffer_[pos_] == quote_) {
+                ++pos_;
+                row_.push_back(parse_quoted_field());
+                std::tie(std::ignore, has_next) = skip_field();
+            }
+            // process unquoted fields
+            else {
+                std::size_t begin = pos_;
+                std::size_t end;
+                std::tie(end, has_next) = skip_field();
+                while (end > begin && is_space(buffer_[end - 1])) --end;
+                while (begin < end && is_space(buffer_[begin])) ++begin;
+                row_.push_back(buffer_.substr(begin, end - begin));
+            }
+        }
+
+        // detect whether end of buffer is reached
+        while (pos_ < buffer_.size() && is_space(buffer_[pos_])) ++pos_;
+        if (pos_ == buffer_.size()) {
+            row_position_ = RowPosition::Last;
+        }
+    }
+
+    cursor begin_cursor()
+    {
+        return cursor{*this};
+    }
+
+public:
+    csv_buffer_range() = default;
+
+    /// Parse the given buffer.
+    ///
+    /// \param buffer The CSV data.
+    /// \param separator Field separator.
+    /// \param quote Quote character.
+    /// \param escape Character used to escape a quote inside quotes.
+    /// \param owner The owner of the buffer, which is held as long as the range exists.
+    explicit csv_buffer_range(std::string_view buffer,
+                              char separator = ',',
+                              char quote = '"',
+                              char escape = '\\',
+                              std::shared_ptr<const void> owner = nullptr)
+      : buffer_{buffer}
       , separator_{separator}
       , quote_{quote}
       , escape_{escape}
+      , owner_{std::move(owner)}
     {
         next();
     }
+
+    /// The position in the buffer where the row following the current row starts.
+    ///
+    /// The whitespace between the rows is skipped, so if the current row is
+    /// the last one, the size of the buffer is returned.
+    std::size_t position() const noexcept
+    {
+        return pos_;
+    }
 };
 
+/// \ingroup CSV
+/// \brief Parse and iterate over CSV formatted rows of a memory mapped file.
+///
+/// The fields of the rows are std::string_view objects pointing directly to the mapped file,
+/// see csv_buffer_range. The mapping is released when the range is destroyed.
+///
+/// If the file is gzip or zstd compressed (see utility::detect_compression()), it is
+/// decompressed to memory using utility::decompress() and the fields point there instead.
+/// To avoid holding the whole decompressed file in memory, prefer read_csv(), which
+/// decompresses and parses such files incrementally.
+///
+/// Usage:
+/// \code
+///     for (const std::vector<std::string_view>& row : mmap_csv("data.csv")) {
+///         // process the row without any copies
+///     }
+/// \endcode
+///
+/// \param file The CSV file.
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \throws std::ios_base::failure If the specified file cannot be opened or decompressed.
+inline csv_buffer_range mmap_csv(const std::experimental::filesystem::path& file,
+                                 char separator = ',',
+                                 char quote = '"',
+                                 char escape = '\\')
+{
+    auto mapping = std::make_shared<const utility::mapped_file>(file);
+    std::string_view buffer = mapping->view();
+    if (utility::detect_compression(buffer) != utility::compression::none) {
+        auto data = std::make_shared<const std::string>(utility::decompress(buffer));
+        return csv_buffer_range{*data, separator, quote, escape, std::move(data)};
+    }
+    return csv_buffer_range{buffer, separator, quote, escape, std::move(mapping)};
+}
+
+namespace detail {
+
+    // Whether the file can be memory mapped. Named pipes, /dev/stdin, process
+    // substitutions etc. are not regular files, so they have to be read as streams.
+    inline bool is_mappable(const std::experimental::filesystem::path& file)
+    {
+        std::error_code ec;
+        return std::experimental::filesystem::is_regular_file(file, ec);
+    }
+
+    // Open a file which cannot be memory mapped as a stream.
+    inline std::ifstream open_csv_stream(const std::experimental::filesystem::path& file)
+    {
+        std::ifstream in{file, std::ios::binary};
+        if (!in) throw std::ios_base::failure{"Cannot open " + file.string() + "."};
+        return in;
+    }
+
+    // Whether the file is gzip or zstd compressed.
+    inline bool is_compressed(const std::experimental::filesystem::path& file)
+    {
+        char magic[4];
+        std::ifstream in = open_csv_stream(file);
+        in.read(magic, sizeof(magic));
+        return utility::detect_compression({magic, static_cast<std::size_t>(in.gcount())})
+          != utility::compression::none;
+    }
+
+    // Read the whole stream to memory, decompress it on the fly if it is compressed.
+    inline std::string read_csv_buffer(std::istream& in, thread_pool& pool)
+    {
+        std::shared_ptr<std::istream> decompressed = open_decompressed(in, pool);
+        std::istream& source = decompressed ? *decompressed : in;
+        std::string buffer;
+        std::vector<char> block(1 << 16);
+        while (source.read(block.data(), block.size()) || source.gcount() > 0) {
+            buffer.append(block.data(), source.gcount());
+        }
+        if (source.bad()) throw std::ios_base::failure{"Error while reading CSV stream."};
+        return buffer;
+    }
+
+    // Parse and iterate over CSV formatted rows of a stream using csv_buffer_range.
+    //
+    // The stream is read in large blocks to a window and only the rows which are
+    // known to be complete are parsed, i.e., those followed by another row in the window.
+    // The last row of the window is moved to its beginning and parsed again after
+    // the next block is read. Hence, only a single block and the longest row are held
+    // in memory. The fields are valid until the range is advanced to the next row.
+    //
+    // A gzip or zstd compressed stream is decompressed on the fly.
+    class csv_block_range : public ranges::view_facade<csv_block_range> {
+    private:
+        friend ranges::range_access;
+        using single_pass = std::true_type;
+
+        std::istream* in_;
+        std::shared_ptr<std::istream> decompressed_;
+        std::size_t block_size_;
+        char separator_;
+        char quote_;
+        char escape_;
+
+        // the vector does not move its data when the range is moved
+        std::vector<char> window_;
+        bool source_end_ = false;
+        // the rows of the window starting at the given offset
+        csv_buffer_range rows_;
+        std::size_t offset_ = 0;
+
+        class cursor {
+        private:
+            csv_block_range* rng_;
+
+        public:
+            cursor() = default;
+            explicit cursor(csv_block_range& rng) noexcept
+              : rng_{&rng}
+            {}
+
+            void next()
+            {
+                rng_->next();
+            }
+
+            const std::vector<std::string_view>& read() const
+            {
+                return *ranges::begin(rng_->rows_);
+            }
+
+            bool equal(ranges::default_sentinel) const
+            {
+                return ranges::begin(rng_->rows_) == ranges::end(rng_->rows_);
+            }
+        };
+
+        // whether the current row is followed by another row in the window
+        bool row_complete() const noexcept
+        {
+            return source_end_ || offset_ + rows_.position() < window_.size();
+        }
+
+        // move the row starting at the given position to the beginning of the window
+        // and read the next blocks of the stream until the row is complete
+        void refill(std::size_t row_begin)
+        {
+            window_.erase(window_.begin(), window_.begin() + row_begin);
+            offset_ = 0;
+            while (true) {
+                std::size_t kept = window_.size();
+                window_.resize(kept + block_size_);
+                in_->read(window_.data() + kept, block_size_);
+                if (in_->bad()) throw std::ios_base::failure{"Error while reading CSV stream."};
+                window_.resize(kept + in_->gcount());
+                source_end_ = static_cast<std::size_t>(in_->gcount()) < block_size_;
+                try {
+                    rows_ = csv_buffer_range{{window_.data(), window_.size()},
+                                             separator_, quote_, escape_};
+                    if (row_complete()) return;
+                } catch (const std::ios_base::failure&) {
+                    // a quoted field is not terminated
+                    if (source_end_) throw;
+                }
+            }
+        }
+
+        // parse the next row
+        void next()
+        {
+            std::size_t row_begin = offset_ + rows_.position();
+            auto it = ranges::begin(rows_);
+            try {
+                ++it;
+            } catch (const std::ios_base::failure&) {
+                if (source_end_) throw;
+                return refill(row_begin);
+            }
+            if (it != ranges::end(rows_) && !row_complete()) refill(row_begin);
+        }
+
+        cursor begin_cursor()
+        {
+            return cursor{*this};
+        }
+
+    public:
+        csv_block_range() = default;
+
+        explicit csv_block_range(std::istream& in,
+                                 char separator = ',',
+                                 char quote = '"',
+                                 char escape = '\\',
+                                 std::size_t block_size = 1 << 20)
+          : in_{&in}
+          , decompressed_{open_decompressed(in)}
+          , block_size_{block_size}
+          , separator_{separator}
+          , quote_{quote}
+          , escape_{escape}
+        {
+            if (decompressed_) in_ = decompressed_.get();
+            refill(0);
+        }
+    };
+
+    // Build a dataframe from a range of CSV rows (either strings or string views).
+    template <typename CsvRows>
+    dataframe<> read_csv_rows(CsvRows&& rows, int drop, bool has_header)
+    {
+        // header
+        std::vector<std::string> header;
+        // data
+        std::vector<std::vector<std::string>> data;
+        // load csv line by line
+        auto csv_rows =
+          std::forward<CsvRows>(rows)
+          | ranges::view::drop(drop)
+          | ranges::view::move;
+        auto csv_row_it = ranges::begin(csv_rows);
+        // load header if requested
+        std::size_t n_cols = -1;
+        if (has_header) {
+            if (csv_row_it == ranges::end(csv_rows)) {
+                throw std::ios_base::failure{"There has to be at least the header row."};
+            }
+            auto&& csv_row = *csv_row_it;
+            n_cols = ranges::size(csv_row);
+            for (auto& field : csv_row) header.emplace_back(std::move(field));
+            data.resize(n_cols);
+            ++csv_row_it;
+        }
+        // load data
+        for (std::size_t i = 0; csv_row_it != ranges::end(csv_rows); ++csv_row_it, ++i) {
+            auto&& csv_row = *csv_row_it;
+            // sanity check row size
+            if (i == 0) {
+                if (has_header) {
+                    if (ranges::size(csv_row) != n_cols) {
+                        throw std::ios_base::failure{"The first row must have the same "
+                                                     "length as the header."};
+                    }
+                } else {
+                    n_cols = ranges::size(csv_row);
+                    data.resize(n_cols);
+                }
+            } else {
+                if (ranges::size(csv_row) != n_cols) {
+                    throw std::ios_base::failure{"Row " + std::to_string(i)
+                                                 + " has a different length "
+                                                 + "(has: " + std::to_string(ranges::size(csv_row))
+                                                 + " , expected: " + std::to_string(n_cols)
+                                                 + ")."};
+                }
+            }
+            // store columns
+            for (std::size_t j = 0; j < ranges::size(csv_row); ++j) {
+                data[j].emplace_back(std::move(csv_row[j]));
+            }
+        }
+        return {std::move(data), std::move(header)};
+    }
+
+}  // namespace detail
+
 /// \ingroup CSV
 /// \brief Parse csv file from an std::istream.
 ///
-/// Parsing has the same rules as for csv_istream_range.
+/// Parsing has the same rules as for csv_istream_range. The stream is read
+/// in large blocks and the complete rows of each block are parsed by csv_buffer_range,
+/// so the stream is never held in memory as a whole. A gzip or zstd compressed stream
+/// is decompressed on the fly, see utility::decompressing_istream.
 ///
 /// \param in The input stream.
 /// \param drop How many lines should be ignored at the very beginning of the stream.
@@ -190,6 +741,7 @@ public:
 /// \param separator Field separator.
 /// \param quote Quote character.
 /// \param escape Character used to escape a quote inside quotes.
+/// \throws std::ios_base::failure if badbit is triggered.
 inline dataframe<> read_csv(std::istream& in,
                             int drop = 0,
                             bool has_header = true,
@@ -197,84 +749,544 @@ inline dataframe<> read_csv(std::istream& in,
                             char quote = '"',
                             char escape = '\\')
 {
-    // header
-    std::vector<std::string> header;
-    // data
-    std::vector<std::vector<std::string>> data;
-    // load csv line by line
-    auto csv_rows =
-      csv_istream_range(in, separator, quote, escape)
-      | ranges::view::drop(drop)
-      | ranges::view::move;
-    auto csv_row_it = ranges::begin(csv_rows);
-    // load header if requested
-    std::size_t n_cols = -1;
-    if (has_header) {
-        if (csv_row_it == ranges::end(csv_rows)) {
-            throw std::ios_base::failure{"There has to be at least the header row."};
+    return detail::read_csv_rows(detail::csv_block_range(in, separator, quote, escape),
+                                 drop, has_header);
+}
+
+/// \ingroup CSV
+/// \brief Same as read_csv() but read directly from a file.
+///
+/// The file is memory mapped and parsed by csv_buffer_range, so the fields
+/// are copied only once, directly to the resulting dataframe.
+///
+/// Files which cannot be mapped (e.g., named pipes or /dev/stdin) and gzip
+/// or zstd compressed files are read by the std::istream overload instead.
+///
+/// \throws std::ios_base::failure If the specified file cannot be opened.
+inline dataframe<> read_csv(const std::experimental::filesystem::path& file,
+                            int drop = 0,
+                            bool header = true,
+                            char separator = ',',
+                            char quote = '"',
+                            char escape = '\\')
+{
+    if (!detail::is_mappable(file) || detail::is_compressed(file)) {
+        std::ifstream in = detail::open_csv_stream(file);
+        return read_csv(in, drop, header, separator, quote, escape);
+    }
+    return detail::read_csv_rows(mmap_csv(file, separator, quote, escape), drop, header);
+}
+
+namespace detail {
+
+    // Tokenize the rows starting at the given position of the buffer (without copying
+    // the fields) and return the position of the first row starting at or after the
+    // limit. If there is no such row, the size of the buffer is returned.
+    inline std::size_t csv_find_row(std::string_view buffer,
+                                    std::size_t start,
+                                    std::size_t limit,
+                                    char separator,
+                                    char quote,
+                                    char escape)
+    {
+        if (start >= limit || start >= buffer.size()) return std::min(start, buffer.size());
+        csv_buffer_range rows{buffer.substr(start), separator, quote, escape};
+        for (auto it = ranges::begin(rows); it != ranges::end(rows); ++it) {
+            std::size_t pos = start + rows.position();
+            if (pos >= limit || pos == buffer.size()) return pos;
         }
-        std::vector<std::string> csv_row = *csv_row_it;
-        n_cols = ranges::size(csv_row);
-        header = std::move(csv_row);
-        data.resize(n_cols);
-        ++csv_row_it;
+        return buffer.size();
     }
-    // load data
-    for (std::size_t i = 0; csv_row_it != ranges::end(csv_rows); ++csv_row_it, ++i) {
-        std::vector<std::string> csv_row = *csv_row_it;
-        // sanity check row size
-        if (i == 0) {
+
+    // Find the positions of the rows splitting the buffer to approximately n_chunks
+    // chunks of the same size. The first returned position is begin, the last one is
+    // the size of the buffer and the chunks do not contain the whitespace between them.
+    //
+    // If there is no quote character, any newline ends a row, so the boundaries are
+    // found directly. Otherwise, the boundaries are found speculatively in parallel.
+    // Each chunk guesses that its first row starts after the first newline following
+    // its target offset and tokenizes the rows from there (without copying the fields)
+    // up to the target offset of the next chunk. The guess is correct if it matches
+    // the position where the tokenization of the previous chunk ended. Only the chunks
+    // with a wrong guess (i.e., whose first newline is inside a quoted field) are
+    // tokenized again, sequentially from the correct position.
+    inline std::vector<std::size_t> csv_chunk_boundaries(std::string_view buffer,
+                                                         std::size_t begin,
+                                                         std::size_t n_chunks,
+                                                         char separator,
+                                                         char quote,
+                                                         char escape,
+                                                         thread_pool& pool)
+    {
+        auto skip_space = [buffer](std::size_t pos) {
+            while (pos < buffer.size() && std::isspace(static_cast<unsigned char>(buffer[pos])))
+                ++pos;
+            return pos;
+        };
+        auto target = [&](std::size_t chunk) {
+            return begin + chunk * (buffer.size() - begin) / n_chunks;
+        };
+        std::vector<std::size_t> boundaries{begin};
+        if (buffer.find(quote, begin) == std::string_view::npos) {
+            for (std::size_t chunk = 1; chunk < n_chunks; ++chunk) {
+                std::size_t pos = std::max(target(chunk), boundaries.back());
+                pos = std::min(buffer.find('\n', pos), buffer.size());
+                pos = skip_space(pos);
+                if (pos > boundaries.back() && pos < buffer.size()) boundaries.push_back(pos);
+            }
+        } else if (begin < buffer.size()) {
+            // the guessed start of each chunk and the end of its speculative tokenization,
+            // the last chunk ends at the end of the buffer
+            constexpr std::size_t failed = -1;
+            std::vector<std::size_t> starts(n_chunks - 1, begin);
+            std::vector<std::size_t> ends(n_chunks - 1, failed);
+            pool.parallel_for(n_chunks - 1, [&](std::size_t first, std::size_t last) {
+                for (std::size_t c = first; c < last; ++c) {
+                    if (c > 0) {
+                        // the target offset itself starts a row if it follows a newline
+                        std::size_t pos = buffer.find('\n', std::max(target(c), begin + 1) - 1);
+                        starts[c] = skip_space(std::min(pos, buffer.size()));
+                    }
+                    try {
+                        ends[c] = csv_find_row(buffer, starts[c], target(c + 1),
+                                               separator, quote, escape);
+                    } catch (const std::ios_base::failure&) {
+                        // the guess is wrong, an unterminated quote was found
+                    }
+                }
+            }, n_chunks - 1);
+            for (std::size_t c = 0; c + 1 < n_chunks; ++c) {
+                std::size_t start = boundaries.back();
+                std::size_t end = ends[c];
+                if (starts[c] != start || end == failed) {
+                    end = csv_find_row(buffer, start, target(c + 1), separator, quote, escape);
+                }
+                if (end == buffer.size()) break;
+                if (end > start) boundaries.push_back(end);
+            }
+        }
+        boundaries.push_back(buffer.size());
+        return boundaries;
+    }
+
+    // The columns parsed from a single chunk of a CSV buffer.
+    struct csv_chunk {
+        std::vector<std::vector<std::string>> data;
+        std::size_t n_rows = 0;
+        // the number of fields of the rows (unknown until the first row is parsed)
+        std::size_t n_cols = -1;
+        // the index of the first row with a different number of fields
+        std::size_t bad_row = -1;
+        std::size_t bad_row_size = 0;
+    };
+
+    inline csv_chunk parse_csv_chunk(std::string_view chunk_buffer,
+                                     std::size_t n_cols,
+                                     char separator,
+                                     char quote,
+                                     char escape)
+    {
+        csv_chunk chunk;
+        chunk.n_cols = n_cols;
+        for (const std::vector<std::string_view>& csv_row :
+             csv_buffer_range{chunk_buffer, separator, quote, escape}) {
+            if (chunk.n_cols == std::size_t(-1)) chunk.n_cols = csv_row.size();
+            if (chunk.data.empty()) chunk.data.resize(chunk.n_cols);
+            if (csv_row.size() != chunk.n_cols) {
+                chunk.bad_row = chunk.n_rows;
+                chunk.bad_row_size = csv_row.size();
+                break;
+            }
+            for (std::size_t j = 0; j < csv_row.size(); ++j) {
+                chunk.data[j].emplace_back(csv_row[j]);
+            }
+            ++chunk.n_rows;
+        }
+        return chunk;
+    }
+
+    // Parse CSV data from a buffer in parallel chunks.
+    inline dataframe<> read_csv_parallel(std::string_view buffer,
+                                         int drop,
+                                         bool has_header,
+                                         char separator,
+                                         char quote,
+                                         char escape,
+                                         thread_pool& pool,
+                                         std::size_t n_chunks)
+    {
+        // an empty buffer is parsed as a single empty field, leave it to read_csv()
+        if (buffer.empty()) {
+            return read_csv_rows(csv_buffer_range{buffer, separator, quote, escape},
+                                 drop, has_header);
+        }
+
+        // the dropped rows and the header are parsed sequentially
+        std::vector<std::string> header;
+        std::size_t n_cols = -1;
+        std::size_t begin = 0;
+        if (drop > 0 || has_header) {
+            csv_buffer_range rows{buffer, separator, quote, escape};
+            auto it = ranges::begin(rows);
+            for (int i = 0; i < drop && it != ranges::end(rows); ++i, ++it) {
+                begin = rows.position();
+            }
             if (has_header) {
-                if (ranges::size(csv_row) != n_cols) {
+                if (it == ranges::end(rows)) {
+                    throw std::ios_base::failure{"There has to be at least the header row."};
+                }
+                for (std::string_view field : *it) header.emplace_back(field);
+                n_cols = header.size();
+                begin = rows.position();
+            }
+        }
+
+        // the chunks are parsed in parallel
+        if (n_chunks == 0) {
+            // use several chunks per thread for load balancing, but at least 1MB each
+            n_chunks = std::min<std::size_t>(4 * (pool.n_threads() + 1),
+                                             (buffer.size() - begin) / (1 << 20) + 1);
+        }
+        std::vector<std::size_t> boundaries =
+          csv_chunk_boundaries(buffer, begin, n_chunks, separator, quote, escape, pool);
+        std::vector<csv_chunk> chunks(boundaries.size() - 1);
+        pool.parallel_for(chunks.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; ++c) {
+                if (boundaries[c] == boundaries[c + 1]) continue;
+                std::string_view chunk_buffer =
+                  buffer.substr(boundaries[c], boundaries[c + 1] - boundaries[c]);
+                chunks[c] = parse_csv_chunk(chunk_buffer, n_cols, separator, quote, escape);
+            }
+        }, chunks.size());
+
+        // check the number of fields of all the rows
+        std::size_t n_rows = 0;
+        for (csv_chunk& chunk : chunks) {
+            if (chunk.n_cols == std::size_t(-1)) continue;
+            if (n_cols == std::size_t(-1)) n_cols = chunk.n_cols;
+            std::size_t bad_row = chunk.bad_row;
+            std::size_t bad_row_size = chunk.bad_row_size;
+            // the first row of the chunk may differ from the previous chunks
+            if (chunk.n_cols != n_cols) {
+                bad_row = 0;
+                bad_row_size = chunk.n_cols;
+            }
+            if (bad_row != std::size_t(-1)) {
+                std::size_t i = n_rows + bad_row;
+                if (i == 0 && has_header) {
                     throw std::ios_base::failure{"The first row must have the same "
                                                  "length as the header."};
                 }
-            } else {
-                n_cols = ranges::size(csv_row);
-                data.resize(n_cols);
+                throw std::ios_base::failure{"Row " + std::to_string(i)
+                                             + " has a different length "
+                                             + "(has: " + std::to_string(bad_row_size)
+                                             + " , expected: " + std::to_string(n_cols)
+                                             + ")."};
+            }
+            n_rows += chunk.n_rows;
+        }
+
+        // concatenate the columns of the chunks, each column by a single task
+        if (n_cols == std::size_t(-1)) n_cols = 0;
+        std::vector<std::vector<std::string>> data(n_cols);
+        pool.parallel_for(n_cols, [&](std::size_t first, std::size_t last) {
+            for (std::size_t j = first; j < last; ++j) {
+                data[j].reserve(n_rows);
+                for (csv_chunk& chunk : chunks) {
+                    if (chunk.data.empty()) continue;
+                    data[j].insert(data[j].end(),
+                                   std::make_move_iterator(chunk.data[j].begin()),
+                                   std::make_move_iterator(chunk.data[j].end()));
+                }
             }
-        } else {
+        }, n_cols);
+        return {std::move(data), std::move(header)};
+    }
+
+}  // namespace detail
+
+/// \ingroup CSV
+/// \brief Same as read_csv() but read a file in parallel.
+///
+/// The memory mapped file is split to chunks of whole rows, which are parsed by
+/// csv_buffer_range in parallel using the given thread pool. The columns of the
+/// chunks are then concatenated in the original order of the rows. The result is
+/// the same as the result of the sequential read_csv().
+///
+/// The chunk boundaries are found directly if there is no quote character in the file.
+/// Otherwise, each chunk is speculatively tokenized (without copying the fields) in
+/// parallel from the first newline after its approximate start. Only the chunks
+/// whose guessed first row turns out to be inside a quoted field are tokenized
+/// again from the row where the previous chunk ended.
+///
+/// Files which cannot be mapped (e.g., named pipes or /dev/stdin) are read to memory
+/// as streams first.
+///
+/// A gzip or zstd compressed file is decompressed to memory first. The blocks of
+/// bgzip files and the frames of multi-frame zstd files are decompressed in parallel
+/// using the same thread pool, see utility::decompress().
+///
+/// \param file The CSV file.
+/// \param drop How many lines should be ignored at the very beginning of the file.
+/// \param header Whether a header row should be parsed (after drop).
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \param pool The thread pool to be used.
+/// \param n_chunks The number of chunks. Zero means four chunks per thread (but the
+///                 chunks are at least one megabyte large).
+/// \throws std::ios_base::failure If the specified file cannot be opened or parsed.
+inline dataframe<> read_csv_parallel(const std::experimental::filesystem::path& file,
+                                     int drop = 0,
+                                     bool header = true,
+                                     char separator = ',',
+                                     char quote = '"',
+                                     char escape = '\\',
+                                     thread_pool& pool = global_thread_pool(),
+                                     std::size_t n_chunks = 0)
+{
+    if (!detail::is_mappable(file)) {
+        std::ifstream in = detail::open_csv_stream(file);
+        std::string data = detail::read_csv_buffer(in, pool);
+        return detail::read_csv_parallel(data, drop, header, separator, quote, escape,
+                                         pool, n_chunks);
+    }
+    utility::mapped_file mapping{file, false};
+    if (utility::detect_compression(mapping.view()) != utility::compression::none) {
+        std::string data = utility::decompress(mapping.view(), pool);
+        return detail::read_csv_parallel(data, drop, header, separator, quote, escape,
+                                         pool, n_chunks);
+    }
+    return detail::read_csv_parallel(mapping.view(), drop, header, separator, quote, escape,
+                                     pool, n_chunks);
+}
+
+namespace detail {
+
+    template <typename... Ts, typename Row, std::size_t... Is>
+    void push_typed_fields(std::tuple<std::vector<Ts>...>& columns, const Row& csv_row,
+                           const std::vector<std::size_t>& col_indices,
+                           std::index_sequence<Is...>)
+    {
+        (..., std::get<Is>(columns).push_back(
+                utility::string_view_to<Ts>(csv_row[col_indices[Is]])));
+    }
+
+    // Parse the selected columns of a range of CSV rows (string views) to the given types.
+    template <typename... Ts, typename CsvRows>
+    std::tuple<std::vector<Ts>...> read_csv_cols_rows(CsvRows&& rows,
+                                                      const std::vector<std::string>& col_names,
+                                                      int drop)
+    {
+        if (col_names.size() != sizeof...(Ts)) {
+            throw std::invalid_argument{"The number of column names has to be equal "
+                                        "to the number of types."};
+        }
+        auto csv_rows = std::forward<CsvRows>(rows) | ranges::view::drop(drop);
+        auto csv_row_it = ranges::begin(csv_rows);
+        // find the requested columns in the header
+        if (csv_row_it == ranges::end(csv_rows)) {
+            throw std::ios_base::failure{"There has to be at least the header row."};
+        }
+        std::size_t n_cols = ranges::size(*csv_row_it);
+        std::vector<std::string> header(ranges::begin(*csv_row_it), ranges::end(*csv_row_it));
+        std::vector<std::size_t> col_indices =
+          index_mapper<std::string>(std::move(header)).index_for(col_names);
+        ++csv_row_it;
+        // parse the data, the other columns are skipped
+        std::tuple<std::vector<Ts>...> columns;
+        for (std::size_t i = 0; csv_row_it != ranges::end(csv_rows); ++csv_row_it, ++i) {
+            const auto& csv_row = *csv_row_it;
+            // sanity check row size
             if (ranges::size(csv_row) != n_cols) {
+                if (i == 0) {
+                    throw std::ios_base::failure{"The first row must have the same "
+                                                 "length as the header."};
+                }
                 throw std::ios_base::failure{"Row " + std::to_string(i)
                                              + " has a different length "
                                              + "(has: " + std::to_string(ranges::size(csv_row))
                                              + " , expected: " + std::to_string(n_cols)
                                              + ")."};
             }
+            push_typed_fields(columns, csv_row, col_indices, std::index_sequence_for<Ts...>{});
         }
-        // store columns
-        for (std::size_t j = 0; j < ranges::size(csv_row); ++j) {
-            data[j].push_back(std::move(csv_row[j]));
-        }
+        return columns;
     }
-    return {std::move(data), std::move(header)};
+
+}  // namespace detail
+
+/// \ingroup CSV
+/// \brief Parse the selected columns of a csv file from an std::istream directly to
+/// the given types.
+///
+/// Unlike read_csv(), the fields are not stored as strings. Each field of the selected
+/// columns is parsed from the input buffer by utility::string_view_to(), i.e., by
+/// std::from_chars for the arithmetic types. The other columns are skipped without
+/// being copied. The file has to have a header row, which is used to find the columns.
+///
+/// \code
+///     std::vector<std::int64_t> ids;
+///     std::vector<double> values;
+///     std::tie(ids, values) = read_csv_cols<std::int64_t, double>(in, {"id", "value"});
+/// \endcode
+///
+/// \param in The input stream.
+/// \param col_names The names of the columns to be parsed, in the order of the types.
+/// \param drop How many lines should be ignored at the very beginning of the stream.
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \returns A tuple of the parsed columns.
+/// \throws std::out_of_range If a column is not present in the header.
+/// \throws std::ios_base::failure If badbit is triggered or a field cannot be parsed.
+template <typename... Ts>
+std::tuple<std::vector<Ts>...> read_csv_cols(std::istream& in,
+                                             const std::vector<std::string>& col_names,
+                                             int drop = 0,
+                                             char separator = ',',
+                                             char quote = '"',
+                                             char escape = '\\')
+{
+    return detail::read_csv_cols_rows<Ts...>(
+      detail::csv_block_range(in, separator, quote, escape), col_names, drop);
 }
 
 /// \ingroup CSV
-/// \brief Same as read_csv() but read directly from a file.
+/// \brief Same as read_csv_cols() but read directly from a memory mapped file.
+///
+/// Files which cannot be mapped (e.g., named pipes or /dev/stdin) and gzip
+/// or zstd compressed files are read by the std::istream overload instead.
+///
 /// \throws std::ios_base::failure If the specified file cannot be opened.
-inline dataframe<> read_csv(const std::experimental::filesystem::path& file,
-                            int drop = 0,
-                            bool header = true,
-                            char separator = ',',
-                            char quote = '"',
-                            char escape = '\\')
+template <typename... Ts>
+std::tuple<std::vector<Ts>...> read_csv_cols(const std::experimental::filesystem::path& file,
+                                             const std::vector<std::string>& col_names,
+                                             int drop = 0,
+                                             char separator = ',',
+                                             char quote = '"',
+                                             char escape = '\\')
 {
-    std::ifstream fin{file};
-    if (!fin) {
-        throw std::ios_base::failure{"Cannot open " + file.string() + " CSV file for reading."};
+    if (!detail::is_mappable(file) || detail::is_compressed(file)) {
+        std::ifstream in = detail::open_csv_stream(file);
+        return read_csv_cols<Ts...>(in, col_names, drop, separator, quote, escape);
     }
-    return read_csv(fin, drop, header, separator, quote, escape);
+    return detail::read_csv_cols_rows<Ts...>(mmap_csv(file, separator, quote, escape),
+                                             col_names, drop);
 }
 
 namespace detail {
 
-    inline bool trimmable(const std::string& str)
+    inline bool trimmable(std::string_view str)
     {
         if (str.length() == 0) return false;
         return std::isspace(str.front()) || std::isspace(str.back());
     }
 
+    // Append a csv field to the buffer, quote it if necessary.
+    //
+    // The output is the same as of `out << std::quoted(field, quote, escape)`
+    // (or `out << field` if the field does not need to be quoted).
+    inline void append_csv_field(std::string& buffer,
+                                 std::string_view field,
+                                 char separator,
+                                 char quote,
+                                 char escape)
+    {
+        // quote the field if it contains separator, double quote, newline or
+        // starts or ends with a whitespace
+        const char special[] = {separator, quote, '\n'};
+        if (field.find_first_of(std::string_view{special, 3}) == std::string_view::npos
+            && !trimmable(field)) {
+            buffer.append(field);
+            return;
+        }
+        const char* first = field.data();
+        const char* last = field.data() + field.size();
+        buffer.push_back(quote);
+        // copy the runs between the characters to be escaped at once
+        for (const char* it; (it = find_either(first, last, quote, escape)) != last;
+             first = it + 1) {
+            buffer.append(first, it);
+            buffer.push_back(escape);
+            buffer.push_back(*it);
+        }
+        buffer.append(first, last);
+        buffer.push_back(quote);
+    }
+
+    // Append a csv row to the buffer.
+    template <typename Row>
+    void append_csv_row(std::string& buffer,
+                        Row&& row,
+                        char separator,
+                        char quote,
+                        char escape)
+    {
+        for (std::size_t i = 0; i < ranges::size(row); ++i) {
+            append_csv_field(buffer, row[i], separator, quote, escape);
+            // output separator or newline
+            if (i + 1 < ranges::size(row)) buffer.push_back(separator);
+            else buffer.push_back('\n');
+        }
+    }
+
+    // Append the rows [begin, end) of a dataframe to the buffer.
+    template <typename DataTable>
+    void append_csv_rows(std::string& buffer,
+                         const dataframe<DataTable>& df,
+                         std::size_t begin,
+                         std::size_t end,
+                         char separator,
+                         char quote,
+                         char escape)
+    {
+        const DataTable& cols = df.data();
+        std::size_t n_cols = df.n_cols();
+        for (std::size_t i = begin; i < end; ++i) {
+            for (std::size_t j = 0; j < n_cols; ++j) {
+                append_csv_field(buffer, cols[j][i], separator, quote, escape);
+                buffer.push_back(j + 1 < n_cols ? separator : '\n');
+            }
+        }
+    }
+
+    // Write the buffer to the stream, the badbit exception is expected to be set.
+    inline void write_csv_buffer(std::ostream& out, const std::string& buffer)
+    {
+        out.write(buffer.data(), buffer.size());
+    }
+
+    // Set the badbit exception mask for the lifetime of the object.
+    class badbit_guard {
+    private:
+        std::ostream& out_;
+        std::ios_base::iostate orig_exceptions_;
+
+    public:
+        explicit badbit_guard(std::ostream& out)
+          : out_{out}
+          , orig_exceptions_{out.exceptions()}
+        {
+            out_.exceptions(orig_exceptions_ | std::ostream::badbit);
+        }
+
+        badbit_guard(const badbit_guard&) = delete;
+        badbit_guard& operator=(const badbit_guard&) = delete;
+
+        ~badbit_guard()
+        {
+            // do not throw from the destructor if the stream is already bad
+            try {
+                out_.exceptions(orig_exceptions_);
+            } catch (const std::ios_base::failure&) {
+            }
+        }
+    };
+
+    // The size of the buffer to be written to the stream at once.
+    constexpr std::size_t csv_write_buffer_size = 1 << 20;
+
 }  // namespace detail
 
 /// \ingroup CSV
@@ -290,27 +1302,10 @@ std::ostream& write_csv_row(std::ostream& out,
                             char quote = '"',
                             char escape = '\\')
 {
-    // temporarily set badbit exception mask
-    auto orig_exceptions = out.exceptions();
-    out.exceptions(orig_exceptions | std::ostream::badbit);
-
-    for (std::size_t i = 0; i < ranges::size(row); ++i) {
-        auto& field = row[i];
-        // output quoted string if it contains separator, double quote, newline or
-        // starts or ends with a whitespace
-        if (ranges::find_first_of(field, {separator, quote, '\n'}) != ranges::end(field)
-            || detail::trimmable(field)) {
-            out << std::quoted(field, quote, escape);
-        } else {
-            out << field;
-        }
-
-        // output separator or newline
-        if (i + 1 < ranges::size(row)) out << separator;
-        else out << '\n';
-    }
-
-    out.exceptions(orig_exceptions);
+    detail::badbit_guard guard{out};
+    std::string buffer;
+    detail::append_csv_row(buffer, row, separator, quote, escape);
+    detail::write_csv_buffer(out, buffer);
     return out;
 }
 
@@ -318,6 +1313,7 @@ std::ostream& write_csv_row(std::ostream& out,
 /// \brief Write a dataframe to an std::ostream.
 /// 
 /// Fields containing a quote, a newline, or a separator are quoted automatically.
+/// The rows are formatted to a large buffer, which is written to the stream at once.
 ///
 /// \throws std::ios_base::failure if badbit is triggered.
 template <typename DataTable>
@@ -327,10 +1323,19 @@ std::ostream& write_csv(std::ostream& out,
                         char quote = '"',
                         char escape = '\\')
 {
-    write_csv_row(out, df.header(), separator, quote, escape);
-    for (auto&& row : df.raw_rows()) {
-        write_csv_row(out, row, separator, quote, escape);
+    detail::badbit_guard guard{out};
+    std::string buffer;
+    buffer.reserve(detail::csv_write_buffer_size);
+    detail::append_csv_row(buffer, df.header(), separator, quote, escape);
+    for (std::size_t begin = 0; begin < df.n_rows(); begin += 1024) {
+        std::size_t end = std::min(begin + 1024, df.n_rows());
+        detail::append_csv_rows(buffer, df, begin, end, separator, quote, escape);
+        if (buffer.size() >= detail::csv_write_buffer_size) {
+            detail::write_csv_buffer(out, buffer);
+            buffer.clear();
+        }
     }
+    detail::write_csv_buffer(out, buffer);
     return out;
 }
 
@@ -351,5 +1356,93 @@ void write_csv(const std::experimental::filesystem::path& file,
     write_csv(fout, df, separator, quote, escape);
 }
 
+/// \ingroup CSV
+/// \brief Same as write_csv() but format the rows in parallel.
+///
+/// The rows are split to blocks, which are formatted to reusable buffers by the
+/// given thread pool. The calling thread writes the formatted blocks to the stream
+/// in the original order, so the output is the same as the output of write_csv().
+/// At most two blocks per thread are being formatted or waiting to be written at once.
+///
+/// \param out The output stream.
+/// \param df The dataframe to be written.
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \param pool The thread pool to be used.
+/// \param block_rows The number of rows in a block. Zero means 4096 rows.
+/// \throws std::ios_base::failure if badbit is triggered.
+template <typename DataTable>
+std::ostream& write_csv_parallel(std::ostream& out,
+                                 const dataframe<DataTable>& df,
+                                 char separator = ',',
+                                 char quote = '"',
+                                 char escape = '\\',
+                                 thread_pool& pool = global_thread_pool(),
+                                 std::size_t block_rows = 0)
+{
+    detail::badbit_guard guard{out};
+    if (block_rows == 0) block_rows = 4096;
+    std::size_t n_blocks = (df.n_rows() + block_rows - 1) / block_rows;
+    std::size_t n_slots = std::min<std::size_t>(2 * pool.n_threads(), n_blocks);
+
+    std::string buffer;
+    detail::append_csv_row(buffer, df.header(), separator, quote, escape);
+    detail::write_csv_buffer(out, buffer);
+    if (n_blocks == 0) return out;
+
+    // each slot has its own buffer, which is reused by every n_slots-th block
+    std::vector<std::string> buffers(n_slots);
+    std::vector<future<void>> futures(n_slots);
+    auto format_block = [&df, &buffers, n_slots, block_rows, separator, quote, escape](
+      std::size_t block) {
+        std::string& buffer = buffers[block % n_slots];
+        buffer.clear();
+        std::size_t begin = block * block_rows;
+        std::size_t end = std::min(begin + block_rows, df.n_rows());
+        detail::append_csv_rows(buffer, df, begin, end, separator, quote, escape);
+    };
+
+    try {
+        for (std::size_t block = 0; block < n_slots; ++block) {
+            futures[block] = pool.enqueue(format_block, block);
+        }
+        for (std::size_t block = 0; block < n_blocks; ++block) {
+            std::size_t slot = block % n_slots;
+            futures[slot].get();
+            detail::write_csv_buffer(out, buffers[slot]);
+            if (block + n_slots < n_blocks) {
+                futures[slot] = pool.enqueue(format_block, block + n_slots);
+            }
+        }
+    } catch (...) {
+        // the pending tasks refer to the buffers, so wait for them before unwinding
+        for (auto& f : futures) {
+            if (f.valid()) f.wait();
+        }
+        throw;
+    }
+    return out;
+}
+
+/// \ingroup CSV
+/// \brief Same as write_csv_parallel(std::ostream...), but write directly to a file.
+/// \throws std::ios_base::failure If the specified file cannot be opened.
+template <typename DataTable>
+void write_csv_parallel(const std::experimental::filesystem::path& file,
+                        const dataframe<DataTable>& df,
+                        char separator = ',',
+                        char quote = '"',
+                        char escape = '\\',
+                        thread_pool& pool = global_thread_pool(),
+                        std::size_t block_rows = 0)
+{
+    std::ofstream fout{file};
+    if (!fout) {
+        throw std::ios_base::failure{"Cannot open " + file.string() + " CSV file for writing."};
+    }
+    write_csv_parallel(fout, df, separator, quote, escape, pool, block_rows);
+}
+
 }  // namespace cxtream
 #endif
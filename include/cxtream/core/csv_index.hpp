@@ -0,0 +1,381 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_CSV_INDEX_HPP
+#define CXTREAM_CORE_CSV_INDEX_HPP
+
+#include <cxtream/core/csv.hpp>
+#include <cxtream/core/utility/compression.hpp>
+#include <cxtream/core/utility/filesystem.hpp>
+
+#include <range/v3/view/drop.hpp>
+#include <range/v3/view/take.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <experimental/filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace cxtream {
+namespace detail {
+
+    constexpr const char csv_index_magic[8] = {'C', 'X', 'C', 'S', 'V', 'I', 'D', 'X'};
+    constexpr std::uint64_t csv_index_version = 1;
+
+    // Write a 64-bit unsigned integer in little endian byte order.
+    inline void write_uint64(std::ostream& out, std::uint64_t value)
+    {
+        char bytes[8];
+        for (int i = 0; i < 8; ++i) bytes[i] = static_cast<char>(value >> (8 * i));
+        out.write(bytes, 8);
+    }
+
+    // Read a 64-bit unsigned integer in little endian byte order.
+    inline std::uint64_t read_uint64(std::istream& in)
+    {
+        unsigned char bytes[8];
+        if (!in.read(reinterpret_cast<char*>(bytes), 8)) {
+            throw std::ios_base::failure{"Corrupted CSV index."};
+        }
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= std::uint64_t{bytes[i]} << (8 * i);
+        return value;
+    }
+
+    // Compressed files have no random access, they have to be decompressed first.
+    inline void check_indexable(std::string_view buffer,
+                                const std::experimental::filesystem::path& file)
+    {
+        if (utility::detect_compression(buffer) != utility::compression::none) {
+            throw std::ios_base::failure{"Cannot index a compressed CSV file "
+                                         + file.string() + "."};
+        }
+    }
+
+}  // namespace detail
+
+/// \ingroup CSV
+/// \brief Byte offsets of every K-th row of a CSV buffer.
+///
+/// The index is built by a single pass of csv_buffer_range over the buffer, so the
+/// rows are split exactly as they would be parsed (e.g., the newlines in quoted fields
+/// do not start a new row). The rows are numbered from zero and the header, if any,
+/// is the row zero. The index can be stored to a small binary sidecar file
+/// (8 bytes per K rows) and loaded back, see build_csv_index() and indexed_csv.
+///
+/// \code
+///     build_csv_index("data.csv").save("data.csv.idx");
+///     indexed_csv csv{"data.csv", csv_index::load("data.csv.idx")};
+///     for (const std::vector<std::string_view>& row : csv.rows(40000000, 40000010)) {
+///         // only the 1024-row block containing the row 40000000 is parsed
+///     }
+/// \endcode
+class csv_index {
+private:
+    std::size_t step_ = 1;
+    std::size_t n_rows_ = 0;
+    std::size_t buffer_size_ = 0;
+    char separator_ = ',';
+    char quote_ = '"';
+    char escape_ = '\\';
+    // the offsets of the rows 0, K, 2K, ... followed by the size of the buffer
+    std::vector<std::uint64_t> offsets_ = {0};
+
+public:
+    csv_index() = default;
+
+    /// Index the rows of the given buffer.
+    ///
+    /// \param buffer The CSV data.
+    /// \param step The offset of every step-th row is stored.
+    /// \param separator Field separator.
+    /// \param quote Quote character.
+    /// \param escape Character used to escape a quote inside quotes.
+    /// \throws std::invalid_argument If the step is zero.
+    /// \throws std::ios_base::failure If a quoted field is not terminated.
+    static csv_index build(std::string_view buffer,
+                           std::size_t step = 1024,
+                           char separator = ',',
+                           char quote = '"',
+                           char escape = '\\')
+    {
+        if (step == 0) throw std::invalid_argument{"CSV index step has to be positive."};
+        csv_index index;
+        index.step_ = step;
+        index.buffer_size_ = buffer.size();
+        index.separator_ = separator;
+        index.quote_ = quote;
+        index.escape_ = escape;
+        index.offsets_.clear();
+        csv_buffer_range csv_rows{buffer, separator, quote, escape};
+        std::size_t row_start = 0;
+        for (auto it = ranges::begin(csv_rows); it != ranges::end(csv_rows); ++it) {
+            if (index.n_rows_ % step == 0) index.offsets_.push_back(row_start);
+            ++index.n_rows_;
+            row_start = csv_rows.position();
+        }
+        index.offsets_.push_back(buffer.size());
+        return index;
+    }
+
+    /// Save the index to a binary file.
+    ///
+    /// \throws std::ios_base::failure If the file cannot be written.
+    void save(const std::experimental::filesystem::path& file) const
+    {
+        std::ofstream fout{file, std::ios::binary};
+        if (!fout) {
+            throw std::ios_base::failure{"Cannot open " + file.string()
+                                         + " CSV index file for writing."};
+        }
+        fout.write(detail::csv_index_magic, sizeof(detail::csv_index_magic));
+        detail::write_uint64(fout, detail::csv_index_version);
+        detail::write_uint64(fout, step_);
+        detail::write_uint64(fout, n_rows_);
+        detail::write_uint64(fout, buffer_size_);
+        fout.put(separator_).put(quote_).put(escape_);
+        detail::write_uint64(fout, offsets_.size());
+        for (std::uint64_t offset : offsets_) detail::write_uint64(fout, offset);
+        if (!fout.flush()) {
+            throw std::ios_base::failure{"Error while writing " + file.string()
+                                         + " CSV index file."};
+        }
+    }
+
+    /// Load an index stored by save().
+    ///
+    /// \throws std::ios_base::failure If the file cannot be opened or it is not a valid index.
+    static csv_index load(const std::experimental::filesystem::path& file)
+    {
+        std::ifstream fin{file, std::ios::binary};
+        if (!fin) {
+            throw std::ios_base::failure{"Cannot open " + file.string()
+                                         + " CSV index file for reading."};
+        }
+        char magic[sizeof(detail::csv_index_magic)];
+        if (!fin.read(magic, sizeof(magic))
+            || !std::equal(magic, magic + sizeof(magic), detail::csv_index_magic)
+            || detail::read_uint64(fin) != detail::csv_index_version) {
+            throw std::ios_base::failure{file.string() + " is not a CSV index file."};
+        }
+        csv_index index;
+        index.step_ = detail::read_uint64(fin);
+        index.n_rows_ = detail::read_uint64(fin);
+        index.buffer_size_ = detail::read_uint64(fin);
+        char dialect[3];
+        if (!fin.read(dialect, 3)) throw std::ios_base::failure{"Corrupted CSV index."};
+        index.separator_ = dialect[0];
+        index.quote_ = dialect[1];
+        index.escape_ = dialect[2];
+        std::uint64_t n_offsets = detail::read_uint64(fin);
+        // sanity check the header before allocating the offsets
+        if (index.step_ == 0
+            || n_offsets > std::experimental::filesystem::file_size(file) / 8
+            || n_offsets != (index.n_rows_ + index.step_ - 1) / index.step_ + 1) {
+            throw std::ios_base::failure{"Corrupted CSV index."};
+        }
+        index.offsets_.resize(n_offsets);
+        for (std::uint64_t& offset : index.offsets_) offset = detail::read_uint64(fin);
+        if (index.offsets_.back() != index.buffer_size_
+            || !std::is_sorted(index.offsets_.begin(), index.offsets_.end())) {
+            throw std::ios_base::failure{"Corrupted CSV index."};
+        }
+        return index;
+    }
+
+    /// The number of indexed rows (including the header, if any).
+    std::size_t n_rows() const noexcept
+    {
+        return n_rows_;
+    }
+
+    /// The distance of the rows whose offsets are stored.
+    std::size_t step() const noexcept
+    {
+        return step_;
+    }
+
+    /// The size of the indexed buffer in bytes.
+    std::size_t buffer_size() const noexcept
+    {
+        return buffer_size_;
+    }
+
+    char separator() const noexcept
+    {
+        return separator_;
+    }
+
+    char quote() const noexcept
+    {
+        return quote_;
+    }
+
+    char escape() const noexcept
+    {
+        return escape_;
+    }
+
+    /// Find the rows [begin, end) in the buffer.
+    ///
+    /// \returns The byte range of the indexed blocks covering the rows and the number
+    ///          of rows from the start of the byte range to the row begin.
+    /// \throws std::out_of_range If the rows are not in the index.
+    std::tuple<std::size_t, std::size_t, std::size_t> locate(std::size_t begin,
+                                                             std::size_t end) const
+    {
+        if (begin > end || end > n_rows_) {
+            throw std::out_of_range{"Rows [" + std::to_string(begin) + ", "
+                                    + std::to_string(end) + ") are not in the CSV index "
+                                    + "with " + std::to_string(n_rows_) + " rows."};
+        }
+        std::size_t first_block = begin / step_;
+        std::size_t last_block = std::min((end + step_ - 1) / step_, offsets_.size() - 1);
+        return {offsets_[first_block], offsets_[last_block], begin % step_};
+    }
+};
+
+/// \ingroup CSV
+/// \brief Build the row index of a CSV file.
+///
+/// The file is memory mapped and parsed without copying the fields.
+///
+/// \param file The CSV file.
+/// \param step The offset of every step-th row is stored.
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \throws std::ios_base::failure If the file cannot be opened or it is compressed.
+inline csv_index build_csv_index(const std::experimental::filesystem::path& file,
+                                 std::size_t step = 1024,
+                                 char separator = ',',
+                                 char quote = '"',
+                                 char escape = '\\')
+{
+    utility::mapped_file mapping{file};
+    detail::check_indexable(mapping.view(), file);
+    return csv_index::build(mapping.view(), step, separator, quote, escape);
+}
+
+/// \ingroup CSV
+/// \brief Random access to the rows of a CSV file using its csv_index.
+///
+/// The file is memory mapped, so accessing the rows [begin, end) only touches the pages
+/// of the indexed blocks containing them. At most step - 1 rows before the range
+/// and step - 1 rows after the range are tokenized (without copying). The object
+/// can be shared by multiple threads and each thread can parse its own rows, see shard().
+///
+/// \code
+///     indexed_csv csv{"data.csv", csv_index::load("data.csv.idx")};
+///     // parse a quarter of the data rows (i.e., skip the header)
+///     for (const std::vector<std::string_view>& row : csv.shard(2, 4, 1)) {
+///         // ...
+///     }
+/// \endcode
+class indexed_csv {
+private:
+    std::shared_ptr<const utility::mapped_file> mapping_;
+    csv_index index_;
+
+public:
+    indexed_csv() = default;
+
+    /// Map the given file and use the given index.
+    ///
+    /// \throws std::ios_base::failure If the file cannot be opened or it does not match
+    ///                                the index (e.g., it has been modified).
+    indexed_csv(const std::experimental::filesystem::path& file, csv_index index)
+      : mapping_{std::make_shared<const utility::mapped_file>(file, false)}
+      , index_{std::move(index)}
+    {
+        if (mapping_->size() != index_.buffer_size()) {
+            throw std::ios_base::failure{"The CSV index does not match the file "
+                                         + file.string() + "."};
+        }
+    }
+
+    /// Map the given file and build its index.
+    ///
+    /// \throws std::ios_base::failure If the file cannot be opened or indexed.
+    explicit indexed_csv(const std::experimental::filesystem::path& file,
+                         std::size_t step = 1024,
+                         char separator = ',',
+                         char quote = '"',
+                         char escape = '\\')
+      : mapping_{std::make_shared<const utility::mapped_file>(file, false)}
+    {
+        detail::check_indexable(mapping_->view(), file);
+        index_ = csv_index::build(mapping_->view(), step, separator, quote, escape);
+    }
+
+    /// The index of the file.
+    const csv_index& index() const noexcept
+    {
+        return index_;
+    }
+
+    /// The number of rows in the file (including the header, if any).
+    std::size_t n_rows() const noexcept
+    {
+        return index_.n_rows();
+    }
+
+    /// Iterate over the rows [begin, end) of the file.
+    ///
+    /// The rows are provided by a csv_buffer_range, which holds the mapping of the file.
+    ///
+    /// \throws std::out_of_range If the rows are not in the file.
+    auto rows(std::size_t begin, std::size_t end) const
+    {
+        auto [first, last, skip] = index_.locate(begin, end);
+        std::string_view blocks = mapping_->view().substr(first, last - first);
+        return csv_buffer_range{blocks, index_.separator(), index_.quote(), index_.escape(),
+                                mapping_}
+          | ranges::view::drop(skip)
+          | ranges::view::take(end - begin);
+    }
+
+    /// Parse and copy a single row of the file.
+    ///
+    /// \throws std::out_of_range If the row is not in the file.
+    std::vector<std::string> row(std::size_t i) const
+    {
+        std::vector<std::string> result;
+        for (const std::vector<std::string_view>& csv_row : rows(i, i + 1)) {
+            result.assign(csv_row.begin(), csv_row.end());
+        }
+        return result;
+    }
+
+    /// Iterate over the i-th of n approximately equal parts of the rows [first, n_rows()).
+    ///
+    /// \param i The index of the shard.
+    /// \param n The number of shards.
+    /// \param first The first row to be split to the shards (e.g., 1 to skip the header).
+    /// \throws std::out_of_range If the shard or the first row is out of range.
+    auto shard(std::size_t i, std::size_t n, std::size_t first = 0) const
+    {
+        if (i >= n || first > n_rows()) {
+            throw std::out_of_range{"Shard " + std::to_string(i) + " of " + std::to_string(n)
+                                    + " is out of range."};
+        }
+        std::size_t n_shard_rows = n_rows() - first;
+        return rows(first + i * n_shard_rows / n, first + (i + 1) * n_shard_rows / n);
+    }
+};
+
+}  // namespace cxtream
+#endif
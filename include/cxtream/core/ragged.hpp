@@ -0,0 +1,669 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+/// \defgroup Ragged Multidimensional arrays of variable-length rows.
+
+#ifndef CXTREAM_CORE_RAGGED_HPP
+#define CXTREAM_CORE_RAGGED_HPP
+
+#include <cxtream/core/tensor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxtream {
+
+template<typename T, long NDims>
+class ragged;
+
+template<typename T, long NDims>
+class ragged_view;
+
+/// \ingroup Ragged
+/// \brief Checks whether the given type is a ragged array or a ragged_view.
+template<typename T>
+struct is_ragged : std::false_type {
+};
+
+template<typename T, long NDims>
+struct is_ragged<ragged<T, NDims>> : std::true_type {
+};
+
+template<typename T, long NDims>
+struct is_ragged<ragged_view<T, NDims>> : std::true_type {
+};
+
+namespace detail {
+
+    // Check whether a range can be converted to a ragged array of the given dimensionality,
+    // i.e., whether it is a nested range with NDims levels or a range of ragged arrays.
+    template<typename Rng, typename T, long NDims, typename = void>
+    struct is_raggable : std::false_type {
+    };
+
+    template<typename Rng, typename T, long NDims>
+    struct is_raggable<Rng, T, NDims, std::enable_if_t<is_iterable<Rng>{}>> {
+        using elem_t = std::remove_cv_t<
+          std::remove_reference_t<decltype(*std::begin(std::declval<Rng&>()))>>;
+
+        static constexpr bool check()
+        {
+            if constexpr (NDims == 1) return std::is_convertible<elem_t&, T>{};
+            else if constexpr (is_ragged<elem_t>{}) return elem_t::ndims() == NDims - 1;
+            else return is_raggable<elem_t, T, NDims - 1>::value;
+        }
+
+        static constexpr bool value = check();
+    };
+
+    // Drop the first element of an array.
+    template<typename U, std::size_t N>
+    std::array<U, N - 1> array_tail(const std::array<U, N>& arr)
+    {
+        std::array<U, N - 1> tail;
+        std::copy(arr.begin() + 1, arr.end(), tail.begin());
+        return tail;
+    }
+
+    // Random access iterator through the first dimension of a ragged array.
+    // The iterator yields views of the rows.
+    template<typename T, long NDims>
+    class ragged_iterator {
+    private:
+        T* values_ = nullptr;
+        std::array<const std::size_t*, NDims - 1> splits_{};
+        std::ptrdiff_t idx_ = 0;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = ragged<std::remove_const_t<T>, NDims - 1>;
+        using difference_type = std::ptrdiff_t;
+        using reference = ragged_view<T, NDims - 1>;
+        using pointer = void;
+
+        ragged_iterator() = default;
+
+        ragged_iterator(T* values, std::array<const std::size_t*, NDims - 1> splits,
+                        std::ptrdiff_t idx)
+          : values_{values}
+          , splits_{splits}
+          , idx_{idx}
+        {
+        }
+
+        // a mutable iterator is convertible to a const iterator
+        template<typename U, typename = std::enable_if_t<std::is_same<const U, T>{}>>
+        ragged_iterator(const ragged_iterator<U, NDims>& that)
+          : ragged_iterator{that.values(), that.splits(), that.index()}
+        {
+        }
+
+        T* values() const { return values_; }
+        const std::array<const std::size_t*, NDims - 1>& splits() const { return splits_; }
+        std::ptrdiff_t index() const { return idx_; }
+
+        reference operator*() const
+        {
+            return {values_, array_tail(splits_), splits_[0][idx_], splits_[0][idx_ + 1]};
+        }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        ragged_iterator& operator++() { ++idx_; return *this; }
+        ragged_iterator& operator--() { --idx_; return *this; }
+        ragged_iterator operator++(int) { auto tmp = *this; ++idx_; return tmp; }
+        ragged_iterator operator--(int) { auto tmp = *this; --idx_; return tmp; }
+        ragged_iterator& operator+=(difference_type n) { idx_ += n; return *this; }
+        ragged_iterator& operator-=(difference_type n) { idx_ -= n; return *this; }
+
+        friend ragged_iterator operator+(ragged_iterator it, difference_type n) { return it += n; }
+        friend ragged_iterator operator+(difference_type n, ragged_iterator it) { return it += n; }
+        friend ragged_iterator operator-(ragged_iterator it, difference_type n) { return it -= n; }
+
+        friend difference_type operator-(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ - b.idx_;
+        }
+
+        friend bool operator==(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ == b.idx_;
+        }
+        friend bool operator!=(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ != b.idx_;
+        }
+        friend bool operator<(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ < b.idx_;
+        }
+        friend bool operator>(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ > b.idx_;
+        }
+        friend bool operator<=(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ <= b.idx_;
+        }
+        friend bool operator>=(const ragged_iterator& a, const ragged_iterator& b)
+        {
+            return a.idx_ >= b.idx_;
+        }
+    };
+
+    // The types of the rows in the first dimension.
+    template<typename T, long NDims>
+    struct ragged_row_traits {
+        using value_type = ragged<std::remove_const_t<T>, NDims - 1>;
+        using reference = ragged_view<T, NDims - 1>;
+        using iterator = ragged_iterator<T, NDims>;
+    };
+
+    // One-dimensional ragged arrays are iterated by plain pointers.
+    template<typename T>
+    struct ragged_row_traits<T, 1> {
+        using value_type = std::remove_const_t<T>;
+        using reference = T&;
+        using iterator = T*;
+    };
+
+}  // namespace detail
+
+/// \ingroup Ragged
+/// \brief Non-owning view of a ragged array, e.g., of a single row of a ragged array.
+///
+/// The view refers to a range of rows of the first dimension. All the values
+/// of the view are stored contiguously, see data() and numel().
+template<typename T, long NDims>
+class ragged_view {
+private:
+    template<typename, long> friend class ragged;
+    template<typename, long> friend class ragged_view;
+
+    using traits = detail::ragged_row_traits<T, NDims>;
+
+    T* values_ = nullptr;
+    std::array<const std::size_t*, NDims - 1> splits_{};
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+
+    // the range of the values of the selected rows
+    std::pair<std::size_t, std::size_t> value_range() const
+    {
+        std::size_t lo = begin_;
+        std::size_t hi = end_;
+        for (long d = 0; d < NDims - 1; ++d) {
+            lo = splits_[d][lo];
+            hi = splits_[d][hi];
+        }
+        return {lo, hi};
+    }
+
+public:
+    static_assert(NDims > 0, "Ragged array has to have at least one dimension.");
+
+    using element_type = T;
+    using value_type = typename traits::value_type;
+    using reference = typename traits::reference;
+    using const_reference = reference;
+    using iterator = typename traits::iterator;
+    using const_iterator = iterator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    ragged_view() = default;
+
+    ragged_view(T* values, std::array<const std::size_t*, NDims - 1> splits,
+                std::size_t begin, std::size_t end)
+      : values_{values}
+      , splits_{splits}
+      , begin_{begin}
+      , end_{end}
+    {
+    }
+
+    /// A view of mutable data is convertible to a view of const data.
+    template<typename U, typename = std::enable_if_t<std::is_same<const U, T>{}>>
+    ragged_view(const ragged_view<U, NDims>& that)
+      : ragged_view{that.values_, that.splits_, that.begin_, that.end_}
+    {
+    }
+
+    /// The number of dimensions.
+    static constexpr long ndims() { return NDims; }
+
+    /// The size of the first dimension.
+    std::size_t size() const { return end_ - begin_; }
+
+    /// Whether the first dimension is empty.
+    bool empty() const { return size() == 0; }
+
+    /// The total number of values.
+    std::size_t numel() const
+    {
+        auto range = value_range();
+        return range.second - range.first;
+    }
+
+    /// The contiguous values of the view.
+    T* data() const { return values_ + value_range().first; }
+
+    iterator begin() const
+    {
+        if constexpr (NDims == 1) return values_ + begin_;
+        else return {values_, splits_, static_cast<std::ptrdiff_t>(begin_)};
+    }
+    iterator end() const { return begin() + size(); }
+
+    /// Access a row (or a value if the view is one-dimensional).
+    reference operator[](std::size_t i) const { return begin()[i]; }
+};
+
+/// \ingroup Ragged
+/// \brief Multidimensional array with variable-length rows.
+///
+/// All the values are stored in a single flat buffer. Each dimension except the last one
+/// is described by row splits, i.e., by the offsets of its rows in the next dimension.
+/// As a consequence, the size of any row is known in O(1) and padding or exporting the
+/// array does not have to traverse nested vectors.
+///
+/// The first dimension behaves like an std::vector of rows, i.e., the array can be
+/// iterated, extended by push_back() and insert() and reserved in the first dimension.
+/// Iteration yields \ref ragged_view "ragged_views" of the rows.
+///
+/// Example:
+/// \code
+///     cxtream::ragged<int, 2> seqs{{1, 2}, {3}, {}, {4, 5, 6}};
+///     // seqs.values() == {1, 2, 3, 4, 5, 6}
+///     // seqs.row_splits(0) == {0, 2, 3, 3, 6}
+///     // seqs[3].size() == 3
+///     cxtream::tensor<int, 2> padded = seqs.to_tensor(-1);
+///     // padded == {{1, 2, -1}, {3, -1, -1}, {-1, -1, -1}, {4, 5, 6}}
+/// \endcode
+template<typename T, long NDims>
+class ragged {
+private:
+    using traits = detail::ragged_row_traits<T, NDims>;
+
+    static_assert(NDims > 0, "Ragged array has to have at least one dimension.");
+    static_assert(!std::is_same<T, bool>{}, "Ragged array cannot store bool due to the"
+                                             " std::vector<bool> specialization, use"
+                                             " std::uint8_t or char instead.");
+
+    std::vector<T> values_;
+    // the offsets of the rows of each dimension in the next dimension
+    std::array<std::vector<std::size_t>, NDims - 1> splits_;
+
+    // the number of rows in the given dimension, the values are the last dimension
+    std::size_t level_size(long level) const
+    {
+        if (level == NDims - 1) return values_.size();
+        return splits_[level].size() - 1;
+    }
+
+    std::array<const std::size_t*, NDims - 1> split_ptrs() const
+    {
+        std::array<const std::size_t*, NDims - 1> ptrs;
+        for (long d = 0; d < NDims - 1; ++d) ptrs[d] = splits_[d].data();
+        return ptrs;
+    }
+
+    // append a row given by a view
+    void append_view(const ragged_view<const T, NDims - 1>& row)
+    {
+        std::size_t lo = row.begin_;
+        std::size_t hi = row.end_;
+        splits_[0].push_back(level_size(1) + hi - lo);
+        for (long d = 0; d < NDims - 2; ++d) {
+            std::size_t base = splits_[d + 1].back();
+            const std::size_t* row_splits = row.splits_[d];
+            for (std::size_t j = lo + 1; j <= hi; ++j) {
+                splits_[d + 1].push_back(base + row_splits[j] - row_splits[lo]);
+            }
+            lo = row_splits[lo];
+            hi = row_splits[hi];
+        }
+        values_.insert(values_.end(), row.values_ + lo, row.values_ + hi);
+    }
+
+    // append a row given by a nested range to the given dimension
+    template<long Level, typename Rng>
+    void append_nested(Rng&& row)
+    {
+        for (auto&& child : row) {
+            if constexpr (Level + 1 == NDims - 1) values_.push_back(child);
+            else append_nested<Level + 1>(child);
+        }
+        splits_[Level].push_back(level_size(Level + 1));
+    }
+
+    // call fun(value_offset, dense_offset, length) for each contiguous run of values
+    // as if the array was stored in a dense tensor of the given shape
+    template<long Level, typename Fun>
+    void for_each_run(std::size_t lo, std::size_t hi, std::size_t dense_offset,
+                      const std::array<std::size_t, NDims>& strides, Fun& fun) const
+    {
+        if constexpr (Level == NDims - 1) {
+            if (hi > lo) fun(lo, dense_offset, hi - lo);
+        } else {
+            for (std::size_t i = lo; i < hi; ++i) {
+                for_each_run<Level + 1>(splits_[Level][i], splits_[Level][i + 1],
+                                        dense_offset + (i - lo) * strides[Level], strides, fun);
+            }
+        }
+    }
+
+    template<typename Fun>
+    void for_each_run(const std::array<std::size_t, NDims>& shape, Fun fun) const
+    {
+        std::array<std::size_t, NDims> strides;
+        strides[NDims - 1] = 1;
+        for (long d = NDims - 1; d > 0; --d) strides[d - 1] = strides[d] * shape[d];
+        for_each_run<0>(0, size(), 0, strides, fun);
+    }
+
+    // set the row splits of a rectangular array of the given shape
+    void rectangular_splits(const std::array<std::size_t, NDims>& shape)
+    {
+        std::size_t n_rows = shape[0];
+        for (long d = 0; d < NDims - 1; ++d) {
+            std::size_t row_length = shape[d + 1];
+            splits_[d].resize(n_rows + 1);
+            for (std::size_t i = 0; i <= n_rows; ++i) splits_[d][i] = i * row_length;
+            n_rows *= row_length;
+        }
+    }
+
+public:
+    using element_type = T;
+    using value_type = typename traits::value_type;
+    using reference = typename traits::reference;
+    using const_reference = typename detail::ragged_row_traits<const T, NDims>::reference;
+    using iterator = typename traits::iterator;
+    using const_iterator = typename detail::ragged_row_traits<const T, NDims>::iterator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    ragged()
+    {
+        for (auto& splits : splits_) splits.push_back(0);
+    }
+
+    /// Create a ragged array from the given rows.
+    ///
+    /// For one-dimensional arrays, this constructor creates an array from the given
+    /// values. The rows can also be nested ranges (e.g., std::vector<std::vector<T>>).
+    ragged(std::initializer_list<value_type> rows)
+      : ragged{}
+    {
+        reserve(rows.size());
+        for (auto& row : rows) push_back(row);
+    }
+
+    /// \copydoc ragged(std::initializer_list<value_type>)
+    template<typename Rng, typename = std::enable_if_t<
+      detail::is_raggable<std::remove_reference_t<Rng>, T, NDims>::value
+      && !is_ragged<std::decay_t<Rng>>{} && !is_tensor<std::decay_t<Rng>>{}>>
+    ragged(Rng&& rows)
+      : ragged{}
+    {
+        for (auto&& row : rows) push_back(row);
+    }
+
+    /// Copy the data of a ragged view.
+    template<typename U, typename = std::enable_if_t<std::is_same<std::remove_const_t<U>, T>{}>>
+    ragged(const ragged_view<U, NDims>& view)
+      : ragged{}
+    {
+        insert(end(), view.begin(), view.end());
+    }
+
+    /// Create a ragged array with rows of equal lengths from a dense tensor.
+    template<typename Tensor, typename = std::enable_if_t<is_tensor<Tensor>{}>>
+    explicit ragged(const Tensor& dense)
+      : values_(dense.data(), dense.data() + dense.numel())
+    {
+        static_assert(Tensor::ndims() == NDims);
+        rectangular_splits(dense.shape());
+    }
+
+    /// Create a ragged array with rows of equal lengths filled with the given value.
+    ///
+    /// The row splits are computed from the shape, no rows are appended one by one.
+    explicit ragged(const std::array<std::size_t, NDims>& shape, const T& value = T{})
+      : values_(detail::shape_numel(shape), value)
+    {
+        rectangular_splits(shape);
+    }
+
+    /// The number of dimensions.
+    static constexpr long ndims() { return NDims; }
+
+    /// The size of the first dimension.
+    std::size_t size() const { return level_size(0); }
+
+    /// Whether the first dimension is empty.
+    bool empty() const { return size() == 0; }
+
+    /// The total number of values.
+    std::size_t numel() const { return values_.size(); }
+
+    /// The flat buffer of all the values.
+    const std::vector<T>& values() const { return values_; }
+
+    T* data() { return values_.data(); }
+    const T* data() const { return values_.data(); }
+
+    /// The offsets of the rows of the given dimension in the next dimension.
+    ///
+    /// The offsets of the rows of the dimension `NDims - 2` point to values().
+    const std::vector<std::size_t>& row_splits(std::size_t dim) const
+    {
+        assert(static_cast<long>(dim) < NDims - 1);
+        return splits_[dim];
+    }
+
+    /// Create a view of this array.
+    ragged_view<T, NDims> view() { return {values_.data(), split_ptrs(), 0, size()}; }
+    ragged_view<const T, NDims> view() const { return {values_.data(), split_ptrs(), 0, size()}; }
+
+    iterator begin() { return view().begin(); }
+    iterator end() { return view().end(); }
+    const_iterator begin() const { return view().begin(); }
+    const_iterator end() const { return view().end(); }
+
+    /// Access a row (or a value if the array is one-dimensional).
+    reference operator[](std::size_t i) { return begin()[i]; }
+    const_reference operator[](std::size_t i) const { return begin()[i]; }
+
+    /// Access a row with bounds checking.
+    reference at(std::size_t i)
+    {
+        if (i >= size()) throw std::out_of_range{"Ragged array index out of range."};
+        return (*this)[i];
+    }
+    const_reference at(std::size_t i) const
+    {
+        if (i >= size()) throw std::out_of_range{"Ragged array index out of range."};
+        return (*this)[i];
+    }
+
+    /// The number of rows in the first dimension for which the memory is reserved.
+    std::size_t capacity() const
+    {
+        if constexpr (NDims == 1) return values_.capacity();
+        else return splits_[0].capacity() - 1;
+    }
+
+    /// Reserve memory for the given number of rows in the first dimension.
+    void reserve(std::size_t n)
+    {
+        if constexpr (NDims == 1) values_.reserve(n);
+        else splits_[0].reserve(n + 1);
+    }
+
+    /// Reserve memory for the given total number of values.
+    void reserve_values(std::size_t n)
+    {
+        values_.reserve(n);
+    }
+
+    /// Remove all the rows, but keep the allocated memory.
+    void clear()
+    {
+        values_.clear();
+        for (auto& splits : splits_) splits.resize(1);
+    }
+
+    /// Resize the first dimension. New rows are empty.
+    void resize(std::size_t n)
+    {
+        if constexpr (NDims == 1) {
+            values_.resize(n);
+        } else if (n >= size()) {
+            splits_[0].resize(n + 1, splits_[0].back());
+        } else {
+            std::size_t keep = n;
+            for (long d = 0; d < NDims - 1; ++d) {
+                splits_[d].resize(keep + 1);
+                keep = splits_[d][keep];
+            }
+            values_.resize(keep);
+        }
+    }
+
+    /// Append a row (or a value if the array is one-dimensional).
+    ///
+    /// The row can be a ragged array, a ragged view or a nested range.
+    template<typename Row>
+    void push_back(Row&& row)
+    {
+        if constexpr (NDims == 1) {
+            values_.push_back(std::forward<Row>(row));
+        } else if constexpr (std::is_same<std::decay_t<Row>, ragged<T, NDims - 1>>{}) {
+            append_view(std::as_const(row).view());
+        } else if constexpr (is_ragged<std::decay_t<Row>>{}) {
+            append_view(ragged_view<const T, NDims - 1>{row});
+        } else {
+            append_nested<0>(row);
+        }
+    }
+
+    /// Append multiple rows at the end of the array.
+    ///
+    /// The position has to be the end of the array.
+    template<typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        assert(pos == std::as_const(*this).end() && "Ragged array only supports insertion at its end.");
+        std::size_t old_size = size();
+        if constexpr (NDims == 1) {
+            values_.insert(values_.end(), first, last);
+        } else {
+            for (; first != last; ++first) push_back(*first);
+        }
+        return begin() + old_size;
+    }
+
+    /// The maximum length of the rows in each dimension.
+    ///
+    /// This is the shape of the tensor the array would be padded to.
+    std::array<std::size_t, NDims> max_shape() const
+    {
+        std::array<std::size_t, NDims> shape{};
+        shape[0] = size();
+        for (long d = 0; d < NDims - 1; ++d) {
+            for (std::size_t i = 0; i + 1 < splits_[d].size(); ++i) {
+                shape[d + 1] = std::max(shape[d + 1], splits_[d][i + 1] - splits_[d][i]);
+            }
+        }
+        return shape;
+    }
+
+    /// Pad the rows to max_shape() and return the result as a dense tensor.
+    ///
+    /// Each contiguous run of values is copied to the tensor at once.
+    tensor<T, NDims> to_tensor(const T& value = T{}) const
+    {
+        std::array<std::size_t, NDims> shape = max_shape();
+        tensor<T, NDims> dense(shape, value);
+        for_each_run(shape, [this, &dense](std::size_t from, std::size_t to, std::size_t n) {
+            std::copy_n(values_.data() + from, n, dense.data() + to);
+        });
+        return dense;
+    }
+
+    /// Pad the rows to max_shape() and create the mask of the result at once.
+    ///
+    /// Both the padded array and the mask can be either tensors or ragged arrays
+    /// (whose rows will all be of the same length). This is equivalent to, but faster
+    /// than, calling to_tensor() and mask(), because the shape is computed only once
+    /// and each contiguous run of values is copied and masked in a single pass.
+    ///
+    /// \param value The value to pad with.
+    /// \param dense The destination of the padded array.
+    /// \param mask The destination of the mask, see mask().
+    template<typename Dense, typename Mask>
+    void pad(const T& value, Dense& dense, Mask& mask) const
+    {
+        using M = typename Mask::element_type;
+        static_assert(std::is_same<typename Dense::element_type, T>{}
+                      && Dense::ndims() == NDims && Mask::ndims() == NDims,
+                      "Ragged array can only be padded to an array of the same type and shape.");
+        std::array<std::size_t, NDims> shape = max_shape();
+        dense = Dense(shape, value);
+        mask = Mask(shape, M{0});
+        for_each_run(shape, [this, &dense, &mask](std::size_t from, std::size_t to, std::size_t n) {
+            std::copy_n(values_.data() + from, n, dense.data() + to);
+            std::fill_n(mask.data() + to, n, M{1});
+        });
+    }
+
+    /// Create the mask of the tensor returned by to_tensor().
+    ///
+    /// The mask is 1 on the positions of the original values and 0 on the padded positions.
+    template<typename M = std::uint8_t>
+    tensor<M, NDims> mask() const
+    {
+        std::array<std::size_t, NDims> shape = max_shape();
+        tensor<M, NDims> mask(shape, M{0});
+        for_each_run(shape, [&mask](std::size_t, std::size_t to, std::size_t n) {
+            std::fill_n(mask.data() + to, n, M{1});
+        });
+        return mask;
+    }
+};
+
+/// \ingroup Ragged
+/// \brief Compare the structure and the values of two ragged arrays or ragged views.
+template<typename A, typename B>
+std::enable_if_t<is_ragged<A>{} && is_ragged<B>{}, bool>
+operator==(const A& a, const B& b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+/// \ingroup Ragged
+/// \brief Compare the structure and the values of two ragged arrays or ragged views.
+template<typename A, typename B>
+std::enable_if_t<is_ragged<A>{} && is_ragged<B>{}, bool>
+operator!=(const A& a, const B& b)
+{
+    return !(a == b);
+}
+
+}  // namespace cxtream
+#endif
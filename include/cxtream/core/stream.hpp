@@ -13,15 +13,21 @@
 /// \defgroup Stream Stream modifiers and data types.
 
 #include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/stream/bucket_batch.hpp>
 #include <cxtream/core/stream/buffer.hpp>
 #include <cxtream/core/stream/column.hpp>
 #include <cxtream/core/stream/create.hpp>
 #include <cxtream/core/stream/drop.hpp>
 #include <cxtream/core/stream/filter.hpp>
 #include <cxtream/core/stream/for_each.hpp>
+#include <cxtream/core/stream/from_csv.hpp>
 #include <cxtream/core/stream/generate.hpp>
+#include <cxtream/core/stream/materialize.hpp>
+#include <cxtream/core/stream/pack.hpp>
 #include <cxtream/core/stream/pad.hpp>
+#include <cxtream/core/stream/pipe.hpp>
 #include <cxtream/core/stream/random_fill.hpp>
+#include <cxtream/core/stream/shuffle.hpp>
 #include <cxtream/core/stream/transform.hpp>
 #include <cxtream/core/stream/unpack.hpp>
 
@@ -17,6 +17,12 @@
 #include <range/v3/view/view.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace cxtream::stream {
 
@@ -43,6 +49,181 @@ constexpr std::size_t batch_size(const Tuple& tuple)
     return std::get<0>(tuple).value().size();
 }
 
+namespace detail {
+
+    // Check whether the storage is not referred to by anybody else.
+    template<typename T>
+    bool is_released(const std::shared_ptr<T>& ptr)
+    {
+        if (!ptr || ptr.use_count() != 1) return false;
+        // synchronize with the release of the last reference in another thread
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    // Remove the data from the batch but keep the allocated memory.
+    template<typename Batch>
+    void clear_batch(Batch& batch)
+    {
+        utility::tuple_for_each(batch, [](auto& column) { column.value().clear(); });
+    }
+
+    // Reserve space for the given number of examples in each column of the batch.
+    //
+    // The target batch size may be std::numeric_limits<std::size_t>::max(), so the
+    // callers reserve at most the examples available in the current subbatch and
+    // the later batches rely on the capacity of the recycled storage.
+    template<typename Batch>
+    void reserve_batch(Batch& batch, std::size_t n)
+    {
+        utility::tuple_for_each(batch, [n](auto& column) { column.value().reserve(n); });
+    }
+
+    template<typename Batch, std::size_t... Is>
+    void move_examples_impl(Batch& to, Batch& from, std::size_t from_idx, std::size_t n,
+                            std::index_sequence<Is...>)
+    {
+        auto splice = [from_idx, n](auto& to, auto& from) {
+            auto first = std::make_move_iterator(from.begin() + from_idx);
+            to.insert(to.end(), first, first + n);
+        };
+        (..., splice(std::get<Is>(to).value(), std::get<Is>(from).value()));
+    }
+
+    // Move n examples starting at the given index of one batch to the end of another batch.
+    //
+    // The examples are moved as a contiguous run in each column.
+    template<typename Batch>
+    void move_examples(Batch& to, Batch& from, std::size_t from_idx, std::size_t n)
+    {
+        move_examples_impl(to, from, from_idx, n,
+                           std::make_index_sequence<std::tuple_size<Batch>{}>{});
+    }
+
+    // Read the subbatches of a range one by one and track the index of the first
+    // example of the current subbatch which has not been processed yet.
+    //
+    // The storage of the current subbatch is recycled for the next subbatch
+    // if nobody else refers to it.
+    template<typename Rng>
+    class subbatch_reader {
+    public:
+        using batch_type = ranges::range_value_type_t<Rng>;
+
+        subbatch_reader() = default;
+        explicit subbatch_reader(Rng& rng)
+          : rng_{&rng}
+          , it_{ranges::begin(rng)}
+        {
+            if (it_ == ranges::end(*rng_)) done_ = true;
+            else load_subbatch();
+        }
+
+        // the current subbatch, valid unless the reader is done
+        batch_type& subbatch() const
+        {
+            return *subbatch_;
+        }
+
+        // the index of the first unprocessed example of the current subbatch
+        std::size_t index() const
+        {
+            return subbatch_idx_;
+        }
+
+        // the number of unprocessed examples in the current subbatch
+        std::size_t remaining() const
+        {
+            return done_ ? 0 : batch_size(*subbatch_) - subbatch_idx_;
+        }
+
+        // mark the given number of examples of the current subbatch as processed
+        void advance(std::size_t n = 1)
+        {
+            assert(n <= remaining());
+            subbatch_idx_ += n;
+        }
+
+        // load the subbatches until there is an unprocessed example
+        //
+        // Returns false if the end of the range is reached.
+        bool find_next()
+        {
+            while (!done_ && remaining() == 0) {
+                if (++it_ == ranges::end(*rng_)) done_ = true;
+                else load_subbatch();
+            }
+            return !done_;
+        }
+
+        bool equal(const subbatch_reader& that) const
+        {
+            return it_ == that.it_ && subbatch_idx_ == that.subbatch_idx_;
+        }
+
+    private:
+        Rng* rng_ = nullptr;
+        ranges::iterator_t<Rng> it_ = {};
+        // the subbatch of the original range
+        std::shared_ptr<batch_type> subbatch_;
+        // the current index into the batch of the original range
+        std::size_t subbatch_idx_ = 0;
+        bool done_ = false;
+
+        // the subbatches of a single pass range are visited only once, so they are moved
+        decltype(auto) take_subbatch() const
+        {
+            if constexpr (ranges::ForwardRange<Rng>()) return *it_;
+            else return ranges::iter_move(it_);
+        }
+
+        void load_subbatch()
+        {
+            if (is_released(subbatch_)) *subbatch_ = take_subbatch();
+            else subbatch_ = std::make_shared<batch_type>(take_subbatch());
+            subbatch_idx_ = 0;
+        }
+    };
+
+    // The common part of the single pass cursors which accumulate the examples
+    // from a subbatch_reader and yield them in batches of their own.
+    //
+    // The derived cursor provides `bool fill_batch()`, which fills the batch_
+    // and returns false if there is nothing more to be yielded. It has to call
+    // start() once it is constructed.
+    template<typename Cursor, typename Batch>
+    class rebatch_cursor {
+    protected:
+        // the batch provided to the user
+        std::shared_ptr<Batch> batch_ = std::make_shared<Batch>();
+        bool done_ = false;
+
+        void start()
+        {
+            next();
+        }
+
+    public:
+        using single_pass = std::true_type;
+
+        decltype(auto) read() const
+        {
+            return *batch_;
+        }
+
+        bool equal(ranges::default_sentinel) const
+        {
+            return done_;
+        }
+
+        void next()
+        {
+            done_ = !static_cast<Cursor&>(*this).fill_batch();
+        }
+    };
+
+}  // namespace detail
+
 template <typename Rng>
 struct batch_view : ranges::view_facade<batch_view<Rng>> {
 private:
@@ -55,79 +236,50 @@ private:
     struct cursor {
     private:
         batch_view<Rng>* rng_ = nullptr;
-        ranges::iterator_t<Rng> it_ = {};
+        detail::subbatch_reader<Rng> reader_;
 
         using batch_t_ = ranges::range_value_type_t<Rng>;
-        using column_idxs_t = std::make_index_sequence<std::tuple_size<batch_t_>{}>;
         // the batch into which we accumulate the data
         // the batch will be a pointer to allow moving from it in const functions
         std::shared_ptr<batch_t_> batch_ = std::make_shared<batch_t_>();
-
-        // the subbatch of the original range
-        std::shared_ptr<batch_t_> subbatch_;
-        // the current index into the batch of the original range
-        std::size_t subbatch_idx_ = 0;
+        // the previous batch, its storage is reused once nobody else refers to it
+        std::shared_ptr<batch_t_> spare_batch_;
 
         bool done_ = false;
 
-        // reserve space in subbatch
-        template <std::size_t... Is>
-        void reserve_batch(std::index_sequence<Is...>)
+        // provide an empty batch, preferably recycled from one of the previous ones
+        void recycle_batch()
         {
-            std::size_t reserve_n = std::min(rng_->n_, std::size_t{1000});
-            (..., (std::get<Is>(*batch_).value().reserve(reserve_n)));
-        }
-
-        // move i-th element from subbatch_ to batch_
-        template <std::size_t... Is>
-        void move_from_subbatch(std::size_t i, std::index_sequence<Is...>)
-        {
-            (..., (std::get<Is>(*batch_).value().push_back(
-                   std::move(std::get<Is>(*subbatch_).value()[i]))));
-        }
-
-        // find the first non-empty subbatch and return if successful
-        bool find_next()
-        {
-            // do nothing if the end of iteration is reached
-            if (subbatch_idx_ == batch_size(*subbatch_) && it_ == ranges::end(rng_->rng_)) {
-                return false;
-            }
-            // otherwise find the first non-empty subbatch
-            while (subbatch_idx_ == batch_size(*subbatch_)) {
-                if (++it_ == ranges::end(rng_->rng_)) {
-                    return false;
-                }
-                subbatch_ = std::make_shared<batch_t_>(*it_);
-                subbatch_idx_ = 0;
+            if (!detail::is_released(batch_)) {
+                std::swap(batch_, spare_batch_);
+                if (!detail::is_released(batch_)) batch_ = std::make_shared<batch_t_>();
             }
-            return true;
+            detail::clear_batch(*batch_);
         }
 
-        // fill the batch_ with the elements from the current subbatch_
+        // fill the batch_ with the elements from the current subbatch
         void fill_batch()
         {
-            reserve_batch(column_idxs_t{});
+            // once the storage is recycled, it already has the capacity of the previous batch
+            detail::reserve_batch(*batch_, std::min(rng_->n_, reader_.remaining()));
             do {
-                move_from_subbatch(subbatch_idx_++, column_idxs_t{});
-            } while (batch_size(*batch_) < rng_->n_ && find_next());
+                // move the whole contiguous run at once
+                std::size_t n = std::min(rng_->n_ - batch_size(*batch_), reader_.remaining());
+                detail::move_examples(*batch_, reader_.subbatch(), reader_.index(), n);
+                reader_.advance(n);
+            } while (batch_size(*batch_) < rng_->n_ && reader_.find_next());
         }
 
     public:
         cursor() = default;
         explicit cursor(batch_view<Rng>& rng)
           : rng_{&rng}
-          , it_{ranges::begin(rng_->rng_)}
+          , reader_{rng_->rng_}
         {
             static_assert(std::tuple_size<std::decay_t<decltype(*batch_)>>{} &&
                           "The range to be batched has to contain at least one column");
-            // do nothing if the subrange is empty
-            if (it_ != ranges::end(rng_->rng_)) {
-                subbatch_ = std::make_shared<batch_t_>(*it_);
-                // if the first subbatch is empty, try to find the next non-empty one
-                if (batch_size(*subbatch_) == 0) next();
-                else fill_batch();
-            }
+            // skip the empty subbatches at the beginning
+            if (reader_.find_next()) fill_batch();
             else done_ = true;
         }
 
@@ -144,13 +296,13 @@ private:
         bool equal(const cursor& that) const
         {
             assert(rng_ == that.rng_);
-            return it_ == that.it_ && subbatch_idx_ == that.subbatch_idx_;
+            return reader_.equal(that.reader_);
         }
 
         void next()
         {
-            batch_ = std::make_shared<batch_t_>();
-            if (find_next()) fill_batch();
+            recycle_batch();
+            if (reader_.find_next()) fill_batch();
             else done_ = true;
         }
     };  // struct cursor
@@ -191,6 +343,11 @@ public:
 /// The batch size of the accumulated columns is allowed to differ between batches.
 /// To make one large batch of all the data, use std::numeric_limits<std::size_t>::max().
 ///
+/// The examples are moved between the batches in contiguous runs. The storage of
+/// the batches is recycled once the iterator is advanced and no copy of the iterator
+/// refers to the previous batch, so the steady state re-batching does not allocate
+/// as long as the consumer does not move the columns out of the batch.
+///
 /// \code
 ///     CXTREAM_DEFINE_COLUMN(value, int)
 ///     auto rng = view::iota(0, 10)
@@ -0,0 +1,199 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_BUCKET_BATCH_HPP
+#define CXTREAM_CORE_STREAM_BUCKET_BATCH_HPP
+
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/stream/template_arguments.hpp>
+
+#include <range/v3/core.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cxtream::stream {
+
+template <typename Rng, typename Column>
+struct bucket_batch_view : ranges::view_facade<bucket_batch_view<Rng, Column>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+    Rng rng_;
+    std::vector<std::size_t> boundaries_;
+    std::size_t n_;
+    std::size_t max_buffered_;
+
+    struct cursor : detail::rebatch_cursor<cursor, ranges::range_value_type_t<Rng>> {
+    private:
+        using batch_t_ = ranges::range_value_type_t<Rng>;
+        friend detail::rebatch_cursor<cursor, batch_t_>;
+        using detail::rebatch_cursor<cursor, batch_t_>::batch_;
+
+        bucket_batch_view<Rng, Column>* rng_ = nullptr;
+        detail::subbatch_reader<Rng> reader_;
+
+        // the accumulators of the examples of each bucket
+        std::shared_ptr<std::vector<batch_t_>> buckets_;
+        // the number of examples in all the buckets
+        std::size_t n_buffered_ = 0;
+
+        // find the bucket of the example at the current index of the subbatch
+        std::size_t current_bucket() const
+        {
+            std::size_t length =
+              ranges::size(std::get<Column>(reader_.subbatch()).value()[reader_.index()]);
+            const std::vector<std::size_t>& bounds = rng_->boundaries_;
+            return std::upper_bound(bounds.begin(), bounds.end(), length) - bounds.begin();
+        }
+
+        // provide the given bucket to the user
+        //
+        // The batch is swapped with the bucket, so the storage of the previous
+        // batch is recycled by the bucket if nobody else refers to it.
+        void emit(std::size_t bucket_idx)
+        {
+            if (!detail::is_released(batch_)) batch_ = std::make_shared<batch_t_>();
+            batch_t_& bucket = (*buckets_)[bucket_idx];
+            std::swap(*batch_, bucket);
+            detail::clear_batch(bucket);
+            n_buffered_ -= batch_size(*batch_);
+        }
+
+        // the bucket with the most examples
+        std::size_t largest_bucket() const
+        {
+            auto it = std::max_element(buckets_->begin(), buckets_->end(),
+              [](const batch_t_& a, const batch_t_& b) { return batch_size(a) < batch_size(b); });
+            return it - buckets_->begin();
+        }
+
+        // distribute the examples to the buckets until a batch can be emitted
+        bool fill_batch()
+        {
+            while (reader_.find_next()) {
+                std::size_t bucket_idx = current_bucket();
+                batch_t_& bucket = (*buckets_)[bucket_idx];
+                if (batch_size(bucket) == 0) {
+                    detail::reserve_batch(bucket, std::min(rng_->n_, reader_.remaining()));
+                }
+                detail::move_examples(bucket, reader_.subbatch(), reader_.index(), 1);
+                reader_.advance();
+                ++n_buffered_;
+                if (batch_size(bucket) >= rng_->n_) {
+                    emit(bucket_idx);
+                    return true;
+                }
+                if (n_buffered_ >= rng_->max_buffered_) {
+                    emit(largest_bucket());
+                    return true;
+                }
+            }
+            // flush the partially filled buckets at the end of the stream
+            if (n_buffered_ > 0) {
+                emit(largest_bucket());
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        cursor() = default;
+        explicit cursor(bucket_batch_view<Rng, Column>& rng)
+          : rng_{&rng}
+          , reader_{rng_->rng_}
+          , buckets_{std::make_shared<std::vector<batch_t_>>(rng_->boundaries_.size() + 1)}
+        {
+            static_assert(std::tuple_size<batch_t_>{} &&
+                          "The range to be batched has to contain at least one column");
+            this->start();
+        }
+    };  // struct cursor
+
+    cursor begin_cursor() { return cursor{*this}; }
+
+public:
+    bucket_batch_view() = default;
+    bucket_batch_view(Rng rng, std::vector<std::size_t> boundaries,
+                      std::size_t n, std::size_t max_buffered)
+      : rng_{rng}
+      , boundaries_{std::move(boundaries)}
+      , n_{n}
+      , max_buffered_{max_buffered}
+    {
+        if (!std::is_sorted(boundaries_.begin(), boundaries_.end())) {
+            throw std::invalid_argument{"Bucket boundaries have to be sorted."};
+        }
+        if (n_ == 0) throw std::invalid_argument{"Batch size has to be positive."};
+        if (max_buffered_ == 0) max_buffered_ = (boundaries_.size() + 1) * n_;
+    }
+};  // class bucket_batch_view
+
+namespace detail {
+
+    struct bucket_batch_fn {
+        template <typename Rng, typename Column, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+        bucket_batch_view<ranges::view::all_t<Rng>, Column>
+        operator()(Rng&& rng, from_t<Column>, std::vector<std::size_t> boundaries,
+                   std::size_t n, std::size_t max_buffered) const
+        {
+            return {ranges::view::all(std::forward<Rng>(rng)),
+                    std::move(boundaries), n, max_buffered};
+        }
+    };
+
+}  // namespace detail
+
+/// \ingroup Stream
+/// \brief Accumulate the stream and yield batches of examples of similar length.
+///
+/// The examples are distributed to buckets by the size of the selected column. The bucket
+/// `i` contains the examples whose length is in `[boundaries[i-1], boundaries[i])`, the first
+/// and the last bucket are unbounded from below and from above, respectively. As soon as
+/// a bucket contains `n` examples, it is yielded as a batch. Hence, the examples in
+/// a batch have a similar length and stream::pad() does not waste the memory.
+///
+/// At most `max_buffered` examples are held in the buckets (it defaults to the number
+/// of buckets times `n`). If the limit is reached, the largest bucket is yielded
+/// even though it is not full. At the end of the stream, all the remaining buckets are
+/// yielded as well, the largest first.
+///
+/// The examples are moved to the buckets using the same logic as in stream::batch,
+/// and the storage of the yielded batches is recycled by the buckets.
+///
+/// \code
+///     CXTREAM_DEFINE_COLUMN(tokens, std::vector<int>)
+///     auto rng = data
+///       | create<tokens>()
+///       | bucket_batch(from<tokens>, {10, 20, 50}, 32)  // four buckets
+///       | pad(from<tokens>, mask<token_masks>);
+/// \endcode
+///
+/// \param f The column whose size (i.e., `ranges::size` of the example) is bucketed.
+/// \param boundaries The sorted boundaries of the buckets.
+/// \param n The batch size.
+/// \param max_buffered The maximum number of examples held in all the buckets.
+template <typename Column>
+auto bucket_batch(from_t<Column> f, std::vector<std::size_t> boundaries,
+                  std::size_t n, std::size_t max_buffered = 0)
+{
+    return ranges::make_pipeable(std::bind(detail::bucket_batch_fn{}, std::placeholders::_1,
+                                           f, std::move(boundaries), n, max_buffered));
+}
+
+}  // namespace cxtream::stream
+#endif
@@ -10,80 +10,573 @@
 #ifndef CXTREAM_CORE_STREAM_BUFFER_HPP
 #define CXTREAM_CORE_STREAM_BUFFER_HPP
 
+#include <cxtream/core/stream/column.hpp>
 #include <cxtream/core/thread.hpp>
 
 #include <range/v3/core.hpp>
 #include <range/v3/view/all.hpp>
 #include <range/v3/view/view.hpp>
 
+#include <atomic>
+#include <cassert>
 #include <climits>
+#include <condition_variable>
 #include <deque>
-#include <future>
+#include <exception>
+#include <experimental/optional>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace cxtream::stream {
 
-template<typename Rng>
-struct buffer_view : ranges::view_facade<buffer_view<Rng>> {
+/// \ingroup Stream
+/// \brief The memory limit of stream::buffer().
+///
+/// The buffer estimates the size of the elements using the elements which
+/// have already been evaluated and it does not evaluate more elements in advance
+/// than would fit into the given number of bytes.
+struct byte_budget {
+    std::size_t bytes;
+};
+
+namespace detail {
+
+    template<typename T, typename = void>
+    struct is_column : std::false_type {
+    };
+
+    template<typename T>
+    struct is_column<T, std::void_t<typename T::example_type>>
+      : std::is_base_of<column_base<typename T::example_type>, T> {
+    };
+
+    template<typename T>
+    struct is_tuple : std::false_type {
+    };
+
+    template<typename... Ts>
+    struct is_tuple<std::tuple<Ts...>> : std::true_type {
+    };
+
+    // Approximate the number of bytes occupied by the given value.
+    //
+    // Ranges, tuples and cxtream columns are measured recursively,
+    // other types are measured by sizeof.
+    template<typename T>
+    std::size_t byte_size(const T& value)
+    {
+        if constexpr (is_column<T>{}) {
+            return byte_size(value.value());
+        } else if constexpr (is_tuple<T>{}) {
+            return std::apply([](const auto&... vals) {
+                return (sizeof(T) + ... + (byte_size(vals) - sizeof(vals)));
+            }, value);
+        } else if constexpr (ranges::Range<const T>()) {
+            using Value = ranges::range_value_type_t<T>;
+            if constexpr (std::is_trivially_copyable<Value>{} && ranges::SizedRange<const T>()) {
+                return sizeof(T) + ranges::size(value) * sizeof(Value);
+            } else {
+                std::size_t size = sizeof(T);
+                for (const auto& elem : value) size += byte_size(elem);
+                return size;
+            }
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    // The evaluation tasks of a buffer which may be cancelled by the consumer.
+    //
+    // The tasks also measure the elements they evaluate, so that the consumer
+    // knows their size without waiting for them.
+    class buffer_tasks {
+    private:
+        std::mutex mutex_;
+        std::condition_variable done_cv_;
+        bool cancelled_ = false;
+        int n_running_ = 0;
+        std::atomic<std::size_t> n_measured_{0};
+        std::atomic<std::size_t> bytes_measured_{0};
+
+    public:
+        // Record the size of an evaluated element.
+        void measure(std::size_t bytes)
+        {
+            bytes_measured_ += bytes;
+            ++n_measured_;
+        }
+
+        // The average size of the evaluated elements or zero if none is known yet.
+        std::size_t avg_bytes() const
+        {
+            std::size_t n_measured = n_measured_;
+            if (n_measured == 0) return 0;
+            return bytes_measured_ / n_measured;
+        }
+
+        // Whether another element may be evaluated when the given number of elements
+        // is already buffered.
+        bool can_evaluate(std::size_t n_buffered, std::size_t n, std::size_t max_bytes) const
+        {
+            if (n_buffered >= n) return false;
+            if (max_bytes == std::numeric_limits<std::size_t>::max() || n_buffered == 0) {
+                return true;
+            }
+            // do not evaluate more elements until the size of an element is known
+            std::size_t avg = avg_bytes();
+            if (avg == 0) return false;
+            return (n_buffered + 1) * avg <= max_bytes;
+        }
+
+        // Evaluate the function unless the tasks were cancelled.
+        template<typename Fun>
+        std::experimental::optional<std::result_of_t<Fun()>> run(Fun& fun)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if (cancelled_) return std::experimental::nullopt;
+                ++n_running_;
+            }
+            // notify the waiting consumer even if the function throws
+            struct running_guard {
+                buffer_tasks& tasks;
+                ~running_guard()
+                {
+                    std::lock_guard<std::mutex> lock{tasks.mutex_};
+                    if (--tasks.n_running_ == 0) tasks.done_cv_.notify_all();
+                }
+            } guard{*this};
+            return fun();
+        }
+
+        // Skip the tasks which have not started yet and wait for the running ones.
+        void cancel_and_drain()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            cancelled_ = true;
+            done_cv_.wait(lock, [this]() { return n_running_ == 0; });
+        }
+    };
+
+    // The elements evaluated by an unordered buffer in the order of their completion.
+    template<typename T>
+    class buffer_channel {
+    private:
+        struct entry_t {
+            std::experimental::optional<T> value;
+            std::exception_ptr error;
+        };
+
+        std::mutex mutex_;
+        std::condition_variable ready_cv_;
+        std::deque<entry_t> entries_;
+
+        void push_entry(entry_t entry)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                entries_.push_back(std::move(entry));
+            }
+            ready_cv_.notify_one();
+        }
+
+    public:
+        void push(T value)
+        {
+            push_entry({std::move(value), nullptr});
+        }
+
+        void push_error(std::exception_ptr error)
+        {
+            push_entry({std::experimental::nullopt, std::move(error)});
+        }
+
+        // Wait for the first completed element.
+        //
+        // \throws The exception thrown by the evaluation of the element.
+        T pop()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            cxtream::detail::wait_helping(lock, ready_cv_, [this]() { return !entries_.empty(); });
+            entry_t entry = std::move(entries_.front());
+            entries_.pop_front();
+            if (entry.error) std::rethrow_exception(entry.error);
+            return std::move(*entry.value);
+        }
+    };
+
+    // The elements of a single pass range evaluated in advance by a buffer.
+    //
+    // The iterator of a single pass range cannot be shared by several tasks, so the
+    // range is evaluated sequentially by a dedicated thread, similarly to stream::pipe.
+    // The thread sleeps while the buffer is full and it is stopped and joined
+    // when the source is destroyed.
+    template<typename Iter, typename Sent, typename T>
+    class buffer_source {
+    private:
+        struct entry_t {
+            std::experimental::optional<T> value;
+            std::exception_ptr error;
+        };
+
+        std::mutex mutex_;
+        std::condition_variable ready_cv_;
+        std::condition_variable space_cv_;
+        // the iterator is only touched by the producer thread
+        Iter it_;
+        Sent end_;
+        std::deque<entry_t> entries_;
+        bool done_ = false;
+        bool stop_ = false;
+        std::thread producer_;
+
+        void push_entry(entry_t entry)
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            entries_.push_back(std::move(entry));
+            ready_cv_.notify_all();
+        }
+
+        // wait until an element is evaluated or the range ends
+        void wait(std::unique_lock<std::mutex>& lock)
+        {
+            cxtream::detail::wait_helping(lock, ready_cv_, [this]() {
+                return !entries_.empty() || done_;
+            });
+        }
+
+        entry_t pop_entry()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            wait(lock);
+            assert(!entries_.empty() && "The buffer is exhausted.");
+            entry_t entry = std::move(entries_.front());
+            entries_.pop_front();
+            space_cv_.notify_all();
+            return entry;
+        }
+
+        // If an element throws, the exception is handed to the consumer in its place.
+        // If the iteration itself throws, the exception is handed to the consumer
+        // and the range ends.
+        template<typename Evaluate, typename CanEvaluate>
+        void produce(Evaluate evaluate, CanEvaluate can_evaluate)
+        {
+            try {
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> lock{mutex_};
+                        space_cv_.wait(lock, [this, &can_evaluate]() {
+                            return stop_ || can_evaluate(entries_.size());
+                        });
+                        if (stop_) return;
+                    }
+                    if (it_ == end_) break;
+                    entry_t entry;
+                    try {
+                        entry.value.emplace(evaluate(it_));
+                    } catch (...) {
+                        entry.error = std::current_exception();
+                    }
+                    ++it_;
+                    push_entry(std::move(entry));
+                }
+            } catch (...) {
+                push_entry({std::experimental::nullopt, std::current_exception()});
+            }
+            std::lock_guard<std::mutex> lock{mutex_};
+            done_ = true;
+            ready_cv_.notify_all();
+        }
+
+    public:
+        buffer_source(Iter it, Sent end)
+          : it_{std::move(it)}
+          , end_{std::move(end)}
+        {
+        }
+
+        ~buffer_source()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                stop_ = true;
+            }
+            space_cv_.notify_all();
+            if (producer_.joinable()) producer_.join();
+        }
+
+        // Start the producer thread unless it is already running.
+        //
+        // The producer evaluates the next element whenever can_evaluate(n_buffered)
+        // returns true. The predicate is checked again whenever an element is popped.
+        template<typename Evaluate, typename CanEvaluate>
+        void start(Evaluate evaluate, CanEvaluate can_evaluate)
+        {
+            if (producer_.joinable()) return;
+            producer_ = std::thread{[this, evaluate, can_evaluate]() {
+                produce(std::move(evaluate), std::move(can_evaluate));
+            }};
+        }
+
+        // Wait until the next element is evaluated and return whether there is none.
+        //
+        // The producer has to be started beforehand.
+        bool exhausted()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            wait(lock);
+            return entries_.empty();
+        }
+
+        // Wait for the next element.
+        //
+        // \throws The exception thrown by the evaluation of the element.
+        T pop()
+        {
+            entry_t entry = pop_entry();
+            if (entry.error) std::rethrow_exception(entry.error);
+            return std::move(*entry.value);
+        }
+
+        // Skip the next element, including its exception.
+        void drop()
+        {
+            pop_entry();
+        }
+    };
+
+}  // namespace detail
+
+template<typename Rng, bool Ordered = true>
+struct buffer_view : ranges::view_facade<buffer_view<Rng, Ordered>> {
 private:
     /// \cond
     friend ranges::range_access;
     /// \endcond
 
+    static constexpr std::size_t no_limit = std::numeric_limits<std::size_t>::max();
+
     Rng rng_;
     std::size_t n_;
+    std::size_t max_bytes_ = no_limit;
+    thread_pool* pool_ = nullptr;
+
+    using element_t = ranges::range_value_type_t<Rng>;
+
+    // the iterators of a forward range are copied to the evaluation tasks,
+    // a single pass range is evaluated sequentially by a dedicated thread
+    static constexpr bool is_forward = ranges::ForwardRange<Rng>();
+    using source_t = detail::buffer_source<
+      ranges::iterator_t<Rng>, ranges::sentinel_t<Rng>, element_t>;
+
+    // The state of the iteration shared by the copies of a cursor.
+    struct state_t {
+        ranges::iterator_t<Rng> it;
+        // the elements of a single pass range
+        std::unique_ptr<source_t> source;
+        // the futures of the ordered buffer
+        std::deque<future<std::experimental::optional<element_t>>> buffer;
+        // the elements of the unordered buffer and the number of elements being evaluated
+        std::shared_ptr<detail::buffer_channel<element_t>> channel;
+        std::size_t n_evaluating = 0;
+        // the front element already moved out of its future or the channel
+        std::experimental::optional<element_t> current;
+        // the exception thrown by the evaluation of the front element
+        std::exception_ptr error;
+        std::shared_ptr<detail::buffer_tasks> tasks = std::make_shared<detail::buffer_tasks>();
+        bool started = false;
+
+        ~state_t()
+        {
+            // skip the tasks which have not started yet and wait for the running ones
+            tasks->cancel_and_drain();
+        }
+    };
 
     struct cursor {
     private:
-        buffer_view<Rng>* rng_ = nullptr;
-        ranges::iterator_t<Rng> it_ = {};
+        buffer_view<Rng, Ordered>* rng_ = nullptr;
+        std::shared_ptr<state_t> state_;
 
-        std::size_t n_;
-        std::deque<std::shared_future<ranges::range_value_type_t<Rng>>> buffer_;
+        std::size_t n_evaluating() const
+        {
+            if constexpr (Ordered) return state_->buffer.size();
+            else return state_->n_evaluating;
+        }
+
+        // move the next element out of its future, the channel or the source
+        void materialize() const
+        {
+            if (state_->error) std::rethrow_exception(state_->error);
+            if (state_->current) return;
+            try {
+                if constexpr (!is_forward) {
+                    state_->current = state_->source->pop();
+                } else if constexpr (Ordered) {
+                    auto front = std::move(state_->buffer.front());
+                    state_->buffer.pop_front();
+                    state_->current = front.get();
+                } else {
+                    --state_->n_evaluating;
+                    state_->current = state_->channel->pop();
+                }
+            } catch (...) {
+                // the failed element stays in front until the cursor moves past it
+                state_->error = std::current_exception();
+                throw;
+            }
+        }
 
         void pop_buffer()
         {
-            if (!buffer_.empty()) {
-                buffer_.pop_front();
+            if (state_->current || state_->error) {
+                state_->current = std::experimental::nullopt;
+                state_->error = nullptr;
+            } else if constexpr (!is_forward) {
+                state_->source->drop();
+            } else if constexpr (!Ordered) {
+                // the unordered buffer has to find out which element to skip
+                materialize();
+                state_->current = std::experimental::nullopt;
+            } else {
+                // the future is not waited for, the task still measures the element
+                state_->buffer.pop_front();
             }
         }
 
-        void fill_buffer()
+        bool can_evaluate() const
+        {
+            std::size_t n_buffered = n_evaluating() + (state_->current || state_->error ? 1 : 0);
+            return state_->tasks->can_evaluate(n_buffered, rng_->n_, rng_->max_bytes_);
+        }
+
+        // evaluate the element and measure it if the buffer has a byte budget
+        //
+        // The elements of a single pass range are visited only once, so they are moved.
+        static element_t evaluate(const ranges::iterator_t<Rng>& it,
+                                  detail::buffer_tasks& tasks,
+                                  bool measure)
+        {
+            element_t value = [&it]() -> element_t {
+                if constexpr (is_forward) return *it;
+                else return ranges::iter_move(it);
+            }();
+            if (measure) tasks.measure(detail::byte_size(value));
+            return value;
+        }
+
+        // start the thread evaluating the single pass range
+        void fill_source() const
         {
-            while (it_ != ranges::end(rng_->rng_) && buffer_.size() < n_) {
-                auto task = [it = it_]() { return *it; };
-                buffer_.emplace_back(global_thread_pool.enqueue(std::move(task)));
-                ++it_;
+            bool measure = rng_->max_bytes_ != no_limit;
+            auto eval = [tasks = state_->tasks, measure](const auto& it) {
+                return evaluate(it, *tasks, measure);
+            };
+            auto can_evaluate = [tasks = state_->tasks, n = rng_->n_,
+                                 max_bytes = rng_->max_bytes_](std::size_t n_buffered) {
+                return tasks->can_evaluate(n_buffered, n, max_bytes);
+            };
+            state_->source->start(std::move(eval), std::move(can_evaluate));
+        }
+
+        void fill_buffer() const
+        {
+            if constexpr (!is_forward) {
+                fill_source();
+            } else {
+                while (state_->it != ranges::end(rng_->rng_) && can_evaluate()) {
+                    bool measure = rng_->max_bytes_ != no_limit;
+                    if constexpr (Ordered) {
+                        auto task = [it = state_->it, measure](
+                          std::shared_ptr<detail::buffer_tasks> tasks) {
+                            auto eval = [&]() { return evaluate(it, *tasks, measure); };
+                            return tasks->run(eval);
+                        };
+                        state_->buffer.emplace_back(
+                          rng_->pool_->enqueue(std::move(task), state_->tasks));
+                    } else {
+                        // the evaluated element is sent to the channel instead of to the future
+                        auto task = [it = state_->it, measure](
+                          std::shared_ptr<detail::buffer_tasks> tasks,
+                          std::shared_ptr<detail::buffer_channel<element_t>> channel) {
+                            auto eval = [&]() { return evaluate(it, *tasks, measure); };
+                            try {
+                                if (auto value = tasks->run(eval)) channel->push(std::move(*value));
+                            } catch (...) {
+                                channel->push_error(std::current_exception());
+                            }
+                        };
+                        rng_->pool_->enqueue(std::move(task), state_->tasks, state_->channel);
+                        ++state_->n_evaluating;
+                    }
+                    ++state_->it;
+                }
+            }
+        }
+
+        // nothing is evaluated until the first access
+        void start() const
+        {
+            if (!state_->started) {
+                state_->started = true;
+                fill_buffer();
             }
         }
 
     public:
+        using single_pass = std::true_type;
+
         cursor() = default;
-        explicit cursor(buffer_view<Rng>& rng)
+        explicit cursor(buffer_view<Rng, Ordered>& rng)
           : rng_{&rng}
-          , it_{ranges::begin(rng.rng_)}
-          , n_{rng.n_}
+          , state_{std::make_shared<state_t>()}
         {
-            fill_buffer();
+            if constexpr (is_forward) {
+                state_->it = ranges::begin(rng.rng_);
+                if (!Ordered) {
+                    state_->channel = std::make_shared<detail::buffer_channel<element_t>>();
+                }
+            } else {
+                state_->source = std::make_unique<source_t>(
+                  ranges::begin(rng.rng_), ranges::end(rng.rng_));
+            }
         }
 
-        decltype(auto) read() const
+        element_t& read() const
         {
-            return buffer_.front().get();
+            start();
+            materialize();
+            // there is space for another element now and its size may be known
+            fill_buffer();
+            return *state_->current;
         }
 
-        bool equal(ranges::default_sentinel) const
+        element_t&& move() const
         {
-            return buffer_.empty() && it_ == ranges::end(rng_->rng_);
+            return std::move(read());
         }
 
-        bool equal(const cursor& that) const
+        bool equal(ranges::default_sentinel) const
         {
-            assert(rng_ == that.rng_);
-            return n_ == that.n_ && it_ == that.it_;
+            start();
+            if constexpr (!is_forward) {
+                return !state_->current && !state_->error && state_->source->exhausted();
+            } else {
+                return !state_->current && !state_->error && n_evaluating() == 0
+                  && state_->it == ranges::end(rng_->rng_);
+            }
         }
 
         void next()
         {
+            start();
             pop_buffer();
             fill_buffer();
         }
@@ -97,9 +590,18 @@ private:
 public:
     buffer_view() = default;
 
-    buffer_view(Rng rng, std::size_t n)
+    buffer_view(Rng rng, std::size_t n, thread_pool& pool)
+      : rng_{rng}
+      , n_{n > 0 ? n : pool.n_threads()}
+      , pool_{&pool}
+    {
+    }
+
+    buffer_view(Rng rng, byte_budget budget, thread_pool& pool)
       : rng_{rng}
-      , n_{n}
+      , n_{no_limit}
+      , max_bytes_{budget.bytes}
+      , pool_{&pool}
     {
     }
 
@@ -116,31 +618,61 @@ public:
     }
 };
 
+template<bool Ordered = true>
 class buffer_fn {
 private:
     /// \cond
     friend ranges::view::view_access;
     /// \endcond
 
-    static auto bind(buffer_fn buffer, std::size_t n = std::numeric_limits<std::size_t>::max())
+    static auto bind(buffer_fn buffer,
+                     std::size_t n = 0,
+                     thread_pool& pool = global_thread_pool())
     {
-        return ranges::make_pipeable(std::bind(buffer, std::placeholders::_1, n));
+        return ranges::make_pipeable(
+          std::bind(buffer, std::placeholders::_1, n, std::ref(pool)));
+    }
+
+    static auto bind(buffer_fn buffer,
+                     byte_budget budget,
+                     thread_pool& pool = global_thread_pool())
+    {
+        return ranges::make_pipeable(
+          std::bind(buffer, std::placeholders::_1, budget, std::ref(pool)));
     }
 
 public:
-    template<typename Rng, CONCEPT_REQUIRES_(ranges::ForwardRange<Rng>())>
-    buffer_view<ranges::view::all_t<Rng>>
-    operator()(Rng&& rng, std::size_t n = std::numeric_limits<std::size_t>::max()) const
+    template<typename Rng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+    buffer_view<ranges::view::all_t<Rng>, Ordered>
+    operator()(Rng&& rng,
+               std::size_t n = 0,
+               thread_pool& pool = global_thread_pool()) const
+    {
+        return {ranges::view::all(std::forward<Rng>(rng)), n, pool};
+    }
+
+    template<typename Rng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+    buffer_view<ranges::view::all_t<Rng>, Ordered>
+    operator()(Rng&& rng,
+               byte_budget budget,
+               thread_pool& pool = global_thread_pool()) const
     {
-        return {ranges::view::all(std::forward<Rng>(rng)), n};
+        return {ranges::view::all(std::forward<Rng>(rng)), budget, pool};
     }
 
     /// \cond
-    template<typename Rng, CONCEPT_REQUIRES_(!ranges::ForwardRange<Rng>())>
-    void operator()(Rng&&, std::size_t n = 0) const
+    template<typename Rng, CONCEPT_REQUIRES_(!ranges::InputRange<Rng>())>
+    void operator()(Rng&&, std::size_t n = 0, thread_pool& pool = global_thread_pool()) const
+    {
+        CONCEPT_ASSERT_MSG(ranges::InputRange<Rng>(),
+          "stream::buffer only works on ranges satisfying the InputRange concept.");
+    }
+
+    template<typename Rng, CONCEPT_REQUIRES_(!ranges::InputRange<Rng>())>
+    void operator()(Rng&&, byte_budget, thread_pool& pool = global_thread_pool()) const
     {
-        CONCEPT_ASSERT_MSG(ranges::ForwardRange<Rng>(),
-          "stream::buffer only works on ranges satisfying the ForwardRange concept.");
+        CONCEPT_ASSERT_MSG(ranges::InputRange<Rng>(),
+          "stream::buffer only works on ranges satisfying the InputRange concept.");
     }
     /// \endcond
 };
@@ -152,13 +684,61 @@ public:
 /// next element, it is already prepared. This view works for any range, not only
 /// for cxtream streams.
 ///
+/// The number of elements evaluated in advance is either given explicitly,
+/// or it is limited by a \ref byte_budget. If neither is provided, it defaults to
+/// the number of threads of the thread pool. Nothing is evaluated until the
+/// first element is requested.
+///
+/// The buffered range is an input range. The elements are handed out by lvalue
+/// reference and they can be moved out of the buffer without copying using
+/// ranges::iter_move (e.g., by ranges::view::move or stream::batch).
+/// Move-only elements are supported.
+///
+/// The elements of a forward range are evaluated in parallel. The elements of
+/// a single pass range (e.g., another buffer or stream::pipe) are evaluated
+/// sequentially by a dedicated thread instead of the thread pool, similarly to
+/// stream::pipe(). Each of them is moved out of the source range, since it is
+/// visited only once. Hence, a buffer can feed another buffer.
+///
+/// When the last iterator of the buffer is destroyed, the elements which are
+/// not being evaluated yet are cancelled and the elements which are being evaluated
+/// are waited for.
+///
+/// The elements of a forward range are evaluated by the \ref global_thread_pool(),
+/// unless a different thread pool is provided.
+///
 /// \code
 ///     std::vector<int> data = {1, 2, 3, 4, 5};
 ///     auto buffered_rng = data
 ///       | ranges::view::transform([](int v) { return v + 1; })
 ///       | buffer(2);
+///
+///     // evaluate at most 256 MB of elements in advance
+///     auto buffered_rng2 = data | buffer(byte_budget{256 << 20});
+///
+///     // use a dedicated thread pool
+///     thread_pool pool{4};
+///     auto buffered_rng3 = data | buffer(2, pool);
+/// \endcode
+constexpr ranges::view::view<buffer_fn<>> buffer{};
+
+/// \ingroup Stream
+/// \brief Asynchronously buffers the given range and yields the elements in the order
+///        of their completion.
+///
+/// This view is the same as \ref stream::buffer(), but the consumer receives
+/// whichever element is evaluated first, so a single slow element does not stall
+/// the elements evaluated after it. The number of elements evaluated in advance
+/// is limited the same way. Use it when the order of the elements does not matter,
+/// e.g., for the training data in a single epoch. The elements of a single pass
+/// range are evaluated sequentially, so they are yielded in their original order.
+///
+/// \code
+///     auto rng = data
+///       | ranges::view::transform(load_image)
+///       | buffer_unordered(8);
 /// \endcode
-constexpr ranges::view::view<buffer_fn> buffer{};
+constexpr ranges::view::view<buffer_fn<false>> buffer_unordered{};
 
 }  // end namespace cxtream::stream
 #endif
@@ -10,8 +10,12 @@
 #ifndef CXTREAM_CORE_STREAM_COLUMN_HPP
 #define CXTREAM_CORE_STREAM_COLUMN_HPP
 
+#include <cxtream/core/ragged.hpp>
+#include <cxtream/core/tensor.hpp>
+
 #include <initializer_list>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace cxtream::stream {
@@ -81,16 +85,168 @@ struct column_base<T, false> : column_base<T, true> {
     column_base(const std::vector<T>& rhs) = delete;
 };
 
+/// \ingroup Stream
+/// \brief Specialization of column_base for dense tensors.
+///
+/// A batch of tensors of shape (d1, ..., dn) is stored as a single tensor of shape
+/// (batch_size, d1, ..., dn), i.e., in a single contiguous buffer. The column can be
+/// defined either using this type directly or using the CXTREAM_DEFINE_COLUMN macro.
+///
+/// Example:
+/// \code
+///     CXTREAM_DEFINE_COLUMN(image, cxtream::tensor<float, 3>)
+///     // image::batch_type is cxtream::tensor<float, 4>
+/// \endcode
+template <typename T, long NDims, bool IsCopyConstructible>
+class column_base<tensor<T, NDims>, IsCopyConstructible> {
+private:
+    tensor<T, NDims + 1> value_;
+
+public:
+
+    using batch_type = tensor<T, NDims + 1>;
+    using example_type = tensor<T, NDims>;
+
+    // constructors //
+
+    column_base() = default;
+
+    column_base(const tensor<T, NDims>& rhs)
+    {
+        value_.push_back(rhs);
+    }
+
+    column_base(std::initializer_list<tensor<T, NDims>> rhs)
+      : value_{std::move(rhs)}
+    {}
+
+    column_base(tensor<T, NDims + 1>&& rhs)
+      : value_{std::move(rhs)}
+    {}
+
+    column_base(const tensor<T, NDims + 1>& rhs)
+      : value_{rhs}
+    {}
+
+    /// Stack a range of examples (e.g., std::vector<tensor<T, NDims>>) to a batch.
+    template<typename Rng, typename = std::enable_if_t<
+      !is_tensor<std::decay_t<Rng>>{}
+      && cxtream::detail::is_stackable<std::remove_reference_t<Rng>, T, NDims + 1>::value>>
+    column_base(Rng&& rhs)
+      : value_(std::forward<Rng>(rhs))
+    {}
+
+    // conversion operators //
+
+    operator tensor<T, NDims + 1>&() &
+    {
+        return value_;
+    }
+
+    operator tensor<T, NDims + 1>&&() &&
+    {
+        return std::move(value_);
+    }
+
+    // value accessors //
+
+    tensor<T, NDims + 1>& value() { return value_; }
+    const tensor<T, NDims + 1>& value() const { return value_; }
+};
+
+/// \ingroup Stream
+/// \brief Base class for columns of dense tensors.
+///
+/// The examples are tensors of type T with NDims dimensions.
+template <typename T, long NDims>
+using tensor_column = column_base<tensor<T, NDims>>;
+
+/// \ingroup Stream
+/// \brief Specialization of column_base for ragged arrays.
+///
+/// A batch of ragged arrays is stored as a single ragged array with one more dimension,
+/// i.e., all the values of the batch are stored in a single flat buffer.
+///
+/// Example:
+/// \code
+///     CXTREAM_DEFINE_COLUMN(tokens, cxtream::ragged<int, 1>)
+///     // tokens::batch_type is cxtream::ragged<int, 2>
+/// \endcode
+template <typename T, long NDims, bool IsCopyConstructible>
+class column_base<ragged<T, NDims>, IsCopyConstructible> {
+private:
+    ragged<T, NDims + 1> value_;
+
+public:
+
+    using batch_type = ragged<T, NDims + 1>;
+    using example_type = ragged<T, NDims>;
+
+    // constructors //
+
+    column_base() = default;
+
+    column_base(const ragged<T, NDims>& rhs)
+    {
+        value_.push_back(rhs);
+    }
+
+    column_base(std::initializer_list<ragged<T, NDims>> rhs)
+      : value_{std::move(rhs)}
+    {}
+
+    column_base(ragged<T, NDims + 1>&& rhs)
+      : value_{std::move(rhs)}
+    {}
+
+    column_base(const ragged<T, NDims + 1>& rhs)
+      : value_{rhs}
+    {}
+
+    /// Convert a range of examples (e.g., std::vector<std::vector<T>>) to a batch.
+    template<typename Rng, typename = std::enable_if_t<
+      !is_ragged<std::decay_t<Rng>>{} && !is_tensor<std::decay_t<Rng>>{}
+      && cxtream::detail::is_raggable<std::remove_reference_t<Rng>, T, NDims + 1>::value>>
+    column_base(Rng&& rhs)
+      : value_(std::forward<Rng>(rhs))
+    {}
+
+    // conversion operators //
+
+    operator ragged<T, NDims + 1>&() &
+    {
+        return value_;
+    }
+
+    operator ragged<T, NDims + 1>&&() &&
+    {
+        return std::move(value_);
+    }
+
+    // value accessors //
+
+    ragged<T, NDims + 1>& value() { return value_; }
+    const ragged<T, NDims + 1>& value() const { return value_; }
+};
+
+/// \ingroup Stream
+/// \brief Base class for columns of ragged arrays.
+///
+/// The examples are ragged arrays of type T with NDims dimensions.
+template <typename T, long NDims>
+using ragged_column = column_base<ragged<T, NDims>>;
+
 }  // namespace cxtream::stream
 
 /// \ingroup Stream
 /// \brief Macro for fast column definition.
 ///
 /// Under the hood, it creates a new type derived from column_base.
-#define CXTREAM_DEFINE_COLUMN(col_name, col_type)               \
-struct col_name : cxtream::stream::column_base<col_type> {      \
-    using cxtream::stream::column_base<col_type>::column_base;  \
-    static constexpr const char* name() { return #col_name; }   \
+/// The column type may contain commas, e.g., `cxtream::tensor<float, 3>`.
+#define CXTREAM_DEFINE_COLUMN(col_name, ...)                       \
+struct col_name : cxtream::stream::column_base<__VA_ARGS__> {      \
+    using cxtream::stream::column_base<__VA_ARGS__>::column_base;  \
+    static constexpr const char* name() { return #col_name; }      \
 };
 
 #endif
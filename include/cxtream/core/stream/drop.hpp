@@ -42,7 +42,7 @@ namespace detail {
         }
 
     public:
-        template<typename Rng, CONCEPT_REQUIRES_(ranges::ForwardRange<Rng>())>
+        template<typename Rng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
         constexpr auto operator()(Rng&& rng) const
         {
             using StreamType = ranges::range_value_type_t<Rng>;
@@ -52,11 +52,11 @@ namespace detail {
         }
 
         /// \cond
-        template<typename Rng, CONCEPT_REQUIRES_(!ranges::ForwardRange<Rng>())>
+        template<typename Rng, CONCEPT_REQUIRES_(!ranges::InputRange<Rng>())>
         void operator()(Rng&&) const
         {
-            CONCEPT_ASSERT_MSG(ranges::ForwardRange<Rng>(),
-              "stream::drop only works on ranges satisfying the ForwardRange concept.");
+            CONCEPT_ASSERT_MSG(ranges::InputRange<Rng>(),
+              "stream::drop only works on ranges satisfying the InputRange concept.");
         }
         /// \endcond
     };
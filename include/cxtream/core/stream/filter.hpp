@@ -10,6 +10,7 @@
 #ifndef CXTREAM_CORE_STREAM_FILTER_HPP
 #define CXTREAM_CORE_STREAM_FILTER_HPP
 
+#include <cxtream/core/stream/materialize.hpp>
 #include <cxtream/core/stream/template_arguments.hpp>
 #include <cxtream/core/stream/transform.hpp>
 #include <cxtream/core/utility/tuple.hpp>
@@ -98,7 +99,14 @@ namespace detail {
         static constexpr auto impl(From, by_t<ByColumns...>, Fun fun)
         {
             apply_filter_fun_to_columns<Fun, ByColumns...> fun_wrapper{std::move(fun)};
-            return ranges::view::filter(std::move(fun_wrapper));
+            // the filter dereferences each batch once for the predicate and once more
+            // for the consumer, so the upstream transformations would be evaluated twice
+            // the accepted batches are moved out of the cache to the consumer
+            return ranges::make_pipeable([fun_wrapper = std::move(fun_wrapper)](auto&& rng) {
+                return ranges::view::filter(
+                  stream::materialize(std::forward<decltype(rng)>(rng)), fun_wrapper)
+                  | ranges::view::move;
+            });
         }
     };
 
@@ -122,7 +130,9 @@ namespace detail {
 ///          a subset of f.
 /// \param fun The filtering function returning a boolean.
 /// \param d The dimension in which the function is applied. Choose 0 to filter
-///          whole batches (in such a case, the f parameter is ignored).
+///          whole batches (in such a case, the f parameter is ignored). The batches
+///          are \ref stream::materialize() "materialized" before filtering, so that
+///          the upstream transformations are evaluated only once per batch.
 template<typename... FromColumns, typename... ByColumns, typename Fun, int Dim = 1>
 constexpr auto filter(from_t<FromColumns...> f,
                       by_t<ByColumns...> b,
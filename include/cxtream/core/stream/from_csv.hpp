@@ -0,0 +1,268 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_FROM_CSV_HPP
+#define CXTREAM_CORE_STREAM_FROM_CSV_HPP
+
+#include <cxtream/core/csv.hpp>
+#include <cxtream/core/index_mapper.hpp>
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/utility/string.hpp>
+
+#include <range/v3/core.hpp>
+
+#include <experimental/filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxtream::stream {
+namespace detail {
+
+    // Convert a CSV field to the given type, the strings are moved.
+    template<typename T>
+    T csv_field_to(std::string& field)
+    {
+        if constexpr (std::is_same<T, std::string>{}) return std::move(field);
+        else return utility::string_view_to<T>(field);
+    }
+
+    template<typename Batch, std::size_t... Is>
+    void push_csv_row_impl(Batch& batch, std::vector<std::string>& csv_row,
+                           const std::vector<std::size_t>& col_indices,
+                           std::index_sequence<Is...>)
+    {
+        (..., std::get<Is>(batch).value().push_back(
+                csv_field_to<typename std::tuple_element_t<Is, Batch>::example_type>(
+                  csv_row[col_indices[Is]])));
+    }
+
+    // Parse the selected fields of a CSV row and append them to the columns of the batch.
+    template<typename Batch>
+    void push_csv_row(Batch& batch, std::vector<std::string>& csv_row,
+                      const std::vector<std::size_t>& col_indices)
+    {
+        push_csv_row_impl(batch, csv_row, col_indices,
+                          std::make_index_sequence<std::tuple_size<Batch>{}>{});
+    }
+
+}  // namespace detail
+
+template <typename... Columns>
+class from_csv_view : public ranges::view_facade<from_csv_view<Columns...>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+    std::istream* in_ = nullptr;
+    // the owner of the stream (e.g., an opened file), if any
+    std::shared_ptr<std::istream> owner_;
+    std::size_t batch_size_;
+    std::vector<std::string> col_names_;
+    int drop_;
+    char separator_;
+    char quote_;
+    char escape_;
+    csv_istream_range csv_rows_;
+
+    struct cursor {
+    private:
+        from_csv_view<Columns...>* rng_ = nullptr;
+        ranges::iterator_t<csv_istream_range> it_ = {};
+        bool upstream_done_ = false;
+        // the indices of the selected columns in the CSV rows
+        std::vector<std::size_t> col_indices_;
+        // the number of fields in each row
+        std::size_t n_cols_ = 0;
+        // the number of data rows parsed so far
+        std::size_t n_rows_ = 0;
+
+        using batch_t_ = std::tuple<Columns...>;
+        std::shared_ptr<batch_t_> batch_ = std::make_shared<batch_t_>();
+
+        bool done_ = false;
+
+        // find the selected columns in the header
+        void parse_header()
+        {
+            for (int i = 0; i < rng_->drop_ && it_ != ranges::end(rng_->csv_rows_); ++i) ++it_;
+            if (it_ == ranges::end(rng_->csv_rows_)) {
+                throw std::ios_base::failure{"There has to be at least the header row."};
+            }
+            n_cols_ = (*it_).size();
+            col_indices_ = index_mapper<std::string>(*it_).index_for(rng_->col_names_);
+        }
+
+        // parse at most batch_size rows to a new batch
+        bool fill_batch()
+        {
+            // provide an empty batch, preferably recycled from the previous one
+            // (the batch size may be unbounded, so the storage is not reserved in advance)
+            if (!detail::is_released(batch_)) batch_ = std::make_shared<batch_t_>();
+            detail::clear_batch(*batch_);
+            for (std::size_t i = 0; i < rng_->batch_size_ && !upstream_done_; ++i, ++n_rows_) {
+                // the iterator points to the last consumed row, so that no row
+                // is read before it is needed
+                if (++it_ == ranges::end(rng_->csv_rows_)) {
+                    upstream_done_ = true;
+                    break;
+                }
+                std::vector<std::string>& csv_row = *it_;
+                // sanity check row size
+                if (csv_row.size() != n_cols_) {
+                    if (n_rows_ == 0) {
+                        throw std::ios_base::failure{"The first row must have the same "
+                                                     "length as the header."};
+                    }
+                    throw std::ios_base::failure{"Row " + std::to_string(n_rows_)
+                                                 + " has a different length "
+                                                 + "(has: " + std::to_string(csv_row.size())
+                                                 + " , expected: " + std::to_string(n_cols_)
+                                                 + ")."};
+                }
+                detail::push_csv_row(*batch_, csv_row, col_indices_);
+            }
+            return batch_size(*batch_) > 0;
+        }
+
+    public:
+        using single_pass = std::true_type;
+
+        cursor() = default;
+        explicit cursor(from_csv_view<Columns...>& rng)
+          : rng_{&rng}
+        {
+            rng_->csv_rows_ =
+              csv_istream_range{*rng_->in_, rng_->separator_, rng_->quote_, rng_->escape_};
+            it_ = ranges::begin(rng_->csv_rows_);
+            parse_header();
+            done_ = !fill_batch();
+        }
+
+        decltype(auto) read() const
+        {
+            return *batch_;
+        }
+
+        bool equal(ranges::default_sentinel) const
+        {
+            return done_;
+        }
+
+        void next()
+        {
+            done_ = !fill_batch();
+        }
+    };  // struct cursor
+
+    cursor begin_cursor() { return cursor{*this}; }
+
+public:
+    from_csv_view() = default;
+    from_csv_view(std::istream& in,
+                  std::shared_ptr<std::istream> owner,
+                  std::size_t batch_size,
+                  std::vector<std::string> col_names,
+                  int drop,
+                  char separator,
+                  char quote,
+                  char escape)
+      : in_{&in}
+      , owner_{std::move(owner)}
+      , batch_size_{batch_size}
+      , col_names_{std::move(col_names)}
+      , drop_{drop}
+      , separator_{separator}
+      , quote_{quote}
+      , escape_{escape}
+    {
+        static_assert(sizeof...(Columns) &&
+                      "At least one column has to be read from the CSV file");
+        if (batch_size_ == 0) throw std::invalid_argument{"Batch size has to be positive."};
+        if (col_names_.size() != sizeof...(Columns)) {
+            throw std::invalid_argument{"The number of column names has to be equal "
+                                        "to the number of columns."};
+        }
+    }
+};  // class from_csv_view
+
+/// \ingroup Stream
+/// \brief Create a stream from the selected columns of a CSV formatted std::istream.
+///
+/// The rows are parsed incrementally by csv_istream_range and the selected fields are
+/// converted directly to the example types of the given columns (using
+/// utility::string_view_to()) and appended to the current batch. Hence, only a single
+/// batch is held in memory and the first batch is available right after its rows are
+/// parsed. The stream has to contain a header row, which is used to find the columns.
+/// The other columns are skipped. A gzip or zstd compressed stream is decompressed
+/// on the fly, see csv_istream_range.
+///
+/// The returned range is single pass and the stream has to outlive it.
+///
+/// \code
+///     CXTREAM_DEFINE_COLUMN(id, std::int64_t)
+///     CXTREAM_DEFINE_COLUMN(value, double)
+///     std::ifstream in{"data.csv"};
+///     auto rng = from_csv<id, value>(in, 64, {"Id", "Value"})
+///       | transform(from<value>, to<value>, [](double v) { return v / 100.; });
+/// \endcode
+///
+/// \param in The input stream.
+/// \param batch_size The maximum number of examples in a batch.
+/// \param col_names The names of the CSV columns corresponding to the stream columns.
+/// \param drop How many lines should be ignored at the very beginning of the stream.
+/// \param separator Field separator.
+/// \param quote Quote character.
+/// \param escape Character used to escape a quote inside quotes.
+/// \throws std::out_of_range If a column is not present in the header (when iterated).
+/// \throws std::ios_base::failure If the stream cannot be parsed (when iterated).
+template <typename... Columns>
+from_csv_view<Columns...> from_csv(std::istream& in,
+                                   std::size_t batch_size,
+                                   std::vector<std::string> col_names,
+                                   int drop = 0,
+                                   char separator = ',',
+                                   char quote = '"',
+                                   char escape = '\\')
+{
+    return {in, nullptr, batch_size, std::move(col_names), drop, separator, quote, escape};
+}
+
+/// \ingroup Stream
+/// \brief Same as from_csv() but read directly from a file.
+///
+/// The file is opened immediately and closed when the last copy of the range is destroyed.
+/// A gzip or zstd compressed file is decompressed on the fly, so it is never fully
+/// loaded to memory.
+///
+/// \throws std::ios_base::failure If the specified file cannot be opened.
+template <typename... Columns>
+from_csv_view<Columns...> from_csv(const std::experimental::filesystem::path& file,
+                                   std::size_t batch_size,
+                                   std::vector<std::string> col_names,
+                                   int drop = 0,
+                                   char separator = ',',
+                                   char quote = '"',
+                                   char escape = '\\')
+{
+    auto fin = std::make_shared<std::ifstream>(file, std::ios::binary);
+    if (!fin->is_open()) {
+        throw std::ios_base::failure{"Cannot open " + file.string() + " CSV file for reading."};
+    }
+    return {*fin, fin, batch_size, std::move(col_names), drop, separator, quote, escape};
+}
+
+}  // namespace cxtream::stream
+#endif
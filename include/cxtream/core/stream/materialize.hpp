@@ -0,0 +1,169 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_MATERIALIZE_HPP
+#define CXTREAM_CORE_STREAM_MATERIALIZE_HPP
+
+#include <range/v3/core.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <atomic>
+#include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace cxtream::stream {
+
+template<typename Rng>
+struct materialize_view : ranges::view_facade<materialize_view<Rng>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+
+    using element_t = ranges::range_value_type_t<Rng>;
+
+    Rng rng_;
+
+    struct cursor {
+    private:
+        materialize_view<Rng>* rng_ = nullptr;
+        ranges::iterator_t<Rng> it_;
+        // the cached value of the current element, it is shared by the copies
+        // of the cursor at the same position
+        std::shared_ptr<std::experimental::optional<element_t>> current_;
+
+    public:
+        // the copies of a cursor over a single pass range cannot be compared
+        using single_pass = std::integral_constant<bool, !ranges::ForwardRange<Rng>()>;
+
+        cursor() = default;
+        explicit cursor(materialize_view<Rng>& rng)
+          : rng_{&rng}
+          , it_{ranges::begin(rng.rng_)}
+          , current_{std::make_shared<std::experimental::optional<element_t>>()}
+        {
+        }
+
+        element_t& read() const
+        {
+            if (!*current_) current_->emplace(*it_);
+            return **current_;
+        }
+
+        element_t&& move() const
+        {
+            return std::move(read());
+        }
+
+        CONCEPT_REQUIRES(ranges::ForwardRange<Rng>())
+        bool equal(const cursor& that) const
+        {
+            return it_ == that.it_;
+        }
+
+        bool equal(ranges::default_sentinel) const
+        {
+            return it_ == ranges::end(rng_->rng_);
+        }
+
+        void next()
+        {
+            ++it_;
+            // reuse the cache unless another copy of the cursor still refers to it
+            if (current_.use_count() == 1) {
+                // synchronize with the release of the copy in another thread
+                std::atomic_thread_fence(std::memory_order_acquire);
+                *current_ = std::experimental::nullopt;
+            } else {
+                current_ = std::make_shared<std::experimental::optional<element_t>>();
+            }
+        }
+    };  // struct cursor
+
+    cursor begin_cursor()
+    {
+        return cursor{*this};
+    }
+
+public:
+    materialize_view() = default;
+
+    explicit materialize_view(Rng rng)
+      : rng_{std::move(rng)}
+    {
+    }
+};
+
+class materialize_fn {
+private:
+    /// \cond
+    friend ranges::view::view_access;
+    /// \endcond
+
+    static auto bind(materialize_fn materialize)
+    {
+        return ranges::make_pipeable(std::bind(materialize, std::placeholders::_1));
+    }
+
+public:
+    template<typename Rng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+    auto operator()(Rng&& rng) const
+    {
+        // references are cheap to dereference repeatedly, there is nothing to cache
+        if constexpr (std::is_reference<ranges::range_reference_t<Rng>>{}) {
+            return ranges::view::all(std::forward<Rng>(rng));
+        } else {
+            return materialize_view<ranges::view::all_t<Rng>>{
+              ranges::view::all(std::forward<Rng>(rng))};
+        }
+    }
+
+    /// \cond
+    template<typename Rng, CONCEPT_REQUIRES_(!ranges::InputRange<Rng>())>
+    void operator()(Rng&&) const
+    {
+        CONCEPT_ASSERT_MSG(ranges::InputRange<Rng>(),
+          "stream::materialize only works on ranges satisfying the InputRange concept.");
+    }
+    /// \endcond
+};
+
+/// \ingroup Stream
+/// \brief Evaluates each element of the upstream range exactly once.
+///
+/// The stream transformations are lazy, i.e., every dereference of an iterator
+/// evaluates the whole upstream chain of transformations once again. This stage
+/// evaluates the current element on the first access and caches it until the
+/// iterator is advanced (this is sometimes called `cache1`). It is useful before
+/// stages that dereference a single element multiple times, such as
+/// \ref stream::filter() in dimension 0, which already uses it internally.
+///
+/// The cache is owned by the iterator and it is shared only by the copies of the
+/// iterator pointing to the same element, so the result of a forward range is a forward
+/// range (e.g., its elements can be evaluated in parallel by \ref stream::buffer()).
+/// The result of a single pass range is a single pass range. The cached element is handed
+/// out by lvalue reference and it can be moved out of the cache using ranges::iter_move
+/// (e.g., by ranges::view::move). If the upstream range already returns references,
+/// there is nothing to evaluate and the range is returned unchanged.
+///
+/// \code
+///     auto rng = data
+///       | create<image_path>()
+///       | transform(from<image_path>, to<image>, load_image)
+///       | materialize  // load each batch only once
+///       | ranges::view::filter(is_valid_batch);
+/// \endcode
+constexpr ranges::view::view<materialize_fn> materialize{};
+
+}  // end namespace cxtream::stream
+#endif
@@ -0,0 +1,255 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_PACK_HPP
+#define CXTREAM_CORE_STREAM_PACK_HPP
+
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/stream/template_arguments.hpp>
+#include <cxtream/core/utility/tuple.hpp>
+
+#include <range/v3/core.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace cxtream::stream {
+
+template <typename Rng, typename SegmentColumn, typename PositionColumn, typename... FromColumns>
+struct pack_view
+  : ranges::view_facade<pack_view<Rng, SegmentColumn, PositionColumn, FromColumns...>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+    Rng rng_;
+    std::size_t max_len_;
+    std::size_t n_;
+
+    struct cursor : detail::rebatch_cursor<cursor,
+                                           std::tuple<FromColumns..., SegmentColumn, PositionColumn>> {
+    private:
+        using batch_t_ = std::tuple<FromColumns..., SegmentColumn, PositionColumn>;
+        friend detail::rebatch_cursor<cursor, batch_t_>;
+        using detail::rebatch_cursor<cursor, batch_t_>::batch_;
+
+        pack_view<Rng, SegmentColumn, PositionColumn, FromColumns...>* rng_ = nullptr;
+        detail::subbatch_reader<Rng> reader_;
+
+        // the rows being packed
+        std::shared_ptr<batch_t_> rows_ = std::make_shared<batch_t_>();
+        // the number of rows being packed
+        std::size_t n_open_ = 0;
+
+        // the length of the example at the current index of the subbatch
+        std::size_t current_length() const
+        {
+            using first_column = std::tuple_element_t<0, std::tuple<FromColumns...>>;
+            const auto& subbatch = reader_.subbatch();
+            std::size_t idx = reader_.index();
+            std::size_t length = std::get<first_column>(subbatch).value()[idx].size();
+            assert(((std::get<FromColumns>(subbatch).value()[idx].size() == length)
+                    && ...) && "All the packed columns have to have equal length");
+            return length;
+        }
+
+        // the number of elements in the given row
+        std::size_t row_length(std::size_t row) const
+        {
+            return std::get<PositionColumn>(*rows_).value()[row].size();
+        }
+
+        // start packing a new row
+        //
+        // The rows recycled from the previous batches are reused with their capacity.
+        void open_row()
+        {
+            utility::tuple_for_each(*rows_, [this](auto& column) {
+                if (column.value().size() == n_open_) column.value().emplace_back();
+                column.value()[n_open_].reserve(rng_->max_len_);
+            });
+            ++n_open_;
+        }
+
+        // find the first row with enough space for the given number of elements
+        //
+        // If there is no such row, a new one is opened. If all the rows are
+        // already open, n_ is returned.
+        std::size_t find_row(std::size_t length)
+        {
+            for (std::size_t row = 0; row < n_open_; ++row) {
+                if (row_length(row) + length <= rng_->max_len_) return row;
+            }
+            if (n_open_ == rng_->n_) return rng_->n_;
+            open_row();
+            return n_open_ - 1;
+        }
+
+        // move the example at the current index of the subbatch to the end of the given row
+        void append_example(std::size_t row, std::size_t length)
+        {
+            auto& segments = std::get<SegmentColumn>(*rows_).value()[row];
+            auto& positions = std::get<PositionColumn>(*rows_).value()[row];
+            using segment_t = typename std::decay_t<decltype(segments)>::value_type;
+            using position_t = typename std::decay_t<decltype(positions)>::value_type;
+            // the segments are numbered from one, so that zero can be used for padding
+            segment_t segment = segments.empty() ? segment_t{1} : segments.back() + 1;
+            segments.insert(segments.end(), length, segment);
+            for (std::size_t i = 0; i < length; ++i) positions.push_back(static_cast<position_t>(i));
+            auto splice = [this, row](auto& to, auto& from) {
+                auto& source = from.value()[reader_.index()];
+                to.value()[row].insert(to.value()[row].end(),
+                                       std::make_move_iterator(source.begin()),
+                                       std::make_move_iterator(source.end()));
+            };
+            (..., splice(std::get<FromColumns>(*rows_), std::get<FromColumns>(reader_.subbatch())));
+        }
+
+        // provide the packed rows to the user
+        //
+        // The rows are swapped with the batch, so the storage of the previous
+        // batch is recycled for the next rows if nobody else refers to it.
+        void emit()
+        {
+            if (!detail::is_released(batch_)) batch_ = std::make_shared<batch_t_>();
+            utility::tuple_for_each(*rows_, [this](auto& column) {
+                column.value().resize(n_open_);
+            });
+            std::swap(*batch_, *rows_);
+            utility::tuple_for_each(*rows_, [](auto& column) {
+                for (auto& row : column.value()) row.clear();
+            });
+            n_open_ = 0;
+        }
+
+        // pack the examples until a batch can be emitted
+        bool fill_batch()
+        {
+            while (reader_.find_next()) {
+                std::size_t length = current_length();
+                if (length > rng_->max_len_) {
+                    throw std::length_error{"The example is too long to be packed."};
+                }
+                // empty examples do not occupy any space in the rows
+                if (length == 0) {
+                    reader_.advance();
+                    continue;
+                }
+                std::size_t row = find_row(length);
+                bool full = row == rng_->n_;
+                if (full) {
+                    emit();
+                    open_row();
+                    row = 0;
+                }
+                append_example(row, length);
+                reader_.advance();
+                if (full) return true;
+            }
+            // flush the partially packed rows at the end of the stream
+            if (n_open_ > 0) {
+                emit();
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        cursor() = default;
+        explicit cursor(pack_view<Rng, SegmentColumn, PositionColumn, FromColumns...>& rng)
+          : rng_{&rng}
+          , reader_{rng_->rng_}
+        {
+            static_assert(sizeof...(FromColumns) &&
+                          "At least one column has to be packed");
+            this->start();
+        }
+    };  // struct cursor
+
+    cursor begin_cursor() { return cursor{*this}; }
+
+public:
+    pack_view() = default;
+    pack_view(Rng rng, std::size_t max_len, std::size_t n)
+      : rng_{rng}
+      , max_len_{max_len}
+      , n_{n}
+    {
+        if (max_len_ == 0) throw std::invalid_argument{"Packed length has to be positive."};
+        if (n_ == 0) throw std::invalid_argument{"Batch size has to be positive."};
+    }
+};  // class pack_view
+
+namespace detail {
+
+    struct pack_fn {
+        template <typename Rng, typename... FromColumns, typename SegmentColumn,
+                  typename PositionColumn, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+        pack_view<ranges::view::all_t<Rng>, SegmentColumn, PositionColumn, FromColumns...>
+        operator()(Rng&& rng, from_t<FromColumns...>, to_t<SegmentColumn, PositionColumn>,
+                   std::size_t max_len, std::size_t n) const
+        {
+            return {ranges::view::all(std::forward<Rng>(rng)), max_len, n};
+        }
+    };
+
+}  // namespace detail
+
+/// \ingroup Stream
+/// \brief Pack short sequences into rows of a fixed maximum length.
+///
+/// The sequences of the selected columns of each example are concatenated to rows of at most
+/// `max_len` elements. For each row, two more columns are created. The segment column
+/// contains the index of the example the element originates from (numbered from one within
+/// the row, so that zero can be used as a padding value) and the position column contains
+/// the index of the element within its original example.
+///
+/// The rows are packed first-fit. Each example is appended to the first of the `n` rows
+/// of the current batch that has enough space left. If there is no such row, the batch
+/// is yielded and the example starts a new one. With `n = 1`, the packing is greedy.
+///
+/// The yielded batch contains only the packed columns and the segment and position columns,
+/// the other columns are dropped. The packed columns have to hold sequences supporting
+/// `insert()` and `reserve()` (e.g., `std::vector`) and all of them have to have the same
+/// length for each example. Empty examples are skipped and examples longer than `max_len`
+/// result in std::length_error. The rows are reserved to `max_len` elements and their
+/// storage is recycled between the batches.
+///
+/// \code
+///     CXTREAM_DEFINE_COLUMN(tokens, std::vector<int>)
+///     CXTREAM_DEFINE_COLUMN(segments, std::vector<int>)
+///     CXTREAM_DEFINE_COLUMN(positions, std::vector<int>)
+///     auto rng = data
+///       | create<tokens>()
+///       | pack(from<tokens>, to<segments, positions>, 512, 32)  // 32 rows of <= 512 tokens
+///       | pad(from<tokens>, mask<token_masks>)
+///       | pad(from<segments>, mask<segment_masks>, 0);
+/// \endcode
+///
+/// \param f The columns to be packed.
+/// \param t The segment column and the position column.
+/// \param max_len The maximum number of elements in a row.
+/// \param n The number of rows in a batch.
+template <typename... FromColumns, typename SegmentColumn, typename PositionColumn>
+auto pack(from_t<FromColumns...> f, to_t<SegmentColumn, PositionColumn> t,
+          std::size_t max_len, std::size_t n = 1)
+{
+    return ranges::make_pipeable(std::bind(detail::pack_fn{}, std::placeholders::_1,
+                                           f, t, max_len, n));
+}
+
+}  // namespace cxtream::stream
+#endif
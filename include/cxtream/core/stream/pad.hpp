@@ -10,9 +10,18 @@
 #ifndef CXTREAM_CORE_STREAM_PAD_HPP
 #define CXTREAM_CORE_STREAM_PAD_HPP
 
+#include <cxtream/core/ragged.hpp>
 #include <cxtream/core/stream/transform.hpp>
+#include <cxtream/core/tensor.hpp>
 #include <cxtream/core/utility/vector.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace cxtream::stream {
 namespace detail {
 
@@ -31,16 +40,83 @@ namespace detail {
             static_assert(MaskDims <= SourceDims, "stream::pad requires"
               " the number of padded dimensions (i.e., the number of dimensions"
               " of the mask) to be at most the number of dimensions of the source column.");
-            // create the positive mask
-            std::vector<std::vector<long>> source_size = utility::ndim_size<MaskDims>(source);
-            MaskVector mask;
-            utility::ndim_resize<MaskDims>(mask, source_size, true);
-            // pad the source
-            utility::ndim_pad<MaskDims>(source, value);
-            // create the negative mask
-            source_size = utility::ndim_size<MaskDims>(source);
-            utility::ndim_resize<MaskDims>(mask, source_size, false);
-            return {std::move(source), std::move(mask)};
+            // tensors are rectangular by definition, only the mask has to be created
+            if constexpr (is_tensor<SourceVector>{}) {
+                return {std::move(source), tensor_mask<MaskVector, MaskDims>(source.shape())};
+            } else if constexpr (is_ragged<SourceVector>{}) {
+                static_assert(MaskDims == SourceDims, "stream::pad requires the mask"
+                  " of a ragged column to have the same number of dimensions as the column.");
+                return ragged_pad<SourceVector, MaskVector>(source);
+            } else {
+                // pad the source and create the mask in a single pass
+                MaskVector mask;
+                utility::ndim_pad_mask<MaskDims>(source, mask, value);
+                return {std::move(source), std::move(mask)};
+            }
+        }
+
+    private:
+        // create a positive mask for the given number of dimensions of a tensor
+        template<typename MaskVector, long MaskDims, std::size_t N>
+        static MaskVector tensor_mask(const std::array<std::size_t, N>& shape)
+        {
+            if constexpr (is_tensor<MaskVector>{}) {
+                std::array<std::size_t, MaskDims> mask_shape;
+                std::copy(shape.begin(), shape.begin() + MaskDims, mask_shape.begin());
+                return MaskVector(mask_shape, true);
+            } else {
+                MaskVector mask;
+                utility::ndim_resize<MaskDims>(mask, shape_size<MaskDims>(shape), true);
+                return mask;
+            }
+        }
+
+        // pad a ragged array and create its mask in a single pass, see ragged::pad()
+        template<typename SourceVector, typename MaskVector>
+        std::tuple<SourceVector, MaskVector> ragged_pad(const SourceVector& source) const
+        {
+            SourceVector padded;
+            if constexpr (is_tensor<MaskVector>{} || is_ragged<MaskVector>{}) {
+                MaskVector mask;
+                source.pad(value, padded, mask);
+                return {std::move(padded), std::move(mask)};
+            } else {
+                // std::vector<bool> cannot be written in contiguous runs, so the mask
+                // is created as a tensor and then converted to the nested vector
+                using MaskT = utility::ndim_type_t<MaskVector, SourceVector::ndims()>;
+                using DenseMaskT = std::conditional_t<std::is_same<MaskT, bool>{},
+                                                      std::uint8_t, MaskT>;
+                tensor<DenseMaskT, SourceVector::ndims()> mask;
+                source.pad(value, padded, mask);
+                return {std::move(padded), to_nested<MaskVector>(std::as_const(mask))};
+            }
+        }
+
+        // convert a tensor (or a tensor view) to a nested vector
+        template<typename Vector, typename View>
+        static Vector to_nested(const View& dense)
+        {
+            Vector nested;
+            nested.reserve(dense.size());
+            for (auto&& elem : dense) {
+                if constexpr (View::ndims() == 1) nested.push_back(elem);
+                else nested.push_back(to_nested<typename Vector::value_type>(elem));
+            }
+            return nested;
+        }
+
+        // the size of each range in each dimension of a rectangular multidimensional
+        // range of the given shape, see utility::ndim_size
+        template<long Dims, std::size_t N>
+        static std::vector<std::vector<long>> shape_size(const std::array<std::size_t, N>& shape)
+        {
+            std::vector<std::vector<long>> size(Dims);
+            std::size_t n_ranges = 1;
+            for (long d = 0; d < Dims; ++d) {
+                size[d].assign(n_ranges, shape[d]);
+                n_ranges *= shape[d];
+            }
+            return size;
         }
     };
 
@@ -58,7 +134,10 @@ namespace detail {
 /// bool/char/int/... The dimensionality of the mask column is used to deduce
 /// how many dimensions should be padded in the source column.
 ///
-/// This transformer internally uses \ref utility::ndim_pad().
+/// This transformer internally uses \ref utility::ndim_pad_mask(). Tensor columns are
+/// rectangular by definition, so only the mask is created for them. Ragged columns
+/// are padded in all their dimensions using ragged::pad(), which creates the padded
+/// values and the mask in a single pass.
 ///
 /// Example:
 /// \code
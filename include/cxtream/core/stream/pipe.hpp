@@ -0,0 +1,263 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_PIPE_HPP
+#define CXTREAM_CORE_STREAM_PIPE_HPP
+
+#include <cxtream/core/thread/spsc_queue.hpp>
+
+#include <range/v3/core.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace cxtream::stream {
+
+namespace detail {
+
+    // Blocks a single thread until a condition is satisfied.
+    //
+    // The waiting thread spins for a while and then goes to sleep. The mutex
+    // is only locked if the thread actually sleeps, so the notification
+    // is just an atomic load in the common case.
+    class thread_parker {
+    private:
+        std::atomic<bool> sleeping_{false};
+        std::mutex mutex_;
+        std::condition_variable cv_;
+
+    public:
+        template<typename Pred>
+        void wait(Pred pred)
+        {
+            // spinning only steals time from the other thread on a single core
+            int n_spins = std::thread::hardware_concurrency() > 1 ? 64 : 1;
+            for (int i = 0; i < n_spins; ++i) {
+                if (pred()) return;
+                std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> lock{mutex_};
+            sleeping_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv_.wait(lock, pred);
+            sleeping_.store(false);
+        }
+
+        void notify()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping_.load()) {
+                { std::lock_guard<std::mutex> lock{mutex_}; }
+                cv_.notify_one();
+            }
+        }
+    };
+
+}  // namespace detail
+
+template<typename Rng>
+struct pipe_view : ranges::view_facade<pipe_view<Rng>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+
+    Rng rng_;
+    std::size_t n_;
+
+    using element_t = ranges::range_value_type_t<Rng>;
+
+    // The state of the iteration shared by the copies of a cursor.
+    struct state_t {
+        cxtream::detail::spsc_queue<std::experimental::optional<element_t>> queue;
+        // set by the producer when the upstream range is exhausted or has thrown
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+        // set by the consumer when it is destroyed
+        std::atomic<bool> stop{false};
+        detail::thread_parker producer_parker;
+        detail::thread_parker consumer_parker;
+        std::thread producer;
+        // the front element already popped from the queue
+        std::experimental::optional<element_t> current;
+
+        explicit state_t(std::size_t n)
+          : queue{n}
+        {}
+
+        ~state_t()
+        {
+            stop = true;
+            producer_parker.notify();
+            if (producer.joinable()) producer.join();
+        }
+    };
+
+    struct cursor {
+    private:
+        pipe_view<Rng>* rng_ = nullptr;
+        std::shared_ptr<state_t> state_;
+
+        static void produce(Rng& rng, state_t& state)
+        {
+            try {
+                for (auto it = ranges::begin(rng); it != ranges::end(rng); ++it) {
+                    if (state.stop) break;
+                    // the elements of a single pass range are visited only once
+                    std::experimental::optional<element_t> value;
+                    if constexpr (ranges::ForwardRange<Rng>()) value.emplace(*it);
+                    else value.emplace(ranges::iter_move(it));
+                    state.producer_parker.wait([&state, &value]() {
+                        return state.stop || state.queue.try_push(std::move(value));
+                    });
+                    state.consumer_parker.notify();
+                }
+            } catch (...) {
+                state.error = std::current_exception();
+            }
+            state.done.store(true, std::memory_order_release);
+            state.consumer_parker.notify();
+        }
+
+        // the producer thread is started on the first access
+        void start() const
+        {
+            if (!state_->producer.joinable() && !state_->done) {
+                state_->producer = std::thread{&cursor::produce,
+                                               std::ref(rng_->rng_), std::ref(*state_)};
+            }
+        }
+
+        // wait for the next element, returns false if there is none
+        bool fetch() const
+        {
+            start();
+            state_t& state = *state_;
+            if (state.current) return true;
+            state.consumer_parker.wait([&state]() {
+                return state.queue.try_pop(state.current)
+                  || state.done.load(std::memory_order_acquire);
+            });
+            // the producer may have pushed the last element just before it finished
+            if (!state.current) state.queue.try_pop(state.current);
+            if (state.current) {
+                state.producer_parker.notify();
+                return true;
+            }
+            if (state.error) std::rethrow_exception(std::exchange(state.error, nullptr));
+            return false;
+        }
+
+    public:
+        using single_pass = std::true_type;
+
+        cursor() = default;
+        explicit cursor(pipe_view<Rng>& rng)
+          : rng_{&rng}
+          , state_{std::make_shared<state_t>(rng.n_)}
+        {
+        }
+
+        element_t& read() const
+        {
+            fetch();
+            return *state_->current;
+        }
+
+        element_t&& move() const
+        {
+            return std::move(read());
+        }
+
+        bool equal(ranges::default_sentinel) const
+        {
+            return !fetch();
+        }
+
+        void next()
+        {
+            fetch();
+            state_->current = std::experimental::nullopt;
+        }
+    };  // struct cursor
+
+    cursor begin_cursor()
+    {
+        return cursor{*this};
+    }
+
+public:
+    pipe_view() = default;
+
+    pipe_view(Rng rng, std::size_t n)
+      : rng_{rng}
+      , n_{n}
+    {
+    }
+};
+
+class pipe_fn {
+private:
+    /// \cond
+    friend ranges::view::view_access;
+    /// \endcond
+
+    static auto bind(pipe_fn pipe, std::size_t n = 2)
+    {
+        return ranges::make_pipeable(std::bind(pipe, std::placeholders::_1, n));
+    }
+
+public:
+    template<typename Rng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+    pipe_view<ranges::view::all_t<Rng>> operator()(Rng&& rng, std::size_t n = 2) const
+    {
+        return {ranges::view::all(std::forward<Rng>(rng)), n};
+    }
+};
+
+/// \ingroup Stream
+/// \brief Evaluates the upstream range on a dedicated thread.
+///
+/// Everything upstream of this stage is iterated by a dedicated thread, which pushes
+/// the elements to a bounded lock-free single-producer single-consumer queue of the
+/// given capacity. The downstream cursor pops the elements from the queue. The hand-off
+/// needs neither a future nor a mutex unless one of the threads has to sleep.
+///
+/// Multiple pipes split the stream to a pipeline, each part running on its own core.
+/// Unlike \ref stream::buffer() of a forward range, a single upstream range is iterated
+/// sequentially, so the pipe works for stages with internal state.
+///
+/// The pipe is an input range. The elements are handed out by lvalue reference and
+/// they can be moved out of the pipe using ranges::iter_move (e.g., by stream::batch).
+/// The producer thread is started on the first access and it is stopped and joined
+/// when the last iterator is destroyed.
+///
+/// \code
+///     auto rng = data
+///       | create<image_path>()
+///       | transform(from<image_path>, to<image>, load_image)
+///       | pipe(8)  // load the images on a dedicated thread
+///       | transform(from<image>, to<image>, augment)
+///       | pipe(8)  // augment the images on another dedicated thread
+///       | batch(32);
+/// \endcode
+constexpr ranges::view::view<pipe_fn> pipe{};
+
+}  // end namespace cxtream::stream
+#endif
@@ -0,0 +1,214 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_STREAM_SHUFFLE_HPP
+#define CXTREAM_CORE_STREAM_SHUFFLE_HPP
+
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/utility/random.hpp>
+
+#include <range/v3/core.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace cxtream::stream {
+namespace detail {
+
+    template<typename Batch, std::size_t... Is>
+    void replace_example_impl(Batch& to, std::size_t to_idx, Batch& from, std::size_t from_idx,
+                              std::index_sequence<Is...>)
+    {
+        (..., (std::get<Is>(to).value()[to_idx] = std::move(std::get<Is>(from).value()[from_idx])));
+    }
+
+    // Move the example at the given index of one batch over an example of another batch.
+    template<typename Batch>
+    void replace_example(Batch& to, std::size_t to_idx, Batch& from, std::size_t from_idx)
+    {
+        replace_example_impl(to, to_idx, from, from_idx,
+                             std::make_index_sequence<std::tuple_size<Batch>{}>{});
+    }
+
+}  // namespace detail
+
+template <typename Rng, typename Prng>
+struct shuffle_view : ranges::view_facade<shuffle_view<Rng, Prng>> {
+private:
+    /// \cond
+    friend ranges::range_access;
+    /// \endcond
+    Rng rng_;
+    std::size_t buffer_size_;
+    Prng* prng_;
+
+    struct cursor : detail::rebatch_cursor<cursor, ranges::range_value_type_t<Rng>> {
+    private:
+        using batch_t_ = ranges::range_value_type_t<Rng>;
+        friend detail::rebatch_cursor<cursor, batch_t_>;
+        using detail::rebatch_cursor<cursor, batch_t_>::batch_;
+
+        shuffle_view<Rng, Prng>* rng_ = nullptr;
+        detail::subbatch_reader<Rng> reader_;
+
+        // the examples waiting to be picked
+        std::shared_ptr<batch_t_> buffer_ = std::make_shared<batch_t_>();
+        // the size of the largest batch of the original range
+        std::size_t max_batch_size_ = 0;
+
+        // provide an empty batch, preferably recycled from the previous one
+        void recycle_batch()
+        {
+            if (!detail::is_released(batch_)) batch_ = std::make_shared<batch_t_>();
+            detail::clear_batch(*batch_);
+        }
+
+        // the index of a random example in the buffer
+        std::size_t random_index()
+        {
+            std::uniform_int_distribution<std::size_t> dist{0, batch_size(*buffer_) - 1};
+            return dist(*rng_->prng_);
+        }
+
+        // insert the remaining examples of the subbatch to the buffer
+        //
+        // Once the buffer is full, each incoming example replaces a randomly
+        // chosen example of the buffer, which is moved to the batch.
+        void shuffle_subbatch()
+        {
+            batch_t_& subbatch = reader_.subbatch();
+            for (; reader_.remaining() > 0; reader_.advance()) {
+                if (batch_size(*buffer_) < rng_->buffer_size_) {
+                    detail::move_examples(*buffer_, subbatch, reader_.index(), 1);
+                    continue;
+                }
+                std::size_t idx = random_index();
+                detail::move_examples(*batch_, *buffer_, idx, 1);
+                detail::replace_example(*buffer_, idx, subbatch, reader_.index());
+            }
+        }
+
+        // move randomly chosen examples from the buffer to the batch
+        //
+        // The hole after each example is filled by the last example of the buffer.
+        void drain_buffer(std::size_t n)
+        {
+            for (; n > 0 && batch_size(*buffer_) > 0; --n) {
+                std::size_t idx = random_index();
+                std::size_t last = batch_size(*buffer_) - 1;
+                detail::move_examples(*batch_, *buffer_, idx, 1);
+                if (idx != last) detail::replace_example(*buffer_, idx, *buffer_, last);
+                utility::tuple_for_each(*buffer_, [](auto& column) { column.value().pop_back(); });
+            }
+        }
+
+        // fill the batch with the examples pushed out of the buffer
+        bool fill_batch()
+        {
+            recycle_batch();
+            // each subbatch is shuffled as a whole, so it is found only once
+            while (reader_.find_next()) {
+                max_batch_size_ = std::max(max_batch_size_, batch_size(reader_.subbatch()));
+                shuffle_subbatch();
+                if (batch_size(*batch_) > 0) return true;
+            }
+            // at the end of the stream, the buffer is drained in batches
+            // of the size of the largest original batch
+            drain_buffer(max_batch_size_);
+            return batch_size(*batch_) > 0;
+        }
+
+    public:
+        cursor() = default;
+        explicit cursor(shuffle_view<Rng, Prng>& rng)
+          : rng_{&rng}
+          , reader_{rng_->rng_}
+        {
+            static_assert(std::tuple_size<batch_t_>{} &&
+                          "The range to be shuffled has to contain at least one column");
+            if (reader_.find_next()) {
+                detail::reserve_batch(*buffer_, std::min(rng_->buffer_size_,
+                                                         reader_.remaining()));
+            }
+            this->start();
+        }
+    };  // struct cursor
+
+    cursor begin_cursor() { return cursor{*this}; }
+
+public:
+    shuffle_view() = default;
+    shuffle_view(Rng rng, std::size_t buffer_size, Prng& prng)
+      : rng_{rng}
+      , buffer_size_{buffer_size}
+      , prng_{&prng}
+    {
+        if (buffer_size_ == 0) throw std::invalid_argument{"Shuffle buffer size has to be positive."};
+    }
+};  // class shuffle_view
+
+namespace detail {
+
+    struct shuffle_fn {
+        template <typename Rng, typename Prng, CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
+        shuffle_view<ranges::view::all_t<Rng>, Prng>
+        operator()(Rng&& rng, std::size_t buffer_size, Prng& prng) const
+        {
+            return {ranges::view::all(std::forward<Rng>(rng)), buffer_size, prng};
+        }
+    };
+
+}  // namespace detail
+
+/// \ingroup Stream
+/// \brief Shuffle the examples of the stream using a buffer of a limited size.
+///
+/// The first `buffer_size` examples are stored in a buffer. Afterwards, each incoming
+/// example replaces a randomly chosen example of the buffer, which is yielded instead.
+/// Hence, at most `buffer_size` examples (plus the current batch) are held in memory
+/// regardless of the length of the stream. At the end of the stream, the buffer is
+/// yielded in a random order.
+///
+/// The yielded batches have the same size as the incoming batches once the buffer is full.
+/// The buffer is drained in batches of the size of the largest incoming batch.
+/// Use stream::batch() to change the batch size afterwards.
+///
+/// The larger the buffer, the better the randomization. An example can be yielded
+/// at most `buffer_size` positions earlier than in the original stream. For a uniform
+/// shuffle of the whole stream, the buffer has to be at least as large as the stream.
+///
+/// \code
+///     CXTREAM_DEFINE_COLUMN(value, int)
+///     std::mt19937 prng{42};
+///     auto rng = view::iota(0, 1000000)
+///       | create<value>(100)
+///       | shuffle(10000, prng)
+///       | batch(32);
+/// \endcode
+///
+/// \param buffer_size The maximum number of examples held in the buffer.
+/// \param prng The random generator to be used. It is referenced, not copied, so
+///             seed it to obtain a deterministic order. The default generator is
+///             thread local.
+template <typename Prng = std::mt19937>
+auto shuffle(std::size_t buffer_size, Prng& prng = utility::random_generator)
+{
+    return ranges::make_pipeable(std::bind(detail::shuffle_fn{}, std::placeholders::_1,
+                                           buffer_size, std::ref(prng)));
+}
+
+}  // namespace cxtream::stream
+#endif
@@ -10,8 +10,13 @@
 #ifndef CXTREAM_CORE_STREAM_TEMPLATE_ARGUMENTS_HPP
 #define CXTREAM_CORE_STREAM_TEMPLATE_ARGUMENTS_HPP
 
+#include <cstddef>
 #include <functional>
 
+namespace cxtream {
+class thread_pool;
+}  // namespace cxtream
+
 namespace cxtream::stream {
 
 template <typename... Columns>
@@ -63,6 +68,35 @@ auto mask = mask_t<Columns...>{};
 template <int Dim>
 auto dim = dim_t<Dim>{};
 
+template <std::size_t NChunks>
+struct parallel_t {
+    /// The thread pool to be used. If null, the global thread pool is used.
+    thread_pool* pool = nullptr;
+};
+
+/// Helper type requesting a parallel evaluation split to the given number of chunks.
+///
+/// If the number of chunks is zero, it is deduced from the size of the thread pool.
+template <std::size_t NChunks = 0>
+auto parallel = parallel_t<NChunks>{};
+
+/// Same as parallel, but the evaluation is performed by the given thread pool.
+template <std::size_t NChunks = 0>
+parallel_t<NChunks> parallel_on(thread_pool& pool)
+{
+    return {&pool};
+}
+
+struct typed_t {
+};
+
+/// Helper type requesting a stream transformation without type erasure.
+///
+/// The resulting stream keeps its full type, so that the transformation can be inlined
+/// and the category of the source range (e.g., random access) is preserved, at the cost
+/// of longer compilation times of long pipelines.
+auto typed = typed_t{};
+
 struct identity_t {
     template <typename T>
     constexpr T&& operator()(T&& val) const noexcept
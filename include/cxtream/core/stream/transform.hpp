@@ -12,11 +12,15 @@
 
 #include <cxtream/build_config.hpp>
 #include <cxtream/core/stream/template_arguments.hpp>
+#include <cxtream/core/ragged.hpp>
+#include <cxtream/core/tensor.hpp>
+#include <cxtream/core/thread.hpp>
 #include <cxtream/core/utility/random.hpp>
 #include <cxtream/core/utility/tuple.hpp>
 #include <cxtream/core/utility/vector.hpp>
 
 #include <range/v3/view/any_view.hpp>
+#include <range/v3/view/move.hpp>
 #include <range/v3/view/transform.hpp>
 #include <range/v3/view/zip.hpp>
 
@@ -52,6 +56,24 @@ namespace detail {
         }
     };
 
+    // The elements of a single pass range (e.g., stream::buffer) are visited only once,
+    // so they are moved to the transformation instead of being copied.
+    template<typename Rng>
+    decltype(auto) move_single_pass(Rng&& rng)
+    {
+        if constexpr (ranges::ForwardRange<Rng>()) return std::forward<Rng>(rng);
+        else return ranges::view::move(std::forward<Rng>(rng));
+    }
+
+    // The implementation of partial_transform.
+    //
+    // If TypeErased is true, the source range is wrapped in an any_view. This limits
+    // the nesting of the resulting types and considerably speeds up the compilation
+    // of long pipelines, but every element pays an indirect call per stage and the
+    // range degrades to (at most) a forward range. If TypeErased is false, the
+    // transformation is fully typed, can be inlined and preserves the category
+    // of the source range (e.g., random access).
+    template<bool TypeErased>
     class partial_transform_fn {
     private:
         friend ranges::view::view_access;
@@ -67,7 +89,7 @@ namespace detail {
     public:
         template <typename Rng, typename... FromTypes, typename... ToTypes,
                   typename Fun, typename Projection = ref_wrap_t,
-                  CONCEPT_REQUIRES_(ranges::ForwardRange<Rng>())>
+                  CONCEPT_REQUIRES_(ranges::InputRange<Rng>())>
         constexpr auto operator()(Rng&& rng, from_t<FromTypes...>, to_t<ToTypes...>, Fun fun,
                                   Projection proj = Projection{}) const
         {
@@ -79,21 +101,30 @@ namespace detail {
               StreamType, from_t<FromTypes...>, to_t<ToTypes...>>
               trans_fun{std::move(fun), std::move(proj)};
     
-            // any_view is used to erase types and speed up compilation time
-            using RefType = ranges::range_reference_t<Rng>;
-            return ranges::view::transform(
-              ranges::any_view<RefType, ranges::category::forward>{std::forward<Rng>(rng)},
-              std::move(trans_fun));
+            auto&& source = move_single_pass(std::forward<Rng>(rng));
+            using Source = decltype(source);
+            if constexpr (TypeErased) {
+                // any_view is used to erase types and speed up compilation time
+                // single pass ranges (e.g., stream::buffer or stream::pipe) are erased as input
+                using RefType = ranges::range_reference_t<Source>;
+                constexpr auto category = ranges::ForwardRange<Rng>() ? ranges::category::forward
+                                                                       : ranges::category::input;
+                return ranges::view::transform(
+                  ranges::any_view<RefType, category>{std::forward<Source>(source)},
+                  std::move(trans_fun));
+            } else {
+                return ranges::view::transform(std::forward<Source>(source), std::move(trans_fun));
+            }
         }
     
         /// \cond
         template <typename Rng, typename From, typename To,
                   typename Fun, typename Proj = ref_wrap_t,
-                  CONCEPT_REQUIRES_(!ranges::ForwardRange<Rng>())>
+                  CONCEPT_REQUIRES_(!ranges::InputRange<Rng>())>
         constexpr auto operator()(Rng&& rng, From, To, Fun, Proj, Proj proj = Proj{}) const
         {
-            CONCEPT_ASSERT_MSG(ranges::ForwardRange<Rng>(),
-              "Stream transformations only work on ranges satisfying the ForwardRange concept.");
+            CONCEPT_ASSERT_MSG(ranges::InputRange<Rng>(),
+              "Stream transformations only work on ranges satisfying the InputRange concept.");
         }
         /// \endcond
     };
@@ -104,29 +135,54 @@ namespace detail {
 // with the original tuple.
 //
 // The result tuple overrides the corresponding types from the original tuple.
-constexpr ranges::view::view<detail::partial_transform_fn> partial_transform{};
+//
+// The stream is type-erased to keep the compilation times of long pipelines reasonable.
+constexpr ranges::view::view<detail::partial_transform_fn<true>> partial_transform{};
+
+// Same as partial_transform, but the full type of the stream is kept, which removes
+// the per-element virtual dispatch and preserves the category of the source range.
+constexpr ranges::view::view<detail::partial_transform_fn<false>> typed_partial_transform{};
+
+namespace detail {
+
+    // Select the partial transform by whether the stream should be type-erased.
+    template<bool TypeErased, typename... Args>
+    constexpr auto partial_transform_impl(Args&&... args)
+    {
+        if constexpr (TypeErased) return stream::partial_transform(std::forward<Args>(args)...);
+        else return stream::typed_partial_transform(std::forward<Args>(args)...);
+    }
+
+}  // namespace detail
 
 // transform //
 
 namespace detail {
 
     // Apply fun to each element in tuple of ranges in the given dimension.
+    //
+    // FromTypes are the reference types of the source ranges, e.g., std::vector<int>&,
+    // or tensor_view<float, 2> for the examples of a tensor batch.
     template<typename Fun, std::size_t Dim, std::size_t NOuts, typename From, typename To>
     struct wrap_fun_for_dim;
 
     template<typename Fun, std::size_t Dim, std::size_t NOuts,
              typename... FromTypes, typename... ToTypes>
     struct wrap_fun_for_dim<Fun, Dim, NOuts, from_t<FromTypes...>, to_t<ToTypes...>> {
+        static_assert(Dim == 1 || (... && !is_tensor<std::decay_t<FromTypes>>{}
+                                       && !is_ragged<std::decay_t<FromTypes>>{}),
+          "Tensor and ragged columns can only be transformed in dimensions 0 and 1.");
+
         Fun fun;
         using FunRef = decltype(std::ref(fun));
 
         constexpr utility::maybe_tuple<ToTypes...>
-        operator()(std::tuple<FromTypes&...> tuple_of_ranges)
+        operator()(std::tuple<FromTypes...> tuple_of_ranges)
         {
             assert(utility::same_size(tuple_of_ranges));
             // build the function to be applied
             wrap_fun_for_dim<FunRef, Dim-1, NOuts,
-              from_t<ranges::range_value_type_t<FromTypes>...>,
+              from_t<ranges::range_reference_t<std::remove_reference_t<FromTypes>>...>,
               to_t<ranges::range_value_type_t<ToTypes>...>>
                 fun_wrapper{std::ref(fun)};
             // transform
@@ -143,17 +199,39 @@ namespace detail {
         Fun fun;
 
         constexpr utility::maybe_tuple<ToTypes...>
-        operator()(std::tuple<FromTypes&...> tuple)
+        operator()(std::tuple<FromTypes...> tuple)
         {
             return boost::hana::unpack(std::move(tuple), fun);
         }
     };
 
+    // The implementation of stream::transform.
+    template<bool TypeErased, typename... FromColumns, typename... ToColumns,
+             typename Fun, int Dim>
+    constexpr auto transform_impl(from_t<FromColumns...> f,
+                                  to_t<ToColumns...> t,
+                                  Fun fun,
+                                  dim_t<Dim>)
+    {
+        // wrap the function to be applied in the appropriate dimension
+        wrap_fun_for_dim<
+          Fun, Dim, sizeof...(ToColumns),
+          from_t<typename FromColumns::batch_type&...>,
+          to_t<typename ToColumns::batch_type...>>
+          fun_wrapper{std::move(fun)};
+
+        auto proj = [](auto& column) { return std::ref(column.value()); };
+        return partial_transform_impl<TypeErased>(f, t, std::move(fun_wrapper), std::move(proj));
+    }
+
 }  // namespace detail
 
 /// \ingroup Stream
 /// \brief Transform a subset of cxtream columns to a different subset of cxtream columns.
 ///
+/// The stream is type-erased, which keeps the compilation times of long pipelines
+/// reasonable. Use the overload accepting \ref typed to keep the full type of the stream.
+///
 /// Example:
 /// \code
 ///     CXTREAM_DEFINE_COLUMN(id, int)
@@ -179,15 +257,193 @@ constexpr auto transform(from_t<FromColumns...> f,
                          Fun fun,
                          dim_t<Dim> d = dim_t<1>{})
 {
-    // wrap the function to be applied in the appropriate dimension
-    detail::wrap_fun_for_dim<
-      Fun, Dim, sizeof...(ToColumns),
-      from_t<typename FromColumns::batch_type...>,
-      to_t<typename ToColumns::batch_type...>>
-      fun_wrapper{std::move(fun)};
-
-    auto proj = [](auto& column) { return std::ref(column.value()); };
-    return stream::partial_transform(f, t, std::move(fun_wrapper), std::move(proj));
+    return detail::transform_impl<true>(f, t, std::move(fun), d);
+}
+
+/// \ingroup Stream
+/// \brief Same as stream::transform(), but the stream is not type-erased.
+///
+/// Every stage can be inlined and the category of the source range (e.g., random access)
+/// is preserved. The type of the stream grows with each stage, so long pipelines take
+/// longer to compile.
+///
+/// \code
+///     auto rng = data
+///       | create<id, value>()
+///       | transform(from<id>, to<value>, [](int id) { return id * 5. + 1.; }, dim<1>, typed);
+/// \endcode
+template<typename... FromColumns, typename... ToColumns, typename Fun, int Dim>
+constexpr auto transform(from_t<FromColumns...> f,
+                         to_t<ToColumns...> t,
+                         Fun fun,
+                         dim_t<Dim> d,
+                         typed_t)
+{
+    return detail::transform_impl<false>(f, t, std::move(fun), d);
+}
+
+// parallel transform //
+
+namespace detail {
+
+    // The type to which the parallel transform writes its results in place.
+    // Tensors and ragged arrays cannot be written in place before the shapes of their
+    // elements are known, so the elements are collected to a vector and stacked afterwards.
+    template<typename Batch>
+    struct parallel_result {
+        using type = Batch;
+    };
+
+    template<typename T, long NDims>
+    struct parallel_result<tensor<T, NDims>> {
+        using type = std::vector<tensor<T, NDims - 1>>;
+    };
+
+    template<typename T, long NDims>
+    struct parallel_result<ragged<T, NDims>> {
+        using type = std::vector<ragged<T, NDims - 1>>;
+    };
+
+    // Apply fun to each element in tuple of ranges in the given dimension.
+    // The first dimension of the ranges is split to chunks which are processed in parallel.
+    template<typename Fun, std::size_t Dim, std::size_t NOuts, std::size_t NChunks,
+             typename From, typename To>
+    struct wrap_fun_for_dim_parallel;
+
+    template<typename Fun, std::size_t Dim, std::size_t NOuts, std::size_t NChunks,
+             typename... FromTypes, typename... ToTypes>
+    struct wrap_fun_for_dim_parallel<Fun, Dim, NOuts, NChunks,
+                                     from_t<FromTypes...>, to_t<ToTypes...>> {
+        static_assert(Dim > 0, "Parallel transform requires a positive dimension.");
+        static_assert(sizeof...(FromTypes) > 0, "Parallel transform requires a source column.");
+        static_assert((... && !std::is_same<ranges::range_value_type_t<ToTypes>, bool>{}),
+          "Parallel transform cannot write to std::vector<bool> concurrently,"
+          " please use char instead.");
+        static_assert((... && std::is_default_constructible<ranges::range_value_type_t<ToTypes>>{}),
+          "Parallel transform requires default constructible target values.");
+
+        Fun fun;
+        std::reference_wrapper<thread_pool> pool;
+
+        utility::maybe_tuple<ToTypes...>
+        operator()(std::tuple<FromTypes&...> tuple_of_ranges)
+        {
+            assert(utility::same_size(tuple_of_ranges));
+            std::size_t n = ranges::size(std::get<0>(tuple_of_ranges));
+            // the function applied to a single element of the first dimension
+            wrap_fun_for_dim<std::reference_wrapper<Fun>, Dim-1, NOuts,
+              from_t<ranges::range_reference_t<FromTypes>...>,
+              to_t<ranges::range_value_type_t<ToTypes>...>>
+                elem_fun{std::ref(fun)};
+            // preallocate the result, so that the chunks can write to it in place
+            std::tuple<typename parallel_result<ToTypes>::type...> result;
+            utility::tuple_for_each(result, [n](auto& rng) { rng.resize(n); });
+            auto chunk_fun = [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    auto elem = boost::hana::unpack(tuple_of_ranges, [i](auto&... rngs) {
+                        return std::tuple<ranges::range_reference_t<FromTypes>...>{rngs[i]...};
+                    });
+                    store(result, i, elem_fun(std::move(elem)),
+                          std::make_index_sequence<sizeof...(ToTypes)>{});
+                }
+            };
+            pool.get().parallel_for(n, chunk_fun, NChunks);
+            std::tuple<ToTypes...> batches{std::move(result)};
+            return utility::maybe_untuple(std::move(batches));
+        }
+
+    private:
+        template<typename Value, std::size_t... Is>
+        static void store(std::tuple<typename parallel_result<ToTypes>::type...>& result,
+                          std::size_t i, Value&& value, std::index_sequence<Is...>)
+        {
+            if constexpr (sizeof...(ToTypes) == 1) {
+                std::get<0>(result)[i] = std::forward<Value>(value);
+            } else {
+                (..., (std::get<Is>(result)[i] = std::move(std::get<Is>(value))));
+            }
+        }
+    };
+
+    // The implementation of the parallel stream::transform.
+    template<bool TypeErased, typename... FromColumns, typename... ToColumns,
+             typename Fun, int Dim, std::size_t NChunks>
+    constexpr auto parallel_transform_impl(from_t<FromColumns...> f,
+                                           to_t<ToColumns...> t,
+                                           Fun fun,
+                                           dim_t<Dim>,
+                                           parallel_t<NChunks> p)
+    {
+        wrap_fun_for_dim_parallel<
+          Fun, Dim, sizeof...(ToColumns), NChunks,
+          from_t<typename FromColumns::batch_type...>,
+          to_t<typename ToColumns::batch_type...>>
+          fun_wrapper{std::move(fun), p.pool ? *p.pool : global_thread_pool()};
+
+        auto proj = [](auto& column) { return std::ref(column.value()); };
+        return partial_transform_impl<TypeErased>(f, t, std::move(fun_wrapper), std::move(proj));
+    }
+
+}  // namespace detail
+
+/// \ingroup Stream
+/// \brief Parallel version of stream::transform().
+///
+/// The batch is split to chunks in the first dimension and the chunks are processed
+/// in parallel by the \ref global_thread_pool() or by the thread pool provided
+/// using parallel_on(). The results are written directly to their
+/// final positions, so the order of the examples is preserved.
+///
+/// The function has to be safe to be called from multiple threads at once.
+/// The target columns have to be default constructible and they must not
+/// be `bool`, because std::vector<bool> cannot be written concurrently.
+///
+/// Example:
+/// \code
+///     CXTREAM_DEFINE_COLUMN(image, cv::Mat)
+///     auto rng = data
+///       | create<image>(256)
+///       // augment the images using four chunks processed in parallel
+///       | transform(from<image>, to<image>, augment, dim<1>, parallel<4>);
+///       // parallel<> uses as many chunks as the thread pool has threads + 1
+///
+///     // use a dedicated thread pool
+///     cxtream::thread_pool pool{8};
+///     auto rng2 = data
+///       | create<image>(256)
+///       | transform(from<image>, to<image>, augment, dim<1>, parallel_on<8>(pool));
+/// \endcode
+///
+/// \param f The columns to be extracted out of the tuple of columns and passed to fun.
+/// \param t The columns where the result will be saved.
+/// \param fun The function to be applied.
+/// \param d The dimension in which is the function applied. Has to be positive.
+/// \param p The number of chunks the batch is split to.
+template<typename... FromColumns, typename... ToColumns, typename Fun,
+         int Dim, std::size_t NChunks>
+constexpr auto transform(from_t<FromColumns...> f,
+                         to_t<ToColumns...> t,
+                         Fun fun,
+                         dim_t<Dim> d,
+                         parallel_t<NChunks> p)
+{
+    return detail::parallel_transform_impl<true>(f, t, std::move(fun), d, p);
+}
+
+/// \ingroup Stream
+/// \brief Same as the parallel stream::transform(), but the stream is not type-erased.
+///
+/// See the overload of stream::transform() accepting \ref typed.
+template<typename... FromColumns, typename... ToColumns, typename Fun,
+         int Dim, std::size_t NChunks>
+constexpr auto transform(from_t<FromColumns...> f,
+                         to_t<ToColumns...> t,
+                         Fun fun,
+                         dim_t<Dim> d,
+                         parallel_t<NChunks> p,
+                         typed_t)
+{
+    return detail::parallel_transform_impl<false>(f, t, std::move(fun), d, p);
 }
 
 // conditional transform //
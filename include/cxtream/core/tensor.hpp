@@ -0,0 +1,595 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+/// \defgroup Tensor Dense multidimensional arrays.
+
+#ifndef CXTREAM_CORE_TENSOR_HPP
+#define CXTREAM_CORE_TENSOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxtream {
+
+template<typename T, long NDims>
+class tensor;
+
+template<typename T, long NDims>
+class tensor_view;
+
+/// \ingroup Tensor
+/// \brief Checks whether the given type is a tensor or a tensor_view.
+template<typename T>
+struct is_tensor : std::false_type {
+};
+
+template<typename T, long NDims>
+struct is_tensor<tensor<T, NDims>> : std::true_type {
+};
+
+template<typename T, long NDims>
+struct is_tensor<tensor_view<T, NDims>> : std::true_type {
+};
+
+namespace detail {
+
+    // Allocator of memory aligned to the given number of bytes.
+    //
+    // The alignment of tensor data to a cache line allows the vectorization of the
+    // loops and avoids false sharing when the examples are processed in parallel.
+    template<typename T, std::size_t Align = 64>
+    struct aligned_allocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = aligned_allocator<U, Align>;
+        };
+
+        aligned_allocator() = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U, Align>&) noexcept
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+        }
+
+        void deallocate(T* ptr, std::size_t) noexcept
+        {
+            ::operator delete(ptr, std::align_val_t{Align});
+        }
+
+        template<typename U>
+        bool operator==(const aligned_allocator<U, Align>&) const noexcept { return true; }
+
+        template<typename U>
+        bool operator!=(const aligned_allocator<U, Align>&) const noexcept { return false; }
+    };
+
+    // Check whether a type can be iterated over using std::begin and std::end.
+    template<typename T, typename = void>
+    struct is_iterable : std::false_type {
+    };
+
+    template<typename T>
+    struct is_iterable<T, std::void_t<decltype(std::begin(std::declval<T&>())),
+                                      decltype(std::end(std::declval<T&>()))>>
+      : std::true_type {
+    };
+
+    // Check whether a range can be stacked to a tensor of the given dimensionality,
+    // i.e., whether it is a range of subtensors (or a range of elements for NDims == 1).
+    template<typename Rng, typename T, long NDims, typename = void>
+    struct is_stackable : std::false_type {
+    };
+
+    template<typename Rng, typename T, long NDims>
+    struct is_stackable<Rng, T, NDims, std::enable_if_t<is_iterable<Rng>{}>> {
+        using elem_t = std::remove_cv_t<
+          std::remove_reference_t<decltype(*std::begin(std::declval<Rng&>()))>>;
+
+        static constexpr bool check()
+        {
+            if constexpr (NDims == 1) return std::is_convertible<elem_t&, T>{};
+            else if constexpr (is_tensor<elem_t>{}) return elem_t::ndims() == NDims - 1;
+            else return is_stackable<elem_t, T, NDims - 1>::value;
+        }
+
+        static constexpr bool value = check();
+    };
+
+    // Calculate the number of elements of a tensor of the given shape.
+    template<std::size_t N>
+    std::size_t shape_numel(const std::array<std::size_t, N>& shape)
+    {
+        return std::accumulate(shape.begin(), shape.end(), std::size_t{1},
+                               std::multiplies<std::size_t>{});
+    }
+
+    // Drop the first dimension from the given shape.
+    template<std::size_t N>
+    std::array<std::size_t, N - 1> shape_tail(const std::array<std::size_t, N>& shape)
+    {
+        std::array<std::size_t, N - 1> tail;
+        std::copy(shape.begin() + 1, shape.end(), tail.begin());
+        return tail;
+    }
+
+    // Random access iterator through the first dimension of a tensor.
+    // The iterator yields views of the subtensors.
+    template<typename T, long NDims>
+    class tensor_iterator {
+    private:
+        T* data_ = nullptr;
+        std::array<std::size_t, NDims - 1> shape_{};
+        std::size_t stride_ = 0;
+        // the index is stored explicitly, because empty subtensors share the same address
+        std::ptrdiff_t idx_ = 0;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = tensor<std::remove_const_t<T>, NDims - 1>;
+        using difference_type = std::ptrdiff_t;
+        using reference = tensor_view<T, NDims - 1>;
+        using pointer = void;
+
+        tensor_iterator() = default;
+
+        tensor_iterator(T* data, std::array<std::size_t, NDims - 1> shape, std::ptrdiff_t idx = 0)
+          : data_{data}
+          , shape_{shape}
+          , stride_{shape_numel(shape)}
+          , idx_{idx}
+        {
+        }
+
+        // a mutable iterator is convertible to a const iterator
+        template<typename U, typename = std::enable_if_t<std::is_same<const U, T>{}>>
+        tensor_iterator(const tensor_iterator<U, NDims>& that)
+          : tensor_iterator{that.data(), that.shape(), that.index()}
+        {
+        }
+
+        T* data() const { return data_; }
+        const std::array<std::size_t, NDims - 1>& shape() const { return shape_; }
+        std::ptrdiff_t index() const { return idx_; }
+
+        reference operator*() const { return {data_ + idx_ * stride_, shape_}; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        tensor_iterator& operator++() { ++idx_; return *this; }
+        tensor_iterator& operator--() { --idx_; return *this; }
+        tensor_iterator operator++(int) { auto tmp = *this; ++idx_; return tmp; }
+        tensor_iterator operator--(int) { auto tmp = *this; --idx_; return tmp; }
+        tensor_iterator& operator+=(difference_type n) { idx_ += n; return *this; }
+        tensor_iterator& operator-=(difference_type n) { idx_ -= n; return *this; }
+
+        friend tensor_iterator operator+(tensor_iterator it, difference_type n) { return it += n; }
+        friend tensor_iterator operator+(difference_type n, tensor_iterator it) { return it += n; }
+        friend tensor_iterator operator-(tensor_iterator it, difference_type n) { return it -= n; }
+
+        friend difference_type operator-(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ - b.idx_;
+        }
+
+        friend bool operator==(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ == b.idx_;
+        }
+        friend bool operator!=(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ != b.idx_;
+        }
+        friend bool operator<(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ < b.idx_;
+        }
+        friend bool operator>(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ > b.idx_;
+        }
+        friend bool operator<=(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ <= b.idx_;
+        }
+        friend bool operator>=(const tensor_iterator& a, const tensor_iterator& b)
+        {
+            return a.idx_ >= b.idx_;
+        }
+    };
+
+    // The types of the subtensors in the first dimension.
+    template<typename T, long NDims>
+    struct subtensor_traits {
+        using value_type = tensor<std::remove_const_t<T>, NDims - 1>;
+        using reference = tensor_view<T, NDims - 1>;
+        using iterator = tensor_iterator<T, NDims>;
+
+        static iterator make_iterator(T* data, const std::array<std::size_t, NDims>& shape)
+        {
+            return {data, shape_tail(shape)};
+        }
+    };
+
+    // One-dimensional tensors are iterated by plain pointers.
+    template<typename T>
+    struct subtensor_traits<T, 1> {
+        using value_type = std::remove_const_t<T>;
+        using reference = T&;
+        using iterator = T*;
+
+        static iterator make_iterator(T* data, const std::array<std::size_t, 1>&)
+        {
+            return data;
+        }
+    };
+
+    // The common interface of tensor and tensor_view.
+    //
+    // The derived class provides data() and shape() methods.
+    template<typename Derived, typename T, long NDims>
+    class tensor_base {
+    private:
+        using mutable_traits = subtensor_traits<T, NDims>;
+        using const_traits = subtensor_traits<const T, NDims>;
+
+        Derived& derived() { return static_cast<Derived&>(*this); }
+        const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    public:
+        static_assert(NDims > 0, "Tensor has to have at least one dimension.");
+
+        using element_type = T;
+        using value_type = typename mutable_traits::value_type;
+        using reference = typename mutable_traits::reference;
+        using const_reference = typename const_traits::reference;
+        using iterator = typename mutable_traits::iterator;
+        using const_iterator = typename const_traits::iterator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        /// The number of dimensions.
+        static constexpr long ndims() { return NDims; }
+
+        /// The size of the first dimension.
+        std::size_t size() const { return derived().shape()[0]; }
+
+        /// Whether the first dimension is empty.
+        bool empty() const { return size() == 0; }
+
+        /// The total number of elements.
+        std::size_t numel() const { return shape_numel(derived().shape()); }
+
+        iterator begin() { return mutable_traits::make_iterator(derived().data(), derived().shape()); }
+        iterator end() { return begin() + size(); }
+        const_iterator begin() const
+        {
+            return const_traits::make_iterator(derived().data(), derived().shape());
+        }
+        const_iterator end() const { return begin() + size(); }
+
+        /// Access a subtensor (or an element if the tensor is one-dimensional).
+        reference operator[](std::size_t i) { return begin()[i]; }
+        const_reference operator[](std::size_t i) const { return begin()[i]; }
+
+        /// Access a subtensor with bounds checking.
+        reference at(std::size_t i)
+        {
+            if (i >= size()) throw std::out_of_range{"Tensor index out of range."};
+            return (*this)[i];
+        }
+        const_reference at(std::size_t i) const
+        {
+            if (i >= size()) throw std::out_of_range{"Tensor index out of range."};
+            return (*this)[i];
+        }
+
+        /// Access a single element using the indices in all dimensions.
+        template<typename... Idxs>
+        decltype(auto) operator()(Idxs... idxs)
+        {
+            return derived().data()[flat_index(idxs...)];
+        }
+        template<typename... Idxs>
+        decltype(auto) operator()(Idxs... idxs) const
+        {
+            return derived().data()[flat_index(idxs...)];
+        }
+
+        /// The position of the element with the given indices in the flat data.
+        template<typename... Idxs>
+        std::size_t flat_index(Idxs... idxs) const
+        {
+            static_assert(sizeof...(Idxs) == NDims, "Provide an index for each dimension.");
+            const auto& shape = derived().shape();
+            std::array<std::size_t, NDims> idx_arr{static_cast<std::size_t>(idxs)...};
+            std::size_t flat = 0;
+            for (std::size_t i = 0; i < NDims; ++i) {
+                assert(idx_arr[i] < shape[i]);
+                flat = flat * shape[i] + idx_arr[i];
+            }
+            return flat;
+        }
+    };
+
+}  // namespace detail
+
+/// \ingroup Tensor
+/// \brief Non-owning view of a dense tensor.
+///
+/// The view refers to a contiguous row-major block of memory, e.g., to a subtensor of
+/// a tensor. Iteration through the view yields views of its subtensors (or the
+/// elements themselves if the view is one-dimensional).
+template<typename T, long NDims>
+class tensor_view : public detail::tensor_base<tensor_view<T, NDims>, T, NDims> {
+private:
+    T* data_ = nullptr;
+    std::array<std::size_t, NDims> shape_{};
+
+public:
+    tensor_view() = default;
+
+    tensor_view(T* data, std::array<std::size_t, NDims> shape)
+      : data_{data}
+      , shape_{shape}
+    {
+    }
+
+    /// A view of mutable data is convertible to a view of const data.
+    template<typename U, typename = std::enable_if_t<std::is_same<const U, T>{}>>
+    tensor_view(const tensor_view<U, NDims>& that)
+      : tensor_view{that.data(), that.shape()}
+    {
+    }
+
+    /// Create a view of the whole tensor.
+    explicit tensor_view(tensor<std::remove_const_t<T>, NDims>& t)
+      : tensor_view{t.data(), t.shape()}
+    {
+    }
+
+    /// Create a const view of the whole tensor.
+    template<typename U = T, typename = std::enable_if_t<std::is_const<U>{}>>
+    explicit tensor_view(const tensor<std::remove_const_t<T>, NDims>& t)
+      : tensor_view{t.data(), t.shape()}
+    {
+    }
+
+    T* data() const { return data_; }
+    const std::array<std::size_t, NDims>& shape() const { return shape_; }
+};
+
+/// \ingroup Tensor
+/// \brief Dense multidimensional array.
+///
+/// The elements are stored in a single row-major buffer aligned to a cache line,
+/// so a batch of images is a single allocation instead of a vector of vectors of
+/// vectors. The first dimension behaves like an std::vector of subtensors, i.e., the
+/// tensor can be iterated, extended by push_back() and insert() and reserved in the
+/// first dimension. Iteration yields \ref tensor_view "tensor_views" of the subtensors.
+///
+/// Example:
+/// \code
+///     cxtream::tensor<float, 2> t{{1, 2, 3}, {4, 5, 6}};
+///     // t.shape() == {2, 3}
+///     // t(1, 2) == 6
+///     t.push_back(cxtream::tensor<float, 1>{7, 8, 9});
+///     // t.shape() == {3, 3}
+///     for (cxtream::tensor_view<float, 1> row : t) row[0] = 0;
+/// \endcode
+template<typename T, long NDims>
+class tensor : public detail::tensor_base<tensor<T, NDims>, T, NDims> {
+private:
+    using base_t = detail::tensor_base<tensor<T, NDims>, T, NDims>;
+
+    static_assert(!std::is_same<T, bool>{}, "Tensor cannot store bool due to the"
+                                             " std::vector<bool> specialization, use"
+                                             " std::uint8_t or char instead.");
+
+    std::vector<T, detail::aligned_allocator<T>> data_;
+    std::array<std::size_t, NDims> shape_{};
+    // the number of subtensors to be reserved once their shape is known
+    std::size_t reserved_ = 0;
+
+    // the number of elements of a single subtensor in the first dimension
+    std::size_t stride() const
+    {
+        return detail::shape_numel(detail::shape_tail(shape_));
+    }
+
+    // append a subtensor given by its data and shape
+    template<typename Example>
+    void append(const Example& example)
+    {
+        static_assert(NDims > 1);
+        std::array<std::size_t, NDims - 1> example_shape = example.shape();
+        if (shape_[0] == 0) {
+            // the first subtensor defines the shape of the others
+            std::copy(example_shape.begin(), example_shape.end(), shape_.begin() + 1);
+        } else if (example_shape != detail::shape_tail(shape_)) {
+            throw std::invalid_argument{"Cannot append a subtensor of a different shape."};
+        }
+        data_.insert(data_.end(), example.data(), example.data() + example.numel());
+        ++shape_[0];
+    }
+
+public:
+    using typename base_t::value_type;
+    using typename base_t::iterator;
+    using typename base_t::const_iterator;
+
+    tensor() = default;
+
+    /// Create a tensor of the given shape filled with the given value.
+    explicit tensor(std::array<std::size_t, NDims> shape, const T& value = T{})
+      : data_(detail::shape_numel(shape), value)
+      , shape_{shape}
+    {
+    }
+
+    /// Copy the data of a tensor view.
+    template<typename U, typename = std::enable_if_t<std::is_same<std::remove_const_t<U>, T>{}>>
+    tensor(const tensor_view<U, NDims>& view)
+      : data_(view.data(), view.data() + view.numel())
+      , shape_{view.shape()}
+    {
+    }
+
+    /// Stack the subtensors.
+    ///
+    /// For one-dimensional tensors, this constructor creates a tensor from the given
+    /// elements. The subtensors can also be nested ranges (e.g., std::vector<std::vector<T>>).
+    /// All the subtensors have to be of the same shape.
+    tensor(std::initializer_list<value_type> examples)
+    {
+        reserve(examples.size());
+        for (auto& example : examples) push_back(example);
+    }
+
+    /// \copydoc tensor(std::initializer_list<value_type>)
+    template<typename Rng, typename = std::enable_if_t<
+      detail::is_stackable<std::remove_reference_t<Rng>, T, NDims>::value
+      && !is_tensor<std::decay_t<Rng>>{}>>
+    tensor(Rng&& examples)
+    {
+        for (auto&& example : examples) {
+            if constexpr (std::is_rvalue_reference<Rng&&>{}) push_back(std::move(example));
+            else push_back(example);
+        }
+    }
+
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+    const std::array<std::size_t, NDims>& shape() const { return shape_; }
+
+    /// The number of subtensors in the first dimension for which the memory is reserved.
+    std::size_t capacity() const
+    {
+        return stride() == 0 ? reserved_ : data_.capacity() / stride();
+    }
+
+    /// Reserve memory for the given number of subtensors in the first dimension.
+    ///
+    /// If the shape of the subtensors is not yet known (e.g., the tensor is empty), the
+    /// memory is reserved when the first subtensor is appended.
+    void reserve(std::size_t n)
+    {
+        if (stride() > 0) data_.reserve(n * stride());
+        reserved_ = n;
+    }
+
+    /// Remove all the subtensors, but keep the allocated memory.
+    ///
+    /// The shape of the subtensors is forgotten, so that the next push_back()
+    /// can append a subtensor of a different shape.
+    void clear()
+    {
+        data_.clear();
+        shape_ = {};
+    }
+
+    /// Resize the first dimension. The shape of the subtensors has to be known.
+    void resize(std::size_t n, const T& value = T{})
+    {
+        data_.resize(n * stride(), value);
+        shape_[0] = n;
+    }
+
+    /// Resize the tensor to the given shape, the data are treated as flat.
+    void resize(std::array<std::size_t, NDims> shape, const T& value = T{})
+    {
+        data_.resize(detail::shape_numel(shape), value);
+        shape_ = shape;
+    }
+
+    /// Change the shape of the tensor without changing its data.
+    void reshape(std::array<std::size_t, NDims> shape)
+    {
+        if (detail::shape_numel(shape) != data_.size()) {
+            throw std::invalid_argument{"Cannot reshape tensor to a different number of elements."};
+        }
+        shape_ = shape;
+    }
+
+    /// Append a subtensor (or an element if the tensor is one-dimensional).
+    ///
+    /// All the subtensors have to be of the same shape.
+    template<typename Example>
+    void push_back(Example&& example)
+    {
+        if constexpr (NDims == 1) {
+            data_.push_back(std::forward<Example>(example));
+            ++shape_[0];
+        } else if constexpr (is_tensor<std::decay_t<Example>>{}) {
+            bool first = shape_[0] == 0;
+            append(example);
+            if (first && reserved_ > 1) data_.reserve(reserved_ * stride());
+        } else {
+            push_back(value_type(std::forward<Example>(example)));
+        }
+    }
+
+    /// Append multiple subtensors at the end of the tensor.
+    ///
+    /// The position has to be the end of the tensor.
+    template<typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        assert(pos == this->end() && "Tensor only supports insertion at its end.");
+        std::size_t old_size = this->size();
+        if constexpr (NDims == 1) {
+            data_.insert(data_.end(), first, last);
+            shape_[0] = data_.size();
+        } else {
+            for (; first != last; ++first) push_back(*first);
+        }
+        return this->begin() + old_size;
+    }
+
+    /// Create a view of this tensor.
+    tensor_view<T, NDims> view() { return tensor_view<T, NDims>{*this}; }
+    tensor_view<const T, NDims> view() const { return tensor_view<const T, NDims>{*this}; }
+
+};
+
+/// \ingroup Tensor
+/// \brief Compare the shapes and the elements of two tensors or tensor views.
+template<typename A, typename B,
+         typename = std::enable_if_t<is_tensor<A>{} && is_tensor<B>{}>>
+bool operator==(const A& a, const B& b)
+{
+    return a.shape() == b.shape() && std::equal(a.data(), a.data() + a.numel(), b.data());
+}
+
+/// \ingroup Tensor
+/// \brief Compare the shapes and the elements of two tensors or tensor views.
+template<typename A, typename B,
+         typename = std::enable_if_t<is_tensor<A>{} && is_tensor<B>{}>>
+bool operator!=(const A& a, const B& b)
+{
+    return !(a == b);
+}
+
+}  // namespace cxtream
+#endif
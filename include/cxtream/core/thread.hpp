@@ -11,41 +11,184 @@
 #ifndef CXTREAM_CORE_THREAD_HPP
 #define CXTREAM_CORE_THREAD_HPP
 
-#include <boost/asio.hpp>
+#include <cxtream/core/thread/future.hpp>
+#include <cxtream/core/thread/mpmc_queue.hpp>
+#include <cxtream/core/thread/task.hpp>
+#include <cxtream/core/thread/work_deque.hpp>
+#include <cxtream/core/thread/worker.hpp>
+
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/hana.hpp>
 #include <boost/thread/thread.hpp>
 
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
 #include <functional>
-#include <future>
-#include <experimental/optional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace cxtream {
 
 /// \ingroup Thread
-/// \brief A simple thread pool class.
+/// \brief A work stealing thread pool.
 ///
 /// This class manages the given number of threads across which
-/// it automatically distributes the given tasks.
+/// it automatically distributes the given tasks. The threads are
+/// spawned lazily when the first task is enqueued.
+///
+/// Each worker has its own queue of tasks. The tasks enqueued by a worker
+/// are pushed to its own queue and the worker processes them in LIFO order.
+/// The tasks enqueued by other threads are pushed to a shared bounded lock-free queue.
+/// An idle worker first checks its own queue, then the shared queue, and then
+/// it steals the oldest task from the queues of the other workers.
+///
+/// A task (i.e., the function, its arguments and the promise for its result)
+/// is stored inline in the queue if it is small enough, so that the submission
+/// of a task does not allocate.
+///
+/// A worker waiting for a \ref future (or for a parallel_for() or fork_join())
+/// runs other pending tasks instead of blocking. Hence the tasks may wait
+/// for their subtasks without the risk of a deadlock.
 class thread_pool {
 private:
-    boost::asio::io_service service_;
-    std::experimental::optional<boost::asio::io_service::work> work_{service_};
+    // the capacity of the queue of each worker
+    static constexpr std::size_t worker_queue_size = 256;
+
+    detail::mpmc_queue<detail::small_task> queue_;
+    std::vector<std::unique_ptr<detail::work_deque<detail::small_task>>> worker_queues_;
+    // the number of tasks in all the queues (it is increased before the task is pushed
+    // and decreased after the task is popped, so it never underestimates)
+    std::atomic<long> n_pending_{0};
+    // the number of threads waiting for a task
+    std::atomic<unsigned> n_sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
     boost::thread_group threads_;
+    unsigned n_threads_;
+    // how many times an idle worker looks for a task before going to sleep
+    int n_spins_;
+    std::once_flag start_flag_;
+
+    void start()
+    {
+        std::call_once(start_flag_, [this]() {
+            for (unsigned i = 0; i < n_threads_; ++i) {
+                threads_.create_thread([this, i]() { this->worker_loop(i); });
+            }
+        });
+    }
+
+    // Get the index of the current thread if it is a worker of this pool.
+    bool is_own_worker(unsigned& index) const
+    {
+        const detail::worker_context& context = detail::current_worker();
+        if (context.scheduler != this) return false;
+        index = context.index;
+        return true;
+    }
+
+    bool try_pop(detail::small_task& task)
+    {
+        bool found = false;
+        unsigned index;
+        if (is_own_worker(index)) {
+            // own tasks first, then the shared queue, and then steal from the others
+            found = worker_queues_[index]->try_pop(task) || queue_.try_pop(task);
+            for (unsigned i = 1; i < n_threads_ && !found; ++i) {
+                found = worker_queues_[(index + i) % n_threads_]->try_steal(task);
+            }
+        } else {
+            found = queue_.try_pop(task);
+            for (unsigned i = 0; i < n_threads_ && !found; ++i) {
+                found = worker_queues_[i]->try_steal(task);
+            }
+        }
+        if (found) n_pending_.fetch_sub(1);
+        return found;
+    }
+
+    static bool run_one(void* pool)
+    {
+        detail::small_task task;
+        if (!static_cast<thread_pool*>(pool)->try_pop(task)) return false;
+        task();
+        return true;
+    }
+
+    void push(detail::small_task task)
+    {
+        start();
+        n_pending_.fetch_add(1);
+        unsigned index;
+        if (!is_own_worker(index) || !worker_queues_[index]->try_push(std::move(task))) {
+            while (!queue_.try_push(std::move(task))) {
+                // the queue is full, help with processing the tasks
+                if (!run_one(this)) std::this_thread::yield();
+            }
+        }
+        if (n_sleeping_.load() > 0) {
+            std::lock_guard<std::mutex> lock{sleep_mutex_};
+            sleep_cv_.notify_one();
+        }
+    }
+
+    void worker_loop(unsigned index)
+    {
+        detail::current_worker() = {this, index, &thread_pool::run_one};
+        detail::small_task task;
+        for (;;) {
+            // spin for a while before going to sleep
+            bool found = false;
+            for (int i = 0; i < n_spins_ && !found; ++i) {
+                found = try_pop(task);
+                if (!found) std::this_thread::yield();
+            }
+            if (found) {
+                task();
+                // release the resources held by the task immediately
+                task.reset();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{sleep_mutex_};
+            ++n_sleeping_;
+            sleep_cv_.wait(lock, [this]() { return stop_ || n_pending_.load() > 0; });
+            --n_sleeping_;
+            if (stop_ && n_pending_.load() == 0) return;
+        }
+    }
 
 public:
 
-    /// Spawn the given number of threads and start processing the queue.
+    /// Prepare the given number of threads.
+    ///
+    /// The threads are not spawned until the first task is enqueued.
     ///
     /// \param n_threads The number of threads to be spawned.
-    thread_pool(unsigned n_threads = std::thread::hardware_concurrency())
+    /// \param queue_size The capacity of the shared task queue. If the queue is full,
+    ///                   the thread enqueueing a task helps with processing the queue.
+    thread_pool(unsigned n_threads = std::thread::hardware_concurrency(),
+                std::size_t queue_size = 1024)
+      : queue_{queue_size}
     {
         // always use at least a single thread
-        n_threads = std::max(1u, n_threads);
-        // populate the thread pool
-        for (unsigned i = 0; i < n_threads; ++i) {
-            threads_.create_thread([this]() { return this->service_.run(); });
+        n_threads_ = std::max(1u, n_threads);
+        // spinning only steals time from the other threads on a single core
+        n_spins_ = std::thread::hardware_concurrency() > 1 ? 64 : 1;
+        for (unsigned i = 0; i < n_threads_; ++i) {
+            worker_queues_.push_back(
+              std::make_unique<detail::work_deque<detail::small_task>>(worker_queue_size));
         }
     }
 
@@ -54,31 +197,124 @@ public:
     /// \code
     ///     thread_pool tp{3};
     ///     auto fun = [](int i) { return i + 1; };
-    ///     std::future<int> f1 = tp.enqueue(fun, 10);
-    ///     std::future<int> f2 = tp.enqueue(fun, 11);
+    ///     future<int> f1 = tp.enqueue(fun, 10);
+    ///     future<int> f2 = tp.enqueue(fun, 11);
     ///     assert(f1.get() == 11);
     ///     assert(f2.get() == 12);
     /// \endcode
     ///
     /// \param fun The function to be executed.
     /// \param args Parameters for the function. Note that they are taken by value.
-    /// \returns An std::future corresponding to the result of the function call.
+    /// \returns A \ref future corresponding to the result of the function call.
     template<typename Fun, typename... Args>
-    std::future<std::result_of_t<Fun(Args...)>> enqueue(Fun fun, Args... args)
+    future<std::result_of_t<Fun(Args...)>> enqueue(Fun fun, Args... args)
     {
         using Ret = std::result_of_t<Fun(Args...)>;
-        std::packaged_task<Ret(Args...)> task{fun};
-        std::future<Ret> future = task.get_future();
-        // Packaged task is non-copyable, so ASIO's post() method cannot handle it.
-        // So we build a shared_ptr of the task and post a lambda
-        // dereferencing and running the task stored in the pointer.
-        auto shared_task = std::make_shared<std::packaged_task<Ret(Args...)>>(std::move(task));
-        auto shared_args = std::make_shared<boost::hana::tuple<Args...>>(std::move(args)...);
-        auto asio_task = [task = std::move(shared_task), args = std::move(shared_args)]() {
-            return boost::hana::unpack(std::move(*args), std::move(*task));
+        promise<Ret> task_promise;
+        future<Ret> task_future = task_promise.get_future();
+        // the function, its arguments and the promise are all stored in the task
+        push([fun = std::move(fun),
+              args = boost::hana::make_tuple(std::move(args)...),
+              task_promise = std::move(task_promise)]() mutable {
+            task_promise.set_from([&fun, &args]() -> Ret {
+                return boost::hana::unpack(std::move(args), std::move(fun));
+            });
+        });
+        return task_future;
+    }
+
+    /// Split the range [0, n) to chunks and process them in parallel.
+    ///
+    /// The function is called as `fun(begin, end)` for each chunk. The calling thread
+    /// processes the chunks as well and the function returns when all the chunks are
+    /// finished. The chunks which are not yet taken by the pool are processed by the
+    /// calling thread, so the call never waits for a busy pool, and it can be safely
+    /// nested in other tasks of the pool.
+    ///
+    /// \code
+    ///     std::vector<double> data(1000);
+    ///     global_thread_pool().parallel_for(data.size(), [&data](std::size_t b, std::size_t e) {
+    ///         for (std::size_t i = b; i < e; ++i) data[i] = std::sqrt(i);
+    ///     });
+    /// \endcode
+    ///
+    /// \param n The size of the range.
+    /// \param fun The function to be called for each chunk. It has to be safe
+    ///            to be called from multiple threads at once.
+    /// \param n_chunks The number of chunks. Zero means the number of threads + 1.
+    /// \throws The first exception thrown by the function. All the chunks
+    ///         are finished even if some of them throw.
+    template<typename Fun>
+    void parallel_for(std::size_t n, Fun&& fun, std::size_t n_chunks = 0)
+    {
+        if (n_chunks == 0) n_chunks = n_threads_ + 1;
+        n_chunks = std::min(n_chunks, n);
+        if (n_chunks <= 1) {
+            if (n > 0) fun(std::size_t{0}, n);
+            return;
+        }
+
+        // the state is shared with the pool tasks, because the tasks
+        // which were already claimed by the caller may run after this function returns
+        struct state_t {
+            std::unique_ptr<std::atomic<bool>[]> claimed;
+            std::mutex mutex;
+            std::condition_variable done_cv;
+            std::size_t n_done = 0;
+            std::exception_ptr error;
         };
-        service_.post(std::move(asio_task));
-        return future;
+        auto state = std::make_shared<state_t>();
+        state->claimed.reset(new std::atomic<bool>[n_chunks]());
+
+        auto process_chunk = [n, n_chunks, &fun](state_t& state, std::size_t c) {
+            if (state.claimed[c].exchange(true)) return;
+            std::exception_ptr error;
+            try {
+                fun(c * n / n_chunks, (c + 1) * n / n_chunks);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock{state.mutex};
+            if (error && !state.error) state.error = error;
+            if (++state.n_done == n_chunks) state.done_cv.notify_all();
+        };
+
+        // the chunk function is only dereferenced by the tasks which claim a chunk,
+        // and all the claimed chunks are finished before this function returns
+        for (std::size_t c = 1; c < n_chunks; ++c) {
+            push([process_chunk, state, c]() { process_chunk(*state, c); });
+        }
+        for (std::size_t c = 0; c < n_chunks; ++c) process_chunk(*state, c);
+
+        std::unique_lock<std::mutex> lock{state->mutex};
+        detail::wait_helping(lock, state->done_cv,
+                             [&state, n_chunks]() { return state->n_done == n_chunks; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+
+    /// Run the given functions in parallel and wait until all of them are finished.
+    ///
+    /// \code
+    ///     int a, b;
+    ///     global_thread_pool().fork_join([&a]() { a = 1; }, [&b]() { b = 2; });
+    /// \endcode
+    ///
+    /// \throws The first exception thrown by the functions.
+    template<typename... Funs>
+    void fork_join(Funs&&... funs)
+    {
+        std::tuple<Funs&...> fun_refs{funs...};
+        parallel_for(sizeof...(Funs), [&fun_refs](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                run_ith(fun_refs, i, std::index_sequence_for<Funs...>{});
+            }
+        }, sizeof...(Funs));
+    }
+
+    /// Get the number of threads in the pool.
+    unsigned n_threads() const
+    {
+        return n_threads_;
     }
 
     /// Thread pool destructor.
@@ -86,16 +322,94 @@ public:
     /// The destructor blocks until all the enqueued tasks are finished.
     ~thread_pool()
     {
-        work_ = std::experimental::nullopt;
+        {
+            std::lock_guard<std::mutex> lock{sleep_mutex_};
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
         threads_.join_all();
     }
+
+private:
+    template<typename Tuple, std::size_t... Is>
+    static void run_ith(Tuple& funs, std::size_t i, std::index_sequence<Is...>)
+    {
+        (..., (i == Is ? (void)std::get<Is>(funs)() : (void)0));
+    }
 };
 
+namespace detail {
+
+    // The requested size of the global thread pool (zero means default).
+    inline std::atomic<unsigned> global_thread_pool_size{0};
+    // Whether the global thread pool has already been constructed.
+    inline std::atomic<bool> global_thread_pool_created{false};
+    inline std::mutex global_thread_pool_mutex;
+
+    // Deduce the size of the global thread pool.
+    //
+    // The size set by set_global_thread_pool_size() has the highest priority,
+    // then the CXTREAM_NUM_THREADS environment variable, and then the hardware concurrency.
+    // The environment variable is ignored if it is not a positive number of at most
+    // 256 threads per core (std::stoul would silently wrap negative numbers).
+    inline unsigned deduce_global_thread_pool_size()
+    {
+        if (global_thread_pool_size > 0) return global_thread_pool_size;
+        unsigned hardware_threads = std::thread::hardware_concurrency();
+        if (const char* env = std::getenv("CXTREAM_NUM_THREADS")) {
+            unsigned long max_threads = 256UL * std::max(hardware_threads, 1U);
+            std::string value{env};
+            boost::trim(value);
+            bool digits_only = std::all_of(value.begin(), value.end(), [](char c) {
+                return std::isdigit(static_cast<unsigned char>(c));
+            });
+            try {
+                unsigned long n_threads = std::stoul(value);
+                if (digits_only && n_threads > 0 && n_threads <= max_threads) return n_threads;
+            } catch (const std::logic_error&) {
+                // ignore invalid values
+            }
+        }
+        return hardware_threads;
+    }
+
+}  // namespace detail
+
+/// \ingroup Thread
+/// \brief Set the number of threads of the global thread pool.
+///
+/// This function has to be called before the global thread pool is first used.
+/// The size can be also set by `CXTREAM_NUM_THREADS` environment variable. If neither
+/// is provided, `std::thread::hardware_concurrency()` is used.
+///
+/// \throws std::logic_error If the global thread pool has already been constructed.
+inline void set_global_thread_pool_size(unsigned n_threads)
+{
+    std::lock_guard<std::mutex> lock{detail::global_thread_pool_mutex};
+    if (detail::global_thread_pool_created) {
+        throw std::logic_error{"The global thread pool size cannot be changed after "
+                               "the pool has been constructed."};
+    }
+    detail::global_thread_pool_size = n_threads;
+}
+
 /// \ingroup Thread
-/// \brief Global thread pool object.
+/// \brief Get the global thread pool object.
+///
+/// There is a single global thread pool for the whole process. It is constructed
+/// on the first call of this function and its threads are spawned when the first
+/// task is enqueued.
 ///
 /// Prefer to use this object instead of spawning a new thread pool.
-static thread_pool global_thread_pool;
+inline thread_pool& global_thread_pool()
+{
+    static thread_pool pool{[]() {
+        std::lock_guard<std::mutex> lock{detail::global_thread_pool_mutex};
+        detail::global_thread_pool_created = true;
+        return detail::deduce_global_thread_pool_size();
+    }()};
+    return pool;
+}
 
 } // namespace cxtream
 #endif
@@ -0,0 +1,422 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_FUTURE_HPP
+#define CXTREAM_CORE_THREAD_FUTURE_HPP
+
+#include <cxtream/core/thread/mpmc_queue.hpp>
+#include <cxtream/core/thread/worker.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <experimental/optional>
+#include <future>
+#include <mutex>
+#include <utility>
+
+namespace cxtream {
+
+namespace detail {
+
+    // The storage of the result of an asynchronous operation.
+    template<typename T>
+    struct future_result {
+        std::experimental::optional<T> value;
+
+        template<typename... Args>
+        void emplace(Args&&... args)
+        {
+            value.emplace(std::forward<Args>(args)...);
+        }
+
+        T take() { return std::move(*value); }
+        const T& get() const { return *value; }
+        void reset() { value = std::experimental::nullopt; }
+    };
+
+    // References are stored as pointers, since an optional cannot hold a reference.
+    template<typename T>
+    struct future_result<T&> {
+        T* value = nullptr;
+
+        void emplace(T& ref) { value = &ref; }
+        T& take() { return *value; }
+        T& get() const { return *value; }
+        void reset() { value = nullptr; }
+    };
+
+    template<>
+    struct future_result<void> {
+        void emplace() {}
+        void take() {}
+        void get() const {}
+        void reset() {}
+    };
+
+    // The state shared by a promise and its futures.
+    //
+    // The states are reference counted and recycled by future_state_cache,
+    // so that a promise/future pair does not allocate in the steady state.
+    template<typename T>
+    struct future_state {
+        std::atomic<int> refs{0};
+        std::atomic<bool> ready{false};
+        // the number of threads blocked in wait()
+        std::atomic<int> n_waiters{0};
+        std::mutex mutex;
+        std::condition_variable ready_cv;
+        future_result<T> result;
+        std::exception_ptr error;
+
+        void wait()
+        {
+            if (ready.load(std::memory_order_acquire)) return;
+            // a worker thread runs other tasks instead of blocking, so that a task
+            // waiting for its subtasks cannot deadlock the scheduler
+            if (current_worker().scheduler) {
+                while (!ready.load(std::memory_order_acquire)) {
+                    if (!help_one()) wait_for(std::chrono::microseconds{100});
+                }
+                return;
+            }
+            std::unique_lock<std::mutex> lock{mutex};
+            ++n_waiters;
+            ready_cv.wait(lock, [this]() { return ready.load(); });
+            --n_waiters;
+        }
+
+        template<typename Rep, typename Period>
+        std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout)
+        {
+            if (ready.load(std::memory_order_acquire)) return std::future_status::ready;
+            std::unique_lock<std::mutex> lock{mutex};
+            ++n_waiters;
+            bool is_ready = ready_cv.wait_for(lock, timeout, [this]() { return ready.load(); });
+            --n_waiters;
+            return is_ready ? std::future_status::ready : std::future_status::timeout;
+        }
+
+        void make_ready()
+        {
+            ready.store(true);
+            // only lock the mutex if there is somebody to wake up
+            if (n_waiters.load() > 0) {
+                { std::lock_guard<std::mutex> lock{mutex}; }
+                ready_cv.notify_all();
+            }
+        }
+
+        void reset()
+        {
+            ready.store(false, std::memory_order_relaxed);
+            result.reset();
+            error = nullptr;
+        }
+    };
+
+    // Process-wide cache of unused future states.
+    //
+    // The cache is a lock-free queue, so a state released by a worker thread
+    // can be reused by the thread enqueueing the tasks. The cache is intentionally
+    // never destroyed, because the states may be released by threads
+    // which outlive the static objects (e.g., the threads of the global thread pool).
+    template<typename T>
+    class future_state_cache {
+    private:
+        static constexpr std::size_t max_size = 1024;
+
+        static mpmc_queue<future_state<T>*>& states()
+        {
+            static auto* states = new mpmc_queue<future_state<T>*>{max_size};
+            return *states;
+        }
+
+    public:
+        static future_state<T>* acquire()
+        {
+            future_state<T>* state;
+            if (states().try_pop(state)) return state;
+            return new future_state<T>;
+        }
+
+        static void release(future_state<T>* state)
+        {
+            state->reset();
+            if (!states().try_push(std::move(state))) delete state;
+        }
+    };
+
+    // Intrusive reference counted pointer to a future state.
+    template<typename T>
+    class future_state_ptr {
+    private:
+        future_state<T>* state_ = nullptr;
+
+    public:
+        future_state_ptr() = default;
+
+        explicit future_state_ptr(future_state<T>* state) noexcept
+          : state_{state}
+        {
+            if (state_) state_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        future_state_ptr(const future_state_ptr& rhs) noexcept
+          : future_state_ptr{rhs.state_}
+        {}
+
+        future_state_ptr(future_state_ptr&& rhs) noexcept
+          : state_{std::exchange(rhs.state_, nullptr)}
+        {}
+
+        future_state_ptr& operator=(future_state_ptr rhs) noexcept
+        {
+            std::swap(state_, rhs.state_);
+            return *this;
+        }
+
+        ~future_state_ptr()
+        {
+            reset();
+        }
+
+        void reset() noexcept
+        {
+            if (state_ && state_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                future_state_cache<T>::release(state_);
+            }
+            state_ = nullptr;
+        }
+
+        future_state<T>* operator->() const noexcept { return state_; }
+        future_state<T>& operator*() const noexcept { return *state_; }
+        explicit operator bool() const noexcept { return state_ != nullptr; }
+    };
+
+}  // namespace detail
+
+template<typename T>
+class shared_future;
+
+/// \ingroup Thread
+/// \brief The result of an asynchronous operation, e.g., of thread_pool::enqueue().
+///
+/// The interface follows std::future, but the shared state is recycled
+/// and therefore the future does not allocate in the steady state.
+/// When the result is waited for by a worker thread of a \ref thread_pool, the
+/// worker runs other pending tasks instead of blocking.
+template<typename T>
+class future {
+private:
+    detail::future_state_ptr<T> state_;
+
+    template<typename>
+    friend class promise;
+
+    explicit future(detail::future_state_ptr<T> state)
+      : state_{std::move(state)}
+    {}
+
+public:
+    future() = default;
+    future(future&&) = default;
+    future& operator=(future&&) = default;
+
+    /// Wait for the result and return it.
+    ///
+    /// The future is invalid after this call.
+    ///
+    /// \throws Any exception thrown by the asynchronous operation.
+    T get()
+    {
+        detail::future_state_ptr<T> state = std::move(state_);
+        state->wait();
+        if (state->error) std::rethrow_exception(state->error);
+        return state->result.take();
+    }
+
+    /// Check whether the future refers to a shared state.
+    bool valid() const noexcept
+    {
+        return static_cast<bool>(state_);
+    }
+
+    /// Check whether the result is available.
+    bool is_ready() const
+    {
+        return state_->ready.load(std::memory_order_acquire);
+    }
+
+    /// Block until the result is available.
+    void wait() const
+    {
+        state_->wait();
+    }
+
+    /// Block until the result is available or the timeout expires.
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return state_->wait_for(timeout);
+    }
+
+    /// Transfer the shared state to a shared_future.
+    shared_future<T> share() noexcept
+    {
+        return shared_future<T>{std::move(state_)};
+    }
+};
+
+/// \ingroup Thread
+/// \brief Copyable version of \ref future. The result can be read multiple times.
+template<typename T>
+class shared_future {
+private:
+    detail::future_state_ptr<T> state_;
+
+    friend class future<T>;
+
+    explicit shared_future(detail::future_state_ptr<T> state)
+      : state_{std::move(state)}
+    {}
+
+public:
+    shared_future() = default;
+
+    /// Wait for the result and return a reference to it.
+    ///
+    /// \throws Any exception thrown by the asynchronous operation.
+    decltype(auto) get() const
+    {
+        state_->wait();
+        if (state_->error) std::rethrow_exception(state_->error);
+        return state_->result.get();
+    }
+
+    /// Check whether the future refers to a shared state.
+    bool valid() const noexcept
+    {
+        return static_cast<bool>(state_);
+    }
+
+    /// Check whether the result is available.
+    bool is_ready() const
+    {
+        return state_->ready.load(std::memory_order_acquire);
+    }
+
+    /// Block until the result is available.
+    void wait() const
+    {
+        state_->wait();
+    }
+
+    /// Block until the result is available or the timeout expires.
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return state_->wait_for(timeout);
+    }
+};
+
+/// \ingroup Thread
+/// \brief The producer side of a \ref future.
+///
+/// If the promise is destroyed without providing a value, the future
+/// receives std::future_error with std::future_errc::broken_promise.
+template<typename T>
+class promise {
+private:
+    detail::future_state_ptr<T> state_;
+    bool retrieved_ = false;
+
+    void satisfy()
+    {
+        detail::future_state_ptr<T> state = std::move(state_);
+        state->make_ready();
+    }
+
+public:
+    promise()
+      : state_{detail::future_state_cache<T>::acquire()}
+    {}
+
+    promise(promise&&) = default;
+
+    promise& operator=(promise&& rhs) noexcept
+    {
+        abandon();
+        state_ = std::move(rhs.state_);
+        retrieved_ = rhs.retrieved_;
+        return *this;
+    }
+
+    ~promise()
+    {
+        abandon();
+    }
+
+    /// Get the future associated with this promise. Can be called only once.
+    ///
+    /// \throws std::future_error With std::future_errc::no_state if the promise has been
+    ///         moved from or satisfied, or with std::future_errc::future_already_retrieved
+    ///         if the future has already been retrieved.
+    future<T> get_future()
+    {
+        if (!state_) throw std::future_error{std::future_errc::no_state};
+        if (retrieved_) throw std::future_error{std::future_errc::future_already_retrieved};
+        retrieved_ = true;
+        return future<T>{state_};
+    }
+
+    /// Store the value and make the future ready.
+    template<typename... Args>
+    void set_value(Args&&... args)
+    {
+        state_->result.emplace(std::forward<Args>(args)...);
+        satisfy();
+    }
+
+    /// Store the exception and make the future ready.
+    void set_exception(std::exception_ptr error)
+    {
+        state_->error = std::move(error);
+        satisfy();
+    }
+
+    /// Store the result of the given function or the exception thrown by it.
+    template<typename Fun>
+    void set_from(Fun&& fun)
+    {
+        try {
+            if constexpr (std::is_void<T>{}) {
+                std::forward<Fun>(fun)();
+                set_value();
+            } else {
+                set_value(std::forward<Fun>(fun)());
+            }
+        } catch (...) {
+            set_exception(std::current_exception());
+        }
+    }
+
+private:
+    void abandon()
+    {
+        if (state_ && !state_->ready.load(std::memory_order_relaxed)) {
+            set_exception(std::make_exception_ptr(
+              std::future_error{std::future_errc::broken_promise}));
+        }
+    }
+};
+
+}  // namespace cxtream
+#endif
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_MPMC_QUEUE_HPP
+#define CXTREAM_CORE_THREAD_MPMC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cxtream::detail {
+
+/// \ingroup Thread
+/// \brief Bounded lock-free multi-producer multi-consumer queue.
+///
+/// This is the array based queue by Dmitry Vyukov. Each cell carries a sequence
+/// number which tells the producers and the consumers whether the cell is ready to be
+/// written or read. The push and pop operations only need a single CAS on the shared
+/// position and they never allocate.
+///
+/// \code
+///     mpmc_queue<int> queue{4};
+///     queue.try_push(1);
+///     int val;
+///     assert(queue.try_pop(val) && val == 1);
+/// \endcode
+template<typename T>
+class mpmc_queue {
+private:
+    static constexpr std::size_t cache_line = 64;
+
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+    };
+
+    std::unique_ptr<cell[]> cells_;
+    std::size_t mask_;
+    alignas(cache_line) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(cache_line) std::atomic<std::size_t> dequeue_pos_{0};
+
+    static T& value(cell& c)
+    {
+        return *std::launder(reinterpret_cast<T*>(&c.storage));
+    }
+
+public:
+    /// Create the queue with the given capacity.
+    ///
+    /// \param capacity The capacity, which is rounded up to the next power of two.
+    explicit mpmc_queue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size *= 2;
+        cells_.reset(new cell[size]);
+        mask_ = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    /// Destroy the elements which were not popped.
+    ~mpmc_queue()
+    {
+        std::size_t end = enqueue_pos_.load(std::memory_order_relaxed);
+        for (std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != end; ++pos) {
+            value(cells_[pos & mask_]).~T();
+        }
+    }
+
+    /// Try to push an element to the queue.
+    ///
+    /// \param val The element to be pushed. It is moved from only if the push succeeds.
+    /// \returns False if the queue is full.
+    bool try_push(T&& val)
+    {
+        cell* c;
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(&c->storage)) T(std::move(val));
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Try to pop an element from the queue.
+    ///
+    /// \param val The location where the popped element is moved.
+    /// \returns False if the queue is empty.
+    bool try_pop(T& val)
+    {
+        cell* c;
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        val = std::move(value(*c));
+        value(*c).~T();
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// The number of elements the queue can hold.
+    std::size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+};
+
+}  // namespace cxtream::detail
+#endif
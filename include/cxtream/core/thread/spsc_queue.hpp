@@ -0,0 +1,128 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_SPSC_QUEUE_HPP
+#define CXTREAM_CORE_THREAD_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cxtream::detail {
+
+/// \ingroup Thread
+/// \brief Bounded lock-free single-producer single-consumer ring buffer.
+///
+/// Only a single thread may push and only a single thread may pop. Each side
+/// owns its position and keeps a cached copy of the position of the other side,
+/// so the shared positions are only read when the cached copy says that
+/// the queue is full or empty.
+///
+/// \code
+///     spsc_queue<int> queue{4};
+///     queue.try_push(1);
+///     int val;
+///     assert(queue.try_pop(val) && val == 1);
+/// \endcode
+template<typename T>
+class spsc_queue {
+private:
+    static constexpr std::size_t cache_line = 64;
+
+    using storage_t = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    std::unique_ptr<storage_t[]> storage_;
+    std::size_t mask_;
+    // the producer side
+    alignas(cache_line) std::atomic<std::size_t> push_pos_{0};
+    std::size_t cached_pop_pos_ = 0;
+    // the consumer side
+    alignas(cache_line) std::atomic<std::size_t> pop_pos_{0};
+    std::size_t cached_push_pos_ = 0;
+
+    T& value(std::size_t pos)
+    {
+        return *std::launder(reinterpret_cast<T*>(&storage_[pos & mask_]));
+    }
+
+public:
+    /// Create the queue with the given capacity.
+    ///
+    /// \param capacity The capacity, which is rounded up to the next power of two.
+    explicit spsc_queue(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity) size *= 2;
+        storage_.reset(new storage_t[size]);
+        mask_ = size - 1;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    /// Destroy the elements which were not popped.
+    ~spsc_queue()
+    {
+        std::size_t end = push_pos_.load(std::memory_order_relaxed);
+        for (std::size_t pos = pop_pos_.load(std::memory_order_relaxed); pos != end; ++pos) {
+            value(pos).~T();
+        }
+    }
+
+    /// Try to push an element to the queue. May only be called by the producer.
+    ///
+    /// \param val The element to be pushed. It is moved from only if the push succeeds.
+    /// \returns False if the queue is full.
+    bool try_push(T&& val)
+    {
+        std::size_t pos = push_pos_.load(std::memory_order_relaxed);
+        if (pos - cached_pop_pos_ > mask_) {
+            cached_pop_pos_ = pop_pos_.load(std::memory_order_acquire);
+            if (pos - cached_pop_pos_ > mask_) return false;
+        }
+        ::new (static_cast<void*>(&storage_[pos & mask_])) T(std::move(val));
+        push_pos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Try to pop an element from the queue. May only be called by the consumer.
+    ///
+    /// \param val The location where the popped element is moved.
+    /// \returns False if the queue is empty.
+    bool try_pop(T& val)
+    {
+        std::size_t pos = pop_pos_.load(std::memory_order_relaxed);
+        if (pos == cached_push_pos_) {
+            cached_push_pos_ = push_pos_.load(std::memory_order_acquire);
+            if (pos == cached_push_pos_) return false;
+        }
+        val = std::move(value(pos));
+        value(pos).~T();
+        pop_pos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Check whether the queue is empty. May only be called by the consumer.
+    bool empty() const
+    {
+        return pop_pos_.load(std::memory_order_relaxed) == push_pos_.load(std::memory_order_acquire);
+    }
+
+    /// The number of elements the queue can hold.
+    std::size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+};
+
+}  // namespace cxtream::detail
+#endif
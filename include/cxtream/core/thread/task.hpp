@@ -0,0 +1,177 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_TASK_HPP
+#define CXTREAM_CORE_THREAD_TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cxtream::detail {
+
+/// \ingroup Thread
+/// \brief Move-only type-erased nullary function with a small buffer optimization.
+///
+/// Functions which fit into small_task::inline_size bytes and which are nothrow
+/// move constructible are stored inline. Larger functions are stored on the heap.
+///
+/// \code
+///     int i = 0;
+///     small_task task{[&i, ptr = std::make_unique<int>(5)]() { i = *ptr; }};
+///     small_task task2 = std::move(task);
+///     task2();
+///     assert(i == 5);
+/// \endcode
+class small_task {
+public:
+    /// The maximum size of a function stored without heap allocation.
+    static constexpr std::size_t inline_size = 112;
+
+private:
+    struct vtable_t {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename Fun>
+    static constexpr bool fits_inline =
+      sizeof(Fun) <= inline_size
+      && alignof(Fun) <= alignof(std::max_align_t)
+      && std::is_nothrow_move_constructible<Fun>{};
+
+    // the function is stored directly in the storage
+    template<typename Fun>
+    struct inline_impl {
+        static Fun& get(void* storage)
+        {
+            return *std::launder(reinterpret_cast<Fun*>(storage));
+        }
+
+        static void invoke(void* storage)
+        {
+            get(storage)();
+        }
+
+        static void move(void* from, void* to) noexcept
+        {
+            ::new (to) Fun(std::move(get(from)));
+            get(from).~Fun();
+        }
+
+        static void destroy(void* storage) noexcept
+        {
+            get(storage).~Fun();
+        }
+
+        static constexpr vtable_t vtable{invoke, move, destroy};
+    };
+
+    // the storage only contains a pointer to the function
+    template<typename Fun>
+    struct heap_impl {
+        static Fun*& get(void* storage)
+        {
+            return *std::launder(reinterpret_cast<Fun**>(storage));
+        }
+
+        static void invoke(void* storage)
+        {
+            (*get(storage))();
+        }
+
+        static void move(void* from, void* to) noexcept
+        {
+            ::new (to) Fun*{get(from)};
+        }
+
+        static void destroy(void* storage) noexcept
+        {
+            delete get(storage);
+        }
+
+        static constexpr vtable_t vtable{invoke, move, destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[inline_size];
+    const vtable_t* vtable_ = nullptr;
+
+public:
+    small_task() = default;
+
+    template<typename Fun,
+             typename = std::enable_if_t<!std::is_same<std::decay_t<Fun>, small_task>{}>>
+    small_task(Fun&& fun)
+    {
+        using FunT = std::decay_t<Fun>;
+        if constexpr (fits_inline<FunT>) {
+            ::new (static_cast<void*>(storage_)) FunT(std::forward<Fun>(fun));
+            vtable_ = &inline_impl<FunT>::vtable;
+        } else {
+            ::new (static_cast<void*>(storage_)) FunT*{new FunT(std::forward<Fun>(fun))};
+            vtable_ = &heap_impl<FunT>::vtable;
+        }
+    }
+
+    small_task(small_task&& rhs) noexcept
+      : vtable_{rhs.vtable_}
+    {
+        if (vtable_) {
+            vtable_->move(rhs.storage_, storage_);
+            rhs.vtable_ = nullptr;
+        }
+    }
+
+    small_task& operator=(small_task&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            reset();
+            if (rhs.vtable_) {
+                vtable_ = rhs.vtable_;
+                vtable_->move(rhs.storage_, storage_);
+                rhs.vtable_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    small_task(const small_task&) = delete;
+    small_task& operator=(const small_task&) = delete;
+
+    ~small_task()
+    {
+        reset();
+    }
+
+    /// Destroy the stored function.
+    void reset() noexcept
+    {
+        if (vtable_) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    /// Check whether there is a function stored.
+    explicit operator bool() const noexcept
+    {
+        return vtable_ != nullptr;
+    }
+
+    /// Call the stored function.
+    void operator()()
+    {
+        vtable_->invoke(storage_);
+    }
+};
+
+}  // namespace cxtream::detail
+#endif
@@ -0,0 +1,104 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_WORK_DEQUE_HPP
+#define CXTREAM_CORE_THREAD_WORK_DEQUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cxtream::detail {
+
+/// \ingroup Thread
+/// \brief Bounded double-ended queue of a single worker of a work stealing scheduler.
+///
+/// The owner pushes and pops the tasks at the back (LIFO), so that it works on
+/// the most recent and cache-hot tasks. The other workers steal the oldest tasks
+/// from the front (FIFO). The queue is a ring buffer protected by a mutex,
+/// which is almost never contended, because each worker has its own queue.
+/// The empty queue can be checked without locking, so idle thieves do not
+/// disturb the owner.
+///
+/// \code
+///     work_deque<int> deque{4};
+///     deque.try_push(1);
+///     deque.try_push(2);
+///     int val;
+///     assert(deque.try_steal(val) && val == 1);
+///     assert(deque.try_pop(val) && val == 2);
+/// \endcode
+template<typename T>
+class work_deque {
+private:
+    std::mutex mutex_;
+    std::vector<T> ring_;
+    std::size_t head_ = 0;
+    std::atomic<std::size_t> size_{0};
+
+public:
+    /// Create the queue with the given capacity.
+    explicit work_deque(std::size_t capacity)
+      : ring_(std::max<std::size_t>(1, capacity))
+    {}
+
+    /// Push the value to the back of the queue.
+    ///
+    /// \returns False if the queue is full. In such a case, the value is not moved from.
+    bool try_push(T&& value)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        std::size_t size = size_.load(std::memory_order_relaxed);
+        if (size == ring_.size()) return false;
+        ring_[(head_ + size) % ring_.size()] = std::move(value);
+        size_.store(size + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop the most recently pushed value.
+    ///
+    /// \returns False if the queue is empty.
+    bool try_pop(T& value)
+    {
+        if (size_.load(std::memory_order_acquire) == 0) return false;
+        std::lock_guard<std::mutex> lock{mutex_};
+        std::size_t size = size_.load(std::memory_order_relaxed);
+        if (size == 0) return false;
+        value = std::move(ring_[(head_ + size - 1) % ring_.size()]);
+        size_.store(size - 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pop the oldest value.
+    ///
+    /// \returns False if the queue is empty.
+    bool try_steal(T& value)
+    {
+        if (size_.load(std::memory_order_acquire) == 0) return false;
+        std::lock_guard<std::mutex> lock{mutex_};
+        std::size_t size = size_.load(std::memory_order_relaxed);
+        if (size == 0) return false;
+        value = std::move(ring_[head_]);
+        head_ = (head_ + 1) % ring_.size();
+        size_.store(size - 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Get the number of values in the queue.
+    std::size_t size() const
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+};
+
+}  // namespace cxtream::detail
+#endif
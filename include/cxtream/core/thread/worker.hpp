@@ -0,0 +1,66 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef CXTREAM_CORE_THREAD_WORKER_HPP
+#define CXTREAM_CORE_THREAD_WORKER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace cxtream::detail {
+
+    // Description of the scheduler the current thread works for.
+    //
+    // It is used by the blocking operations (e.g., future::get()) to run
+    // other tasks while waiting, instead of parking the worker thread.
+    struct worker_context {
+        // the scheduler, or nullptr if the current thread is not a worker
+        void* scheduler = nullptr;
+        // the index of the current thread in the scheduler
+        unsigned index = 0;
+        // run a single pending task of the scheduler, returns false if there was none
+        bool (*run_one)(void* scheduler) = nullptr;
+    };
+
+    inline worker_context& current_worker()
+    {
+        static thread_local worker_context context;
+        return context;
+    }
+
+    // Run a single pending task if the current thread is a worker.
+    //
+    // Returns false if the current thread is not a worker or if there was no task to run.
+    inline bool help_one()
+    {
+        worker_context& context = current_worker();
+        return context.scheduler && context.run_one(context.scheduler);
+    }
+
+    // Wait on the condition variable until the predicate is satisfied.
+    //
+    // If the current thread is a worker, it runs other pending tasks in the meantime.
+    template<typename Pred>
+    void wait_helping(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, Pred pred)
+    {
+        if (!current_worker().scheduler) {
+            cv.wait(lock, pred);
+            return;
+        }
+        while (!pred()) {
+            lock.unlock();
+            bool helped = help_one();
+            lock.lock();
+            if (!helped) cv.wait_for(lock, std::chrono::microseconds{100}, pred);
+        }
+    }
+
+}  // namespace cxtream::detail
+#endif
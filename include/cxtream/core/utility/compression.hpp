@@ -0,0 +1,596 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+/// \defgroup Compression Decompression of gzip and zstd data.
+
+#ifndef CXTREAM_CORE_UTILITY_COMPRESSION_HPP
+#define CXTREAM_CORE_UTILITY_COMPRESSION_HPP
+
+#include <cxtream/build_config.hpp>
+#include <cxtream/core/thread.hpp>
+
+#ifdef CXTREAM_BUILD_GZIP
+#include <zlib.h>
+#endif
+#ifdef CXTREAM_BUILD_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace cxtream::utility {
+
+/// \ingroup Compression
+/// \brief The supported compression formats.
+enum class compression {
+    none,
+    gzip,
+    zstd
+};
+
+/// \ingroup Compression
+/// \brief Detect the compression format of the data from its magic number.
+///
+/// Both plain gzip (including multi-member files and bgzip) and zstd (including
+/// multi-frame files) are recognized. Anything else is considered uncompressed.
+inline compression detect_compression(std::string_view data)
+{
+    if (data.substr(0, 2) == std::string_view{"\x1f\x8b", 2}) return compression::gzip;
+    if (data.substr(0, 4) == std::string_view{"\x28\xb5\x2f\xfd", 4}) return compression::zstd;
+    return compression::none;
+}
+
+namespace detail {
+
+    [[noreturn]] inline void throw_decompression_failure(const std::string& msg)
+    {
+        throw std::ios_base::failure{"Cannot decompress data: " + msg + "."};
+    }
+
+    // Incremental decoder of a compressed stream.
+    class decoder {
+    public:
+        virtual ~decoder() = default;
+
+        // Decode as much of the input as fits to the output.
+        // Returns the number of consumed and produced bytes, both of them are
+        // zero if the decoder cannot make any progress (e.g., the input is empty).
+        virtual std::pair<std::size_t, std::size_t>
+        decode(const char* in, std::size_t in_size, char* out, std::size_t out_size) = 0;
+
+        // Whether the decoder is at the end of a gzip member or a zstd frame,
+        // i.e., whether the input can validly end here.
+        virtual bool at_boundary() const = 0;
+    };
+
+    // Decoder of uncompressed data (i.e., a copy).
+    class copy_decoder : public decoder {
+    public:
+        std::pair<std::size_t, std::size_t>
+        decode(const char* in, std::size_t in_size, char* out, std::size_t out_size) override
+        {
+            std::size_t n = std::min(in_size, out_size);
+            std::copy(in, in + n, out);
+            return {n, n};
+        }
+
+        bool at_boundary() const override
+        {
+            return true;
+        }
+    };
+
+#ifdef CXTREAM_BUILD_GZIP
+    // Decoder of (possibly concatenated) gzip members.
+    class gzip_decoder : public decoder {
+    private:
+        z_stream stream_{};
+        bool at_boundary_ = true;
+
+    public:
+        gzip_decoder()
+        {
+            // detect the gzip header automatically
+            if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+                throw_decompression_failure("zlib initialization failed");
+            }
+        }
+
+        gzip_decoder(const gzip_decoder&) = delete;
+        gzip_decoder& operator=(const gzip_decoder&) = delete;
+
+        ~gzip_decoder() override
+        {
+            inflateEnd(&stream_);
+        }
+
+        std::pair<std::size_t, std::size_t>
+        decode(const char* in, std::size_t in_size, char* out, std::size_t out_size) override
+        {
+            // zlib uses 32-bit sizes
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+            stream_.avail_in = static_cast<uInt>(std::min<std::size_t>(in_size, 1U << 30));
+            stream_.next_out = reinterpret_cast<Bytef*>(out);
+            stream_.avail_out = static_cast<uInt>(std::min<std::size_t>(out_size, 1U << 30));
+            int status = inflate(&stream_, Z_NO_FLUSH);
+            std::size_t consumed = reinterpret_cast<const char*>(stream_.next_in) - in;
+            std::size_t produced = reinterpret_cast<char*>(stream_.next_out) - out;
+            if (status == Z_STREAM_END) {
+                // the next member (if any) starts with a new header
+                inflateReset(&stream_);
+                at_boundary_ = true;
+            } else if (status == Z_OK || status == Z_BUF_ERROR) {
+                // Z_BUF_ERROR is not fatal, it only means that no progress was possible
+                if (consumed + produced > 0) at_boundary_ = false;
+            } else {
+                throw_decompression_failure(std::string{"invalid gzip data ("}
+                                            + (stream_.msg ? stream_.msg : "zlib error") + ")");
+            }
+            return {consumed, produced};
+        }
+
+        bool at_boundary() const override
+        {
+            return at_boundary_;
+        }
+    };
+#endif
+
+#ifdef CXTREAM_BUILD_ZSTD
+    // Decoder of (possibly multiple) zstd frames.
+    class zstd_decoder : public decoder {
+    private:
+        ZSTD_DStream* stream_;
+        bool at_boundary_ = true;
+
+    public:
+        zstd_decoder()
+          : stream_{ZSTD_createDStream()}
+        {
+            if (!stream_ || ZSTD_isError(ZSTD_initDStream(stream_))) {
+                ZSTD_freeDStream(stream_);
+                throw_decompression_failure("zstd initialization failed");
+            }
+        }
+
+        zstd_decoder(const zstd_decoder&) = delete;
+        zstd_decoder& operator=(const zstd_decoder&) = delete;
+
+        ~zstd_decoder() override
+        {
+            ZSTD_freeDStream(stream_);
+        }
+
+        std::pair<std::size_t, std::size_t>
+        decode(const char* in, std::size_t in_size, char* out, std::size_t out_size) override
+        {
+            ZSTD_inBuffer input{in, in_size, 0};
+            ZSTD_outBuffer output{out, out_size, 0};
+            std::size_t status = ZSTD_decompressStream(stream_, &output, &input);
+            if (ZSTD_isError(status)) {
+                throw_decompression_failure(std::string{"invalid zstd data ("}
+                                            + ZSTD_getErrorName(status) + ")");
+            }
+            // zero means that a frame is completely decoded and flushed
+            if (input.pos + output.pos > 0) at_boundary_ = status == 0;
+            return {input.pos, output.pos};
+        }
+
+        bool at_boundary() const override
+        {
+            return at_boundary_;
+        }
+    };
+#endif
+
+    // Create a decoder for the given compression format.
+    inline std::unique_ptr<decoder> make_decoder(compression format)
+    {
+        switch (format) {
+        case compression::gzip:
+#ifdef CXTREAM_BUILD_GZIP
+            return std::make_unique<gzip_decoder>();
+#else
+            throw_decompression_failure("cxtream was built without gzip support (BUILD_GZIP)");
+#endif
+        case compression::zstd:
+#ifdef CXTREAM_BUILD_ZSTD
+            return std::make_unique<zstd_decoder>();
+#else
+            throw_decompression_failure("cxtream was built without zstd support (BUILD_ZSTD)");
+#endif
+        default:
+            return std::make_unique<copy_decoder>();
+        }
+    }
+
+    // Decode the whole input to a string.
+    inline std::string decode_all(decoder& dec, std::string_view data)
+    {
+        std::string result;
+        result.resize(std::max<std::size_t>(4 * data.size(), 1 << 16));
+        std::size_t in_pos = 0;
+        std::size_t out_pos = 0;
+        while (true) {
+            if (result.size() - out_pos < (1 << 16)) result.resize(2 * result.size());
+            std::size_t available = result.size() - out_pos;
+            auto [consumed, produced] = dec.decode(data.data() + in_pos, data.size() - in_pos,
+                                                   &result[out_pos], available);
+            in_pos += consumed;
+            out_pos += produced;
+            // the output is complete if all the input is consumed and the decoder either
+            // finished the last member or has no more pending output
+            if (in_pos == data.size() && (dec.at_boundary() || produced < available)) break;
+            if (consumed == 0 && produced == 0) break;
+        }
+        if (!dec.at_boundary()) throw_decompression_failure("unexpected end of data");
+        result.resize(out_pos);
+        return result;
+    }
+
+    // A part of the compressed data which can be decompressed independently.
+    struct compressed_block {
+        std::size_t begin;
+        std::size_t size;
+        std::size_t decompressed_size;
+    };
+
+    inline std::size_t read_le(std::string_view data, std::size_t pos, int n_bytes)
+    {
+        std::size_t value = 0;
+        for (int i = n_bytes - 1; i >= 0; --i) {
+            value = (value << 8) | static_cast<unsigned char>(data[pos + i]);
+        }
+        return value;
+    }
+
+    // Get the size of the bgzip block starting at the given position from its header.
+    // Returns zero if there is no bgzip header (i.e., with the block size) at the position.
+    inline std::size_t bgzip_block_size(std::string_view data, std::size_t pos)
+    {
+        // the header with the FEXTRA flag
+        if (data.size() - pos < 18
+            || data.substr(pos, 3) != std::string_view{"\x1f\x8b\x08", 3}
+            || !(data[pos + 3] & 4)) {
+            return 0;
+        }
+        // find the BC subfield containing the size of the block
+        std::size_t xlen = read_le(data, pos + 10, 2);
+        for (std::size_t sub = pos + 12; sub + 4 <= pos + 12 + xlen && sub + 4 <= data.size();
+             sub += 4 + read_le(data, sub + 2, 2)) {
+            if (data[sub] == 'B' && data[sub + 1] == 'C' && read_le(data, sub + 2, 2) == 2
+                && sub + 6 <= data.size()) {
+                std::size_t block_size = read_le(data, sub + 4, 2) + 1;
+                return block_size < 18 ? 0 : block_size;
+            }
+        }
+        return 0;
+    }
+
+    // Find the blocks of a bgzip file. If the data are not in the bgzip
+    // format (i.e., the block sizes are not in the gzip headers), return nothing.
+    inline std::vector<compressed_block> bgzip_blocks(std::string_view data)
+    {
+        std::vector<compressed_block> blocks;
+        for (std::size_t pos = 0; pos < data.size();) {
+            std::size_t block_size = bgzip_block_size(data, pos);
+            if (block_size == 0 || block_size > data.size() - pos) return {};
+            // the size of the decompressed block is stored in the last four bytes
+            blocks.push_back({pos, block_size, read_le(data, pos + block_size - 4, 4)});
+            pos += block_size;
+        }
+        return blocks;
+    }
+
+#ifdef CXTREAM_BUILD_ZSTD
+    // Find the frames of zstd data. If the decompressed size of any of the
+    // frames is not stored in its header, return nothing.
+    inline std::vector<compressed_block> zstd_frames(std::string_view data)
+    {
+        std::vector<compressed_block> frames;
+        for (std::size_t pos = 0; pos < data.size();) {
+            const char* frame = data.data() + pos;
+            std::size_t size = ZSTD_findFrameCompressedSize(frame, data.size() - pos);
+            if (ZSTD_isError(size)) return {};
+            unsigned long long decompressed_size = ZSTD_getFrameContentSize(frame, size);
+            if (decompressed_size == ZSTD_CONTENTSIZE_UNKNOWN
+                || decompressed_size == ZSTD_CONTENTSIZE_ERROR) {
+                return {};
+            }
+            frames.push_back({pos, size, static_cast<std::size_t>(decompressed_size)});
+            pos += size;
+        }
+        return frames;
+    }
+#endif
+
+    // Decode a single independent block to the output of exactly the given size.
+    inline void decode_block(decoder& dec, std::string_view block, char* out, std::size_t out_size)
+    {
+        auto [consumed, produced] = dec.decode(block.data(), block.size(), out, out_size);
+        // try to decode one more byte to detect a wrong size in the header
+        char extra;
+        std::size_t extra_produced = 0;
+        if (consumed < block.size() || !dec.at_boundary()) {
+            std::size_t extra_consumed;
+            std::tie(extra_consumed, extra_produced) =
+              dec.decode(block.data() + consumed, block.size() - consumed, &extra, 1);
+            consumed += extra_consumed;
+        }
+        if (consumed != block.size() || produced != out_size || extra_produced != 0
+            || !dec.at_boundary()) {
+            throw_decompression_failure("corrupted block");
+        }
+    }
+
+    // Decompress the independent blocks in parallel directly to their place in the result.
+    inline std::string decompress_blocks(std::string_view data,
+                                         const std::vector<compressed_block>& blocks,
+                                         compression format,
+                                         thread_pool& pool)
+    {
+        std::vector<std::size_t> offsets = {0};
+        for (const compressed_block& block : blocks) {
+            offsets.push_back(offsets.back() + block.decompressed_size);
+        }
+        std::string result(offsets.back(), '\0');
+        pool.parallel_for(blocks.size(), [&](std::size_t begin, std::size_t end) {
+            std::unique_ptr<decoder> dec = make_decoder(format);
+            for (std::size_t i = begin; i < end; ++i) {
+                decode_block(*dec, data.substr(blocks[i].begin, blocks[i].size),
+                             &result[offsets[i]], offsets[i + 1] - offsets[i]);
+            }
+        });
+        return result;
+    }
+
+}  // namespace detail
+
+/// \ingroup Compression
+/// \brief Decompress the whole gzip or zstd data to memory.
+///
+/// The format is detected by detect_compression() and uncompressed data are only copied.
+/// The independent parts of the data are decompressed in parallel using the given
+/// thread pool. Those are the blocks of bgzip files and the frames of multi-frame zstd
+/// files (if the frames store their decompressed size, which is the default of the zstd
+/// tool). The other data are decompressed sequentially.
+///
+/// The gzip and zstd formats are only available if cxtream is built with
+/// the BUILD_GZIP and BUILD_ZSTD options, respectively.
+///
+/// \throws std::ios_base::failure If the data are corrupted or the format is not supported.
+inline std::string decompress(std::string_view data, thread_pool& pool = global_thread_pool())
+{
+    compression format = detect_compression(data);
+    std::vector<detail::compressed_block> blocks;
+    if (format == compression::gzip) blocks = detail::bgzip_blocks(data);
+#ifdef CXTREAM_BUILD_ZSTD
+    if (format == compression::zstd) blocks = detail::zstd_frames(data);
+#endif
+    if (blocks.size() > 1) return detail::decompress_blocks(data, blocks, format, pool);
+    std::unique_ptr<detail::decoder> dec = detail::make_decoder(format);
+    return detail::decode_all(*dec, data);
+}
+
+/// \ingroup Compression
+/// \brief Stream buffer decompressing the data read from another std::istream.
+///
+/// The format is detected from the first bytes of the source stream (see
+/// detect_compression()). Uncompressed data are passed through unchanged.
+///
+/// The independent blocks of bgzip files and the frames of multi-frame zstd files
+/// (see decompress()) are decompressed in parallel using the given thread pool.
+/// The blocks are read ahead from the source stream and at most two blocks per thread
+/// are being decompressed at once, so the memory usage stays bounded. Only the zstd
+/// frames of at most 16MB are decompressed in parallel. Once the data are not split
+/// to such blocks, the rest of the stream is decompressed sequentially.
+class decompressing_streambuf : public std::streambuf {
+private:
+    // the maximum decompressed size of a zstd frame to be decompressed in parallel
+    static constexpr std::size_t max_block_size = 1 << 24;
+
+    std::istream* source_;
+    thread_pool* pool_;
+    std::size_t buffer_size_;
+    std::vector<char> in_buffer_;
+    std::size_t in_pos_ = 0;
+    std::size_t in_end_ = 0;
+    std::vector<char> out_buffer_;
+    compression format_ = compression::none;
+    std::unique_ptr<detail::decoder> decoder_;
+    // the blocks being decompressed in parallel and the block being read
+    std::deque<future<std::string>> blocks_;
+    std::string block_;
+    std::size_t max_blocks_;
+    bool parallel_ = false;
+
+    // the part of the input buffer which is not decompressed yet
+    std::string_view input() const
+    {
+        return {in_buffer_.data() + in_pos_, in_end_ - in_pos_};
+    }
+
+    // read the next block of the source stream
+    bool fill_input()
+    {
+        source_->read(in_buffer_.data(), in_buffer_.size());
+        if (source_->bad()) throw std::ios_base::failure{"Error while reading compressed stream."};
+        in_pos_ = 0;
+        in_end_ = source_->gcount();
+        return in_end_ > 0;
+    }
+
+    // read the source stream until there are at least n bytes in the input buffer,
+    // return false if the stream ends before
+    bool ensure_input(std::size_t n)
+    {
+        if (in_end_ - in_pos_ >= n) return true;
+        std::copy(in_buffer_.begin() + in_pos_, in_buffer_.begin() + in_end_, in_buffer_.begin());
+        in_end_ -= in_pos_;
+        in_pos_ = 0;
+        if (in_buffer_.size() < n) in_buffer_.resize(std::max(n, 2 * in_buffer_.size()));
+        while (in_end_ < n) {
+            source_->read(in_buffer_.data() + in_end_, in_buffer_.size() - in_end_);
+            if (source_->bad()) {
+                throw std::ios_base::failure{"Error while reading compressed stream."};
+            }
+            if (source_->gcount() == 0) return false;
+            in_end_ += source_->gcount();
+        }
+        return true;
+    }
+
+    // find the independent block at the beginning of the input buffer,
+    // the size of the block is zero if there is no such block
+    detail::compressed_block peek_block()
+    {
+        if (format_ == compression::gzip) {
+            if (!ensure_input(12)) return {};
+            ensure_input(12 + detail::read_le(input(), 10, 2));
+            std::size_t size = detail::bgzip_block_size(input(), 0);
+            if (size == 0 || !ensure_input(size)) return {};
+            return {in_pos_, size, detail::read_le(input(), size - 4, 4)};
+        }
+#ifdef CXTREAM_BUILD_ZSTD
+        if (format_ == compression::zstd) {
+            // the frame header has at most 18 bytes
+            ensure_input(18);
+            unsigned long long decompressed_size =
+              ZSTD_getFrameContentSize(input().data(), input().size());
+            // the unknown size and the error are larger than the limit as well
+            if (decompressed_size > max_block_size) return {};
+            std::size_t max_size = ZSTD_compressBound(decompressed_size) + 1024;
+            while (true) {
+                std::size_t size = ZSTD_findFrameCompressedSize(input().data(), input().size());
+                if (!ZSTD_isError(size)) return {in_pos_, size, decompressed_size};
+                // read more data unless the frame is too large to be valid
+                if (input().size() >= max_size
+                    || !ensure_input(std::min(input().size() + buffer_size_, max_size))) {
+                    return {};
+                }
+            }
+        }
+#endif
+        return {};
+    }
+
+    // start decompressing the next independent blocks in the thread pool,
+    // switch to the sequential decompression if there are no such blocks
+    void enqueue_blocks()
+    {
+        while (parallel_ && blocks_.size() < max_blocks_) {
+            detail::compressed_block block = peek_block();
+            if (block.size == 0) {
+                parallel_ = false;
+                break;
+            }
+            blocks_.push_back(pool_->enqueue(
+              [format = format_, data = std::string{input().substr(0, block.size)},
+               size = block.decompressed_size]() {
+                  std::string result(size, '\0');
+                  std::unique_ptr<detail::decoder> dec = detail::make_decoder(format);
+                  detail::decode_block(*dec, data, &result[0], size);
+                  return result;
+              }));
+            in_pos_ += block.size;
+        }
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        if (!decoder_) {
+            ensure_input(4);
+            format_ = detect_compression(input());
+            decoder_ = detail::make_decoder(format_);
+            parallel_ = format_ != compression::none;
+        }
+        while (true) {
+            enqueue_blocks();
+            if (!blocks_.empty()) {
+                future<std::string> next_block = std::move(blocks_.front());
+                blocks_.pop_front();
+                block_ = next_block.get();
+                if (block_.empty()) continue;
+                setg(&block_[0], &block_[0], &block_[0] + block_.size());
+                return traits_type::to_int_type(*gptr());
+            }
+            bool source_end = in_pos_ == in_end_ && !fill_input();
+            if (source_end && decoder_->at_boundary()) return traits_type::eof();
+            auto [consumed, produced] =
+              decoder_->decode(in_buffer_.data() + in_pos_, in_end_ - in_pos_,
+                               out_buffer_.data(), out_buffer_.size());
+            in_pos_ += consumed;
+            if (produced > 0) {
+                setg(out_buffer_.data(), out_buffer_.data(), out_buffer_.data() + produced);
+                return traits_type::to_int_type(*gptr());
+            }
+            // the decoder has no pending output left
+            if (source_end) detail::throw_decompression_failure("unexpected end of data");
+        }
+    }
+
+public:
+    /// \param source The stream with the compressed data.
+    /// \param buffer_size The size of the buffers of the compressed and decompressed data.
+    /// \param pool The thread pool used to decompress the independent blocks.
+    explicit decompressing_streambuf(std::istream& source,
+                                     std::size_t buffer_size = 1 << 16,
+                                     thread_pool& pool = global_thread_pool())
+      : source_{&source}
+      , pool_{&pool}
+      , buffer_size_{buffer_size}
+      , in_buffer_(buffer_size)
+      , out_buffer_(4 * buffer_size)
+      , max_blocks_{std::max<std::size_t>(2 * pool.n_threads(), 2)}
+    {}
+};
+
+/// \ingroup Compression
+/// \brief Input stream decompressing the data read from another std::istream.
+///
+/// \code
+///     std::ifstream fin{"data.csv.gz", std::ios::binary};
+///     decompressing_istream in{fin};
+///     for (std::string line; std::getline(in, line);) {
+///         // ...
+///     }
+/// \endcode
+///
+/// The errors of the decompression set the badbit of the stream (or throw
+/// std::ios_base::failure if the badbit exception is enabled).
+class decompressing_istream : public std::istream {
+private:
+    decompressing_streambuf buffer_;
+
+public:
+    /// \param source The stream with the compressed data. It has to outlive this stream.
+    /// \param pool The thread pool used to decompress the independent blocks,
+    ///             see decompressing_streambuf.
+    explicit decompressing_istream(std::istream& source, thread_pool& pool = global_thread_pool())
+      : std::istream{nullptr}
+      , buffer_{source, 1 << 16, pool}
+    {
+        rdbuf(&buffer_);
+    }
+};
+
+}  // namespace cxtream::utility
+#endif
@@ -11,10 +11,20 @@
 #ifndef CXTREAM_CORE_UTILITY_FILESYSTEM_HPP
 #define CXTREAM_CORE_UTILITY_FILESYSTEM_HPP
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <exception>
 #include <experimental/filesystem>
+#include <ios>
 #include <random>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
 
 namespace cxtream::utility {
 
@@ -53,5 +63,95 @@ std::experimental::filesystem::path create_temp_directory(const std::string &pat
     throw std::runtime_error(std::string{"Cannot create temporary directory ["} + pattern + "]");
 }
 
+/// \ingroup Filesystem
+/// \brief Read-only memory mapping of a whole file.
+///
+/// The contents of the file are available as std::string_view until the
+/// object is destroyed. The pages are loaded lazily by the operating system,
+/// so even files larger than the available memory can be mapped.
+class mapped_file {
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    void unmap() noexcept
+    {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+public:
+    mapped_file() = default;
+
+    /// Map the given file to memory.
+    ///
+    /// \param file The file to be mapped.
+    /// \param sequential Advise the operating system that the file will be read sequentially.
+    /// \throws std::ios_base::failure If the file cannot be opened or mapped.
+    explicit mapped_file(const std::experimental::filesystem::path& file, bool sequential = true)
+    {
+        auto failure = [&file](const std::string& msg) {
+            return std::ios_base::failure{msg + " " + file.string() + ".",
+                                          std::error_code{errno, std::generic_category()}};
+        };
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1) throw failure("Cannot open");
+        auto close_failure = [fd, &failure](const std::string& msg) {
+            auto error = failure(msg);
+            ::close(fd);
+            return error;
+        };
+        struct stat st;
+        if (::fstat(fd, &st) == -1) throw close_failure("Cannot stat");
+        if (!S_ISREG(st.st_mode)) {
+            errno = EINVAL;
+            throw close_failure("Cannot map non-regular file");
+        }
+        size_ = st.st_size;
+        // empty files cannot be mapped
+        if (size_ > 0) {
+            void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                size_ = 0;
+                throw close_failure("Cannot map");
+            }
+            if (sequential) ::madvise(ptr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(ptr);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& rhs) noexcept
+      : data_{std::exchange(rhs.data_, nullptr)}
+      , size_{std::exchange(rhs.size_, 0)}
+    {}
+
+    mapped_file& operator=(mapped_file&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            unmap();
+            data_ = std::exchange(rhs.data_, nullptr);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+        unmap();
+    }
+
+    /// The mapped contents of the file.
+    std::string_view view() const noexcept { return {data_, size_}; }
+
+    const char* data() const noexcept { return data_; }
+
+    std::size_t size() const noexcept { return size_; }
+};
+
 }  // namespace cxtream
 #endif
@@ -15,11 +15,17 @@
 #include <range/v3/view/transform.hpp>
 
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
 #include <locale>
 #include <experimental/filesystem>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 
 namespace cxtream::utility {
 
@@ -81,6 +87,69 @@ inline bool string_to<bool>(const std::string& str)
     throw std::ios_base::failure{"Failed to convert string \"" + str + "\" to bool."};
 }
 
+namespace detail {
+
+    template<typename T>
+    [[noreturn]] void throw_string_view_to_failure(std::string_view str)
+    {
+        throw std::ios_base::failure{std::string{"Failed to read type <"} + typeid(T).name() +
+                                     "> from string \"" + std::string{str} + "\"."};
+    }
+
+    // Parse a floating point number from a string, which is not null terminated.
+    template<typename T>
+    bool floating_from_chars(const char* first, const char* last, T& value)
+    {
+#if defined(__cpp_lib_to_chars)
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        return ec == std::errc{} && ptr == last;
+#else
+        std::string str{first, last};
+        char* end;
+        errno = 0;
+        if constexpr (std::is_same<T, float>{}) value = std::strtof(str.c_str(), &end);
+        else if constexpr (std::is_same<T, double>{}) value = std::strtod(str.c_str(), &end);
+        else value = std::strtold(str.c_str(), &end);
+        return errno == 0 && end == str.c_str() + str.size();
+#endif
+    }
+
+}  // namespace detail
+
+/// \ingroup String
+/// \brief Convert std::string_view to the given type.
+///
+/// Arithmetic types (except bool) are parsed directly from the string by std::from_chars,
+/// so no memory is allocated. The whole string has to be a valid number, a leading plus
+/// sign is allowed. The other types are converted using string_to().
+///
+/// \throws std::ios_base::failure If the conversion fails.
+template<typename T>
+T string_view_to(std::string_view str)
+{
+    if constexpr (std::is_same<T, std::string>{}) {
+        return std::string{str};
+    } else if constexpr (std::is_arithmetic<T>{} && !std::is_same<T, bool>{}) {
+        const char* first = str.data();
+        const char* last = str.data() + str.size();
+        if (last - first > 1 && *first == '+' && first[1] != '-') ++first;
+        T value{};
+        bool success = false;
+        if (first != last) {
+            if constexpr (std::is_floating_point<T>{}) {
+                success = detail::floating_from_chars(first, last, value);
+            } else {
+                auto [ptr, ec] = std::from_chars(first, last, value);
+                success = ec == std::errc{} && ptr == last;
+            }
+        }
+        if (!success) detail::throw_string_view_to_failure<T>(str);
+        return value;
+    } else {
+        return string_to<T>(std::string{str});
+    }
+}
+
 /// \ingroup String
 /// \brief Convert the given type to std::string.
 ///
@@ -18,13 +18,14 @@
 #include <range/v3/algorithm/all_of.hpp>
 #include <range/v3/algorithm/fill.hpp>
 #include <range/v3/algorithm/find.hpp>
-#include <range/v3/algorithm/max.hpp>
 #include <range/v3/numeric/accumulate.hpp>
 #include <range/v3/view/all.hpp>
 #include <range/v3/view/chunk.hpp>
 #include <range/v3/view/for_each.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cmath>
 #include <functional>
 #include <memory>
@@ -262,6 +263,90 @@ Rng& ndim_resize(Rng& vec,
     return ndim_resize<ndims<Rng>{}-ndims<ValT>{}>(vec, vec_size, std::move(val));
 }
 
+// multidimensional range max size //
+
+namespace detail {
+
+    template<long Dim, long NDims>
+    struct ndim_max_size_impl {
+        template<typename Rng>
+        static void impl(const Rng& rng, std::vector<long>& max_size)
+        {
+            max_size[Dim-1] = std::max(max_size[Dim-1], static_cast<long>(ranges::size(rng)));
+            if constexpr (Dim < NDims) {
+                for (auto& subrng : rng) {
+                    ndim_max_size_impl<Dim+1, NDims>::impl(subrng, max_size);
+                }
+            }
+        }
+    };
+
+}  // namespace detail
+
+/// \ingroup Vector
+/// \brief Calculates the maximum size of the ranges in each dimension.
+///
+/// This is the shape to which the range would be padded by ndim_pad(). Unlike
+/// ndim_size(), the sizes of the individual ranges are not stored.
+///
+/// Example:
+/// \code
+///     std::vector<std::list<int>> rng{{1, 2, 3}, {1}, {5, 6}, {7}};
+///     std::vector<long> rng_max_size = ndim_max_size<2>(rng);
+///     // rng_max_size == {4, 3};
+/// \endcode
+///
+/// \param rng The multidimensional range whose maximum size shall be calculated.
+/// \tparam NDims The number of dimensions that should be considered.
+/// \returns The maximum sizes of the given range in each dimension.
+template<long NDims, typename Rng>
+std::vector<long> ndim_max_size(const Rng& rng)
+{
+    static_assert(NDims > 0);
+    std::vector<long> max_size(NDims);
+    detail::ndim_max_size_impl<1, NDims>::impl(rng, max_size);
+    return max_size;
+}
+
+// multidimensional range pad //
+
+namespace detail {
+
+    // Resize each range to the given shape and create the mask in the same pass.
+    // Every range is resized exactly once. If the mask is std::nullptr_t, it is ignored.
+    template<long Dim, long NDims>
+    struct ndim_pad_impl {
+        template<typename Rng, typename MaskRng, typename ValT>
+        static void impl(Rng& vec, MaskRng& mask, const std::vector<long>& shape, const ValT& val)
+        {
+            constexpr bool has_mask = !std::is_same<MaskRng, std::nullptr_t>{};
+            if constexpr (Dim == NDims) {
+                if constexpr (has_mask) {
+                    mask.clear();
+                    mask.resize(shape[Dim-1], false);
+                    std::fill_n(ranges::begin(mask), ranges::size(vec), true);
+                }
+                vec.resize(shape[Dim-1], val);
+            } else {
+                vec.resize(shape[Dim-1]);
+                if constexpr (has_mask) {
+                    mask.clear();
+                    mask.resize(shape[Dim-1]);
+                    auto mask_it = ranges::begin(mask);
+                    for (auto& subvec : vec) {
+                        ndim_pad_impl<Dim+1, NDims>::impl(subvec, *mask_it++, shape, val);
+                    }
+                } else {
+                    for (auto& subvec : vec) {
+                        ndim_pad_impl<Dim+1, NDims>::impl(subvec, mask, shape, val);
+                    }
+                }
+            }
+        }
+    };
+
+}  // namespace detail
+
 /// \ingroup Vector
 /// \brief Pads a mutlidimensional range to a rectangular size.
 ///
@@ -286,13 +371,10 @@ template<long NDims, typename Rng, typename ValT = ndim_type_t<Rng, NDims>>
 Rng& ndim_pad(Rng& vec, ValT val = ValT{})
 {
     static_assert(NDims <= ndims<Rng>{} - ndims<ValT>{});
-    std::vector<std::vector<long>> vec_size = ndim_size<NDims>(vec);
-    // replace the sizes in each dimension with the max size in the same dimension
-    for (std::size_t i = 1; i < vec_size.size(); ++i) {
-        long max_size = ranges::max(vec_size[i]);
-        ranges::fill(vec_size[i], max_size);
-    }
-    return utility::ndim_resize<NDims>(vec, vec_size, std::move(val));
+    std::vector<long> shape = utility::ndim_max_size<NDims>(vec);
+    std::nullptr_t no_mask;
+    detail::ndim_pad_impl<1, NDims>::impl(vec, no_mask, shape, val);
+    return vec;
 }
 
 /// A specialization which automatically deduces the number of dimensions.
@@ -302,6 +384,39 @@ Rng& ndim_pad(Rng& vec, ValT val = ValT{})
     return utility::ndim_pad<ndims<Rng>{}-ndims<ValT>{}>(vec, std::move(val));
 }
 
+/// \ingroup Vector
+/// \brief Pads a mutlidimensional range to a rectangular size and creates its mask.
+///
+/// The mask evaluates to `true` on the positions with the original elements and to
+/// `false` on the positions of the padded elements. The maximum size is calculated
+/// in a single traversal and then the range is padded and the mask is created in
+/// another traversal, each subrange being resized only once.
+///
+/// Example:
+/// \code
+///     std::vector<std::vector<int>> vec = {{1, 2}, {3, 4, 5}, {}};
+///     std::vector<std::vector<bool>> mask;
+///     ndim_pad_mask<2>(vec, mask, -1);
+///     // vec == {{1, 2, -1}, {3, 4, 5}, {-1, -1, -1}};
+///     // mask == {{true, true, false}, {true, true, true}, {false, false, false}};
+/// \endcode
+///
+/// \param vec The range to be padded.
+/// \param mask The range where the mask shall be stored. Its previous content is discarded.
+/// \param val The value to pad with.
+/// \tparam NDims The number of dimensions to be considered. The mask has to have at
+///               least NDims dimensions.
+/// \returns The reference to the given vector after padding.
+template<long NDims, typename Rng, typename MaskRng, typename ValT = ndim_type_t<Rng, NDims>>
+Rng& ndim_pad_mask(Rng& vec, MaskRng& mask, ValT val = ValT{})
+{
+    static_assert(NDims <= ndims<Rng>{} - ndims<ValT>{});
+    static_assert(NDims <= ndims<MaskRng>{});
+    std::vector<long> shape = utility::ndim_max_size<NDims>(vec);
+    detail::ndim_pad_impl<1, NDims>::impl(vec, mask, shape, val);
+    return vec;
+}
+
 // multidimensional range shape //
 
 namespace detail {
@@ -134,7 +134,9 @@ public:
             if (!first_iteration_ && position_ != ranges::end(*rng_ptr_)) ++position_;
             first_iteration_ = false;
             if (position_ == ranges::end(*rng_ptr_)) throw stop_iteration_exception();
-            return *position_;
+            // the elements of a single pass range are visited only once, so they are moved
+            if constexpr (ranges::ForwardRange<Rng>()) return *position_;
+            else return ranges::iter_move(position_);
         }
     };
 
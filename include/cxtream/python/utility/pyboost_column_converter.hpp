@@ -10,6 +10,8 @@
 #ifndef CXTREAM_PYTHON_UTILITY_PYBOOST_COLUMN_CONVERTER_HPP
 #define CXTREAM_PYTHON_UTILITY_PYBOOST_COLUMN_CONVERTER_HPP
 
+#include <cxtream/core/ragged.hpp>
+#include <cxtream/core/tensor.hpp>
 #include <cxtream/core/utility/tuple.hpp>
 #include <cxtream/python/range.hpp>
 #include <cxtream/python/utility/pyboost_ndarray_converter.hpp>
@@ -58,6 +60,33 @@ namespace detail {
         }
     };
 
+    // tensors are always converted to a single multidimensional ndarray
+    template<typename T, long NDims>
+    struct vector_to_python_impl<tensor<T, NDims>> {
+        static PyObject* impl(tensor<T, NDims> ten)
+        {
+            return utility::to_ndarray(std::move(ten));
+        }
+    };
+
+    // ragged arrays are converted to a tuple (values, (row_splits_0, row_splits_1, ...)),
+    // i.e., the flat values and the row splits are each copied to a single ndarray
+    template<typename T, long NDims>
+    struct vector_to_python_impl<ragged<T, NDims>> {
+        static PyObject* impl(ragged<T, NDims> rag)
+        {
+            namespace py = boost::python;
+            py::list row_splits;
+            for (long d = 0; d < NDims - 1; ++d) {
+                row_splits.append(py::object{py::handle<>{utility::to_ndarray(rag.row_splits(d))}});
+            }
+            py::object values{py::handle<>{utility::to_ndarray(rag.values())}};
+            py::tuple result = py::make_tuple(values, py::tuple{row_splits});
+            Py_INCREF(result.ptr());
+            return result.ptr();
+        }
+    };
+
 }  // namespace detail
 
 /// \ingroup Python
@@ -73,6 +102,28 @@ boost::python::object to_python(std::vector<T> v)
     return py::object{py_obj_handle};
 }
 
+/// \ingroup Python
+/// \brief Create a multidimensional ndarray out of a tensor.
+template<typename T, long NDims>
+boost::python::object to_python(tensor<T, NDims> ten)
+{
+    namespace py = boost::python;
+    py::handle<> py_obj_handle{detail::vector_to_python_impl<tensor<T, NDims>>::impl(std::move(ten))};
+    return py::object{py_obj_handle};
+}
+
+/// \ingroup Python
+/// \brief Convert a ragged array to a tuple of its flat values and its row splits.
+///
+/// The result can be directly passed, e.g., to `tf.RaggedTensor.from_nested_row_splits`.
+template<typename T, long NDims>
+boost::python::object to_python(ragged<T, NDims> rag)
+{
+    namespace py = boost::python;
+    py::handle<> py_obj_handle{detail::vector_to_python_impl<ragged<T, NDims>>::impl(std::move(rag))};
+    return py::object{py_obj_handle};
+}
+
 /// \ingroup Python
 /// \brief Convert a tuple of cxtream columns into a Python `dict`.
 ///
@@ -17,6 +17,11 @@
 #include <boost/python.hpp>
 #include <numpy/ndarrayobject.h>
 
+#include <cxtream/core/tensor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -118,5 +123,49 @@ PyObject* to_ndarray(const std::vector<T>& vec)
     return arr;
 }
 
+/// \ingroup Python
+/// \brief Build ndarray from a tensor.
+///
+/// If the tensor holds one of the builtin arithmetic types, the data are not copied.
+/// Instead, the ndarray takes the ownership of the tensor and releases it when
+/// the array is removed.
+template<typename T, long NDims>
+PyObject* to_ndarray(tensor<T, NDims> ten)
+{
+    std::array<npy_intp, NDims> dims;
+    std::copy(ten.shape().begin(), ten.shape().end(), dims.begin());
+
+    if constexpr (std::is_arithmetic<T>{} && std::is_same<detail::ndarray_type_t<T>, T>{}) {
+        auto owner = std::make_unique<tensor<T, NDims>>(std::move(ten));
+        PyObject* arr = PyArray_SimpleNewFromData(
+          NDims, dims.data(), detail::to_ndarray_typenum<T>(),
+          reinterpret_cast<void*>(owner->data()));
+        if (!arr) throw std::runtime_error{"Cannot create Python NumPy ndarray."};
+        // the capsule keeps the tensor alive for as long as the array exists
+        PyObject* capsule = PyCapsule_New(owner.get(), nullptr, [](PyObject* cap) {
+            delete reinterpret_cast<tensor<T, NDims>*>(PyCapsule_GetPointer(cap, nullptr));
+        });
+        if (!capsule) {
+            Py_DECREF(arr);
+            throw std::runtime_error{"Cannot create Python capsule."};
+        }
+        owner.release();
+        // the array steals the reference to the capsule
+        PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(arr), capsule);
+        return arr;
+    } else {
+        auto data = std::make_unique<detail::ndarray_type_t<T>[]>(ten.numel());
+        for (std::size_t i = 0; i < ten.numel(); ++i) {
+            data[i] = detail::to_ndarray_element(std::move(ten.data()[i]));
+        }
+        PyObject* arr = PyArray_SimpleNewFromData(
+          NDims, dims.data(), detail::to_ndarray_typenum<T>(),
+          reinterpret_cast<void*>(data.release()));
+        if (!arr) throw std::runtime_error{"Cannot create Python NumPy ndarray."};
+        PyArray_ENABLEFLAGS(reinterpret_cast<PyArrayObject*>(arr), NPY_ARRAY_OWNDATA);
+        return arr;
+    }
+}
+
 }  // namespace cxtream::python::utility
 #endif
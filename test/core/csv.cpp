@@ -18,11 +18,22 @@
 #include <range/v3/algorithm/find_first_of.hpp>
 #include <range/v3/view/slice.hpp>
 
+#include <cctype>
+#include <cstdint>
 #include <experimental/filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <random>
 #include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
 
+#include <sys/stat.h>
+
 using namespace cxtream;
 namespace fs = std::experimental::filesystem;
 
@@ -42,6 +53,18 @@ Container2d transpose(const Container2d& data)
     return res;
 }
 
+// copy the fields of string_view rows //
+
+template<typename Rng>
+std::vector<std::vector<std::string>> copy_rows(Rng&& rng)
+{
+    std::vector<std::vector<std::string>> rows;
+    for (const std::vector<std::string_view>& row : rng) {
+        rows.emplace_back(row.begin(), row.end());
+    }
+    return rows;
+}
+
 // simple csv example //
 
 const std::string simple_csv{
@@ -128,6 +151,90 @@ BOOST_AUTO_TEST_CASE(test_csv_istream_range_quoted_csv)
     test_ranges_equal(csv_rows, quoted_csv_rows);
 }
 
+BOOST_AUTO_TEST_CASE(test_find_either)
+{
+    // check all the positions in all the SIMD block sizes and tails
+    for (std::size_t n = 0; n < 100; ++n) {
+        std::string str(n, 'x');
+        BOOST_TEST(detail::find_either(str.data(), str.data() + n, ',', '\n') == str.data() + n);
+        for (std::size_t i = 0; i < n; ++i) {
+            str[i] = i % 2 ? ',' : '\n';
+            BOOST_TEST(detail::find_either(str.data(), str.data() + n, ',', '\n') == str.data() + i);
+            str[i] = 'x';
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_buffer_range_simple_csv)
+{
+    BOOST_CHECK(copy_rows(csv_buffer_range{simple_csv}) == simple_csv_rows);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_buffer_range_empty_fields_csv)
+{
+    BOOST_CHECK(copy_rows(csv_buffer_range{empty_fields_csv}) == empty_fields_csv_rows);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_buffer_range_quoted_csv)
+{
+    auto csv_rows = csv_buffer_range{quoted_csv, '|', '*', '+'};
+    BOOST_CHECK(copy_rows(csv_rows) == quoted_csv_rows);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_buffer_range_zero_copy)
+{
+    std::string_view csv{"Id, \"A\", \"B \\\" B\"\n 1, a1, b1"};
+    auto csv_rows = csv_buffer_range{csv};
+    auto it = ranges::begin(csv_rows);
+    const std::vector<std::string_view>& header = *it;
+    BOOST_TEST(header.size() == 3U);
+    // the unescaped fields point to the buffer
+    BOOST_TEST(header[0].data() == csv.data());
+    BOOST_TEST(header[1].data() == csv.data() + 5);
+    // the escaped field is copied
+    BOOST_TEST(header[2] == "B \" B");
+    BOOST_TEST((header[2].data() < csv.data() || header[2].data() >= csv.data() + csv.size()));
+    ++it;
+    BOOST_TEST((*it)[2].data() == csv.data() + csv.size() - 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_buffer_range_long_escaped_field)
+{
+    std::string field(100, 'x');
+    std::string csv = "\"" + field + "\\\"" + field + "\\\\\", " + field;
+    std::vector<std::vector<std::string>> desired = {{field + "\"" + field + "\\", field}};
+    BOOST_CHECK(copy_rows(csv_buffer_range{csv}) == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_csv_block_range)
+{
+    // the rows crossing the blocks are parsed again after the next block is read
+    for (std::size_t block_size : {1, 2, 5, 16, 1 << 20}) {
+        std::istringstream quoted_csv_ss{quoted_csv};
+        BOOST_CHECK(copy_rows(detail::csv_block_range{quoted_csv_ss, '|', '*', '+', block_size})
+                    == quoted_csv_rows);
+        std::istringstream empty_fields_csv_ss{empty_fields_csv};
+        BOOST_CHECK(copy_rows(detail::csv_block_range{empty_fields_csv_ss, ',', '"', '\\',
+                                                      block_size})
+                    == empty_fields_csv_rows);
+    }
+    std::istringstream invalid_csv_ss{invalid_csvs[1]};
+    BOOST_CHECK_THROW(copy_rows(detail::csv_block_range{invalid_csv_ss, ',', '"', '\\', 4}),
+                      std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(test_mmap_csv)
+{
+    fs::path csv_file{"test.core.csv.test_mmap_csv.csv"};
+    {
+        std::ofstream fout{csv_file};
+        fout << quoted_csv;
+    }
+    BOOST_CHECK(copy_rows(mmap_csv(csv_file, '|', '*', '+')) == quoted_csv_rows);
+    fs::remove(csv_file);
+    BOOST_CHECK_THROW(mmap_csv("no_file.csv"), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(test_read_csv_from_istream)
 {
     std::istringstream simple_csv_ss{simple_csv};
@@ -145,6 +252,31 @@ BOOST_AUTO_TEST_CASE(test_read_csv_from_no_file)
     BOOST_CHECK_THROW(read_csv("no_file.csv"), std::ios_base::failure);
 }
 
+BOOST_AUTO_TEST_CASE(test_read_csv_from_fifo)
+{
+    fs::path fifo{"test.core.csv.test_read_csv_from_fifo.csv"};
+    BOOST_REQUIRE(::mkfifo(fifo.c_str(), 0600) == 0);
+    // named pipes cannot be memory mapped, they are read as streams
+    for (int i = 0; i < 2; ++i) {
+        std::thread writer{[&fifo]() {
+            std::ofstream fout{fifo};
+            fout << simple_csv;
+        }};
+        if (i == 0) {
+            const dataframe<> df = read_csv(fifo);
+            BOOST_TEST(df.n_rows() == 3);
+            test_ranges_equal(df.header(), simple_csv_rows[0]);
+            test_ranges_equal(df.raw_cols()[1],
+                              simple_csv_cols[1] | ranges::view::slice(1, ranges::end));
+        } else {
+            auto [ids] = read_csv_cols<int>(fifo, {"Id"});
+            BOOST_CHECK(ids == (std::vector<int>{1, 2, 3}));
+        }
+        writer.join();
+    }
+    fs::remove(fifo);
+}
+
 BOOST_AUTO_TEST_CASE(test_read_csv_from_istream_no_header)
 {
     std::istringstream simple_csv_ss{simple_csv};
@@ -168,6 +300,48 @@ BOOST_AUTO_TEST_CASE(test_read_quoted_csv_from_istream)
     test_ranges_equal(df.raw_rows()[1], quoted_csv_rows[2]);
 }
 
+BOOST_AUTO_TEST_CASE(test_read_csv_cols)
+{
+    std::istringstream csv{"id, name, value, note\n"
+                           "1, a, 0.5, \"x, y\"\n"
+                           "-2, b, +1e3, z\n"
+                           "3, \"c, d\", -0.25, w\n"};
+    auto [values, ids, names] =
+      read_csv_cols<double, std::int64_t, std::string>(csv, {"value", "id", "name"});
+    BOOST_CHECK(ids == (std::vector<std::int64_t>{1, -2, 3}));
+    BOOST_CHECK(values == (std::vector<double>{0.5, 1000., -0.25}));
+    BOOST_CHECK(names == (std::vector<std::string>{"a", "b", "c, d"}));
+}
+
+BOOST_AUTO_TEST_CASE(test_read_csv_cols_from_file)
+{
+    fs::path csv_file{"test.core.csv.test_read_csv_cols_from_file.csv"};
+    {
+        std::ofstream fout{csv_file};
+        fout << "comment\n" << "A|B\n" << "*1*|2\n" << "3|4\n";
+    }
+    auto [b] = read_csv_cols<int>(csv_file, {"B"}, 1, '|', '*');
+    BOOST_CHECK(b == (std::vector<int>{2, 4}));
+    fs::remove(csv_file);
+    BOOST_CHECK_THROW(read_csv_cols<int>("no_file.csv", {"A"}), std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(test_read_csv_cols_exceptions)
+{
+    for (auto& invalid_csv : invalid_csvs) {
+        std::istringstream invalid_csv_ss{invalid_csv};
+        BOOST_CHECK_THROW(read_csv_cols<>(invalid_csv_ss, {}), std::ios_base::failure);
+    }
+    std::istringstream csv{"A, B\n1, 2\n3, x\n"};
+    BOOST_CHECK_THROW(read_csv_cols<int>(csv, {"C"}), std::out_of_range);
+    csv.clear();
+    csv.seekg(0);
+    BOOST_CHECK_THROW((read_csv_cols<int, int>(csv, {"A", "B"})), std::ios_base::failure);
+    csv.clear();
+    csv.seekg(0);
+    BOOST_CHECK_THROW(read_csv_cols<int>(csv, {"A", "B"}), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(test_write_quoted_to_ostream)
 {
     std::istringstream quoted_csv_ss{quoted_csv};
@@ -221,6 +395,73 @@ BOOST_AUTO_TEST_CASE(test_file_write_and_read)
     BOOST_CHECK(df1_cols == df2_cols);
 }
 
+// write a dataframe using std::quoted field by field //
+
+std::string write_csv_reference(const dataframe<>& df, char separator, char quote, char escape)
+{
+    std::ostringstream out;
+    auto write_row = [&](const std::vector<std::string>& row) {
+        for (std::size_t i = 0; i < row.size(); ++i) {
+            const std::string& field = row[i];
+            if (field.find_first_of(std::string{separator, quote, '\n'}) != std::string::npos
+                || (!field.empty() && (std::isspace(field.front())
+                                       || std::isspace(field.back())))) {
+                out << std::quoted(field, quote, escape);
+            } else {
+                out << field;
+            }
+            out << (i + 1 < row.size() ? separator : '\n');
+        }
+    };
+    write_row(df.header());
+    for (std::size_t i = 0; i < df.n_rows(); ++i) {
+        std::vector<std::string> row;
+        for (std::size_t j = 0; j < df.n_cols(); ++j) row.push_back(df.data()[j][i]);
+        write_row(row);
+    }
+    return out.str();
+}
+
+BOOST_AUTO_TEST_CASE(test_write_csv_parallel)
+{
+    // generate fields with separators, quotes, escapes, newlines and whitespace
+    std::mt19937 gen{42};
+    const std::string chars = "ab1 ,|\"*+\\\n\t";
+    std::vector<std::vector<std::string>> data(4);
+    for (auto& col : data) {
+        for (int i = 0; i < 1000; ++i) {
+            std::string field;
+            for (std::size_t n = gen() % 12; n > 0; --n) {
+                field.push_back(chars[gen() % chars.size()]);
+            }
+            col.push_back(std::move(field));
+        }
+    }
+    const dataframe<> df{data, {"A", " B", "C|D", "E"}};
+    thread_pool pool{3};
+    for (auto [separator, quote, escape] : {std::make_tuple(',', '"', '\\'),
+                                            std::make_tuple('|', '*', '+'),
+                                            std::make_tuple(',', '"', '"')}) {
+        const std::string desired = write_csv_reference(df, separator, quote, escape);
+        std::ostringstream out;
+        write_csv(out, df, separator, quote, escape);
+        BOOST_CHECK(out.str() == desired);
+        for (std::size_t block_rows : {0, 1, 7, 5000}) {
+            std::ostringstream par_out;
+            write_csv_parallel(par_out, df, separator, quote, escape, pool, block_rows);
+            BOOST_CHECK(par_out.str() == desired);
+        }
+    }
+
+    fs::path csv_file{"test.core.csv.test_write_csv_parallel.csv"};
+    write_csv_parallel(csv_file, df);
+    const dataframe<> df2 = read_csv(csv_file);
+    fs::remove(csv_file);
+    test_ranges_equal(df.header(), df2.header());
+    std::vector<std::vector<std::string>> df2_cols = df2.raw_cols();
+    BOOST_CHECK(df2_cols == data);
+}
+
 BOOST_AUTO_TEST_CASE(test_exceptions)
 {
     for (auto& invalid_csv : invalid_csvs) {
@@ -228,3 +469,111 @@ BOOST_AUTO_TEST_CASE(test_exceptions)
         BOOST_CHECK_THROW(read_csv(invalid_csv_ss), std::ios_base::failure);
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_read_csv_parallel)
+{
+    // generate a csv with quoted newlines and separators
+    std::ostringstream csv;
+    csv << "Id, A, B\n";
+    for (int i = 0; i < 1000; ++i) {
+        csv << i << ", a" << i << ", ";
+        if (i % 3 == 0) csv << "\"multi\nline, \\\"" << i << "\\\"\"\n";
+        else csv << " b" << i << "\n\n";
+    }
+    fs::path csv_file{"test.core.csv.test_read_csv_parallel.csv"};
+    for (bool quoted : {false, true}) {
+        {
+            std::ofstream fout{csv_file};
+            fout << (quoted ? csv.str() : simple_csv);
+        }
+        thread_pool pool{3};
+        for (int drop : {0, 2}) {
+            for (bool header : {false, true}) {
+                std::vector<std::vector<std::string>> desired_cols =
+                  read_csv(csv_file, drop, header).raw_cols();
+                for (std::size_t n_chunks : {1, 2, 7, 100}) {
+                    const dataframe<> df = read_csv_parallel(csv_file, drop, header, ',', '"', '\\',
+                                                             pool, n_chunks);
+                    std::vector<std::vector<std::string>> cols = df.raw_cols();
+                    BOOST_CHECK(cols == desired_cols);
+                    if (header) {
+                        test_ranges_equal(df.header(), read_csv(csv_file, drop).header());
+                    }
+                }
+            }
+        }
+    }
+    fs::remove(csv_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_read_csv_parallel_from_fifo)
+{
+    fs::path fifo{"test.core.csv.test_read_csv_parallel_from_fifo.csv"};
+    BOOST_REQUIRE(::mkfifo(fifo.c_str(), 0600) == 0);
+    std::thread writer{[&fifo]() {
+        std::ofstream fout{fifo};
+        fout << quoted_csv;
+    }};
+    const dataframe<> df = read_csv_parallel(fifo, 0, false, '|', '*', '+',
+                                             global_thread_pool(), 3);
+    writer.join();
+    BOOST_CHECK(df.raw_cols() == transpose(quoted_csv_rows));
+    fs::remove(fifo);
+}
+
+BOOST_AUTO_TEST_CASE(test_plain_csv_with_compression_prefix)
+{
+    // the first byte of the zstd magic number does not make the stream compressed
+    std::istringstream csv_ss{"(a, b\n1, 2\n"};
+    csv_istream_range rows{csv_ss};
+    auto it = ranges::begin(rows);
+    BOOST_CHECK(*it == (std::vector<std::string>{"(a", "b"}));
+    // nothing is read ahead from the caller's stream
+    BOOST_TEST(csv_ss.tellg() == 6);
+    csv_ss.seekg(0);
+    std::vector<std::vector<std::string>> cols = read_csv(csv_ss, 0, false).raw_cols();
+    BOOST_CHECK(cols == (std::vector<std::vector<std::string>>{{"(a", "1"}, {"b", "2"}}));
+}
+
+#ifdef CXTREAM_BUILD_GZIP
+BOOST_AUTO_TEST_CASE(test_read_gzip_csv)
+{
+    fs::path csv_file{"test.core.csv.test_read_gzip_csv.csv.gz"};
+    gzFile gz = gzopen(csv_file.c_str(), "wb");
+    gzwrite(gz, simple_csv.data(), simple_csv.size());
+    gzclose(gz);
+    std::istringstream simple_csv_ss{simple_csv};
+    std::vector<std::vector<std::string>> desired_cols = read_csv(simple_csv_ss).raw_cols();
+    std::vector<std::vector<std::string>> cols = read_csv(csv_file).raw_cols();
+    BOOST_CHECK(cols == desired_cols);
+    cols = read_csv_parallel(csv_file).raw_cols();
+    BOOST_CHECK(cols == desired_cols);
+    std::ifstream fin{csv_file, std::ios::binary};
+    cols = read_csv(fin).raw_cols();
+    BOOST_CHECK(cols == desired_cols);
+    BOOST_CHECK(copy_rows(mmap_csv(csv_file)) == simple_csv_rows);
+    // the compression is detected by the stream ranges as well
+    std::ifstream gz_fin{csv_file, std::ios::binary};
+    test_ranges_equal(csv_istream_range{gz_fin}, simple_csv_rows);
+    auto [ids] = read_csv_cols<int>(csv_file, {"Id"});
+    BOOST_CHECK(ids == (std::vector<int>{1, 2, 3}));
+    fs::remove(csv_file);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(test_file_exceptions)
+{
+    fs::path csv_file{"test.core.csv.test_file_exceptions.csv"};
+    for (auto& invalid_csv : invalid_csvs) {
+        {
+            std::ofstream fout{csv_file};
+            fout << invalid_csv;
+        }
+        BOOST_CHECK_THROW(read_csv(csv_file), std::ios_base::failure);
+        BOOST_CHECK_THROW(read_csv_parallel(csv_file, 0, true, ',', '"', '\\',
+                                            global_thread_pool(), 2),
+                          std::ios_base::failure);
+    }
+    fs::remove(csv_file);
+    BOOST_CHECK_THROW(read_csv_parallel("no_file.csv"), std::ios_base::failure);
+}
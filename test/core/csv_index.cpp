@@ -0,0 +1,186 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE csv_index_test
+
+#include <cxtream/core/csv_index.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <experimental/filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace cxtream;
+namespace fs = std::experimental::filesystem;
+
+template<typename Rng>
+std::vector<std::vector<std::string>> copy_rows(Rng&& rng)
+{
+    std::vector<std::vector<std::string>> rows;
+    for (const std::vector<std::string_view>& row : rng) {
+        rows.emplace_back(row.begin(), row.end());
+    }
+    return rows;
+}
+
+// generate a CSV with quoted newlines, blank lines and escaped quotes
+std::string generate_csv(std::size_t n_rows)
+{
+    std::string csv = "Id, Text, Note\n";
+    for (std::size_t i = 1; i < n_rows; ++i) {
+        csv += std::to_string(i) + ", ";
+        if (i % 3 == 0) csv += "\"multi\nline " + std::to_string(i) + "\"";
+        else if (i % 5 == 0) csv += "\"escaped \\\"" + std::to_string(i) + "\\\"\"";
+        else csv += "text " + std::to_string(i);
+        csv += i % 7 == 0 ? ", \"\n\"\n\n" : ", note\n";
+    }
+    return csv;
+}
+
+// write the data to the given file
+void write_file(const fs::path& file, const std::string& data)
+{
+    std::ofstream fout{file, std::ios::binary};
+    fout << data;
+}
+
+BOOST_AUTO_TEST_CASE(test_build)
+{
+    std::string csv = generate_csv(100);
+    csv_index index = csv_index::build(csv, 8);
+    BOOST_TEST(index.n_rows() == 100UL);
+    BOOST_TEST(index.step() == 8UL);
+    BOOST_TEST(index.buffer_size() == csv.size());
+    // the indexed block starts exactly at the row
+    auto [first, last, skip] = index.locate(24, 30);
+    BOOST_TEST(std::string_view{csv}.substr(first, 4) == "24, ");
+    BOOST_TEST(skip == 0UL);
+    BOOST_TEST(std::string_view{csv}.substr(last, 4) == "32, ");
+    std::tie(first, last, skip) = index.locate(27, 100);
+    BOOST_TEST(skip == 3UL);
+    BOOST_TEST(last == csv.size());
+    // the row 3 contains a quoted newline, the row 7 ends with a blank line
+    BOOST_TEST(csv_index::build(csv, 1).n_rows() == 100UL);
+    BOOST_TEST(csv_index::build("", 1).n_rows() == 1UL);
+    BOOST_CHECK_THROW(csv_index::build(csv, 0), std::invalid_argument);
+    BOOST_CHECK_THROW(index.locate(5, 101), std::out_of_range);
+    BOOST_CHECK_THROW(index.locate(5, 4), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_rows)
+{
+    fs::path csv_file{"test.core.csv_index.test_rows.csv"};
+    std::string csv = generate_csv(250);
+    write_file(csv_file, csv);
+    std::vector<std::vector<std::string>> all_rows = copy_rows(csv_buffer_range{csv});
+    BOOST_TEST(all_rows.size() == 250UL);
+    for (std::size_t step : {1, 2, 7, 64, 1024}) {
+        indexed_csv indexed{csv_file, step};
+        BOOST_TEST(indexed.n_rows() == 250UL);
+        for (std::size_t begin : {0, 1, 6, 7, 63, 64, 100, 249, 250}) {
+            for (std::size_t end : {begin, begin + 1, begin + 7, begin + 64, std::size_t{250}}) {
+                if (end > 250) continue;
+                std::vector<std::vector<std::string>> expected{all_rows.begin() + begin,
+                                                               all_rows.begin() + end};
+                BOOST_CHECK(copy_rows(indexed.rows(begin, end)) == expected);
+            }
+        }
+        BOOST_CHECK(indexed.row(0) == (std::vector<std::string>{"Id", "Text", "Note"}));
+        BOOST_CHECK(indexed.row(99) == all_rows[99]);
+        BOOST_CHECK_THROW(indexed.rows(10, 251), std::out_of_range);
+        BOOST_CHECK_THROW(indexed.row(250), std::out_of_range);
+    }
+    fs::remove(csv_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_shards)
+{
+    fs::path csv_file{"test.core.csv_index.test_shards.csv"};
+    std::string csv = generate_csv(1000);
+    write_file(csv_file, csv);
+    std::vector<std::vector<std::string>> all_rows = copy_rows(csv_buffer_range{csv});
+    const indexed_csv indexed{csv_file, 16};
+    // parse the data rows by multiple threads
+    std::vector<std::vector<std::vector<std::string>>> shards(7);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < shards.size(); ++i) {
+        workers.emplace_back([&indexed, &shards, i]() {
+            shards[i] = copy_rows(indexed.shard(i, shards.size(), 1));
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    std::vector<std::vector<std::string>> data_rows;
+    for (auto& shard : shards) data_rows.insert(data_rows.end(), shard.begin(), shard.end());
+    BOOST_CHECK(data_rows == (std::vector<std::vector<std::string>>{all_rows.begin() + 1,
+                                                                      all_rows.end()}));
+    BOOST_CHECK(copy_rows(indexed.shard(0, 1)) == all_rows);
+    BOOST_CHECK_THROW(indexed.shard(7, 7), std::out_of_range);
+    fs::remove(csv_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_and_load)
+{
+    fs::path csv_file{"test.core.csv_index.test_save_and_load.csv"};
+    fs::path index_file{"test.core.csv_index.test_save_and_load.csv.idx"};
+    write_file(csv_file, "A|B\n*1\n2*|3\n*+*x+**|4\n");
+    build_csv_index(csv_file, 2, '|', '*', '+').save(index_file);
+    csv_index index = csv_index::load(index_file);
+    BOOST_TEST(index.n_rows() == 3UL);
+    BOOST_TEST(index.step() == 2UL);
+    BOOST_TEST(index.separator() == '|');
+    BOOST_TEST(index.quote() == '*');
+    BOOST_TEST(index.escape() == '+');
+    // the dialect is stored in the index
+    indexed_csv indexed{csv_file, index};
+    BOOST_CHECK(indexed.row(1) == (std::vector<std::string>{"1\n2", "3"}));
+    BOOST_CHECK(indexed.row(2) == (std::vector<std::string>{"*x*", "4"}));
+    fs::remove(index_file);
+    fs::remove(csv_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_exceptions)
+{
+    fs::path csv_file{"test.core.csv_index.test_exceptions.csv"};
+    fs::path index_file{"test.core.csv_index.test_exceptions.csv.idx"};
+    write_file(csv_file, generate_csv(100));
+    build_csv_index(csv_file, 10).save(index_file);
+    BOOST_CHECK_THROW(csv_index::load("no_file.idx"), std::ios_base::failure);
+    BOOST_CHECK_THROW(build_csv_index("no_file.csv"), std::ios_base::failure);
+    // not an index
+    BOOST_CHECK_THROW(csv_index::load(csv_file), std::ios_base::failure);
+    // truncated index
+    std::string index_data;
+    {
+        std::ifstream fin{index_file, std::ios::binary};
+        index_data.assign(std::istreambuf_iterator<char>{fin}, std::istreambuf_iterator<char>{});
+    }
+    write_file(index_file, index_data.substr(0, index_data.size() - 1));
+    BOOST_CHECK_THROW(csv_index::load(index_file), std::ios_base::failure);
+    // offsets not matching the file size
+    index_data[index_data.size() - 1] = '\x01';
+    write_file(index_file, index_data);
+    BOOST_CHECK_THROW(csv_index::load(index_file), std::ios_base::failure);
+    // stale index
+    csv_index index = build_csv_index(csv_file, 10);
+    write_file(csv_file, generate_csv(101));
+    BOOST_CHECK_THROW((indexed_csv{csv_file, index}), std::ios_base::failure);
+    // compressed file
+    write_file(csv_file, std::string{"\x1f\x8b\x08\x00", 4});
+    BOOST_CHECK_THROW(build_csv_index(csv_file), std::ios_base::failure);
+    BOOST_CHECK_THROW(indexed_csv{csv_file}, std::ios_base::failure);
+    fs::remove(index_file);
+    fs::remove(csv_file);
+}
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ragged_test
+
+#include <cxtream/core/ragged.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace cxtream;
+
+using splits_t = std::vector<std::size_t>;
+
+BOOST_AUTO_TEST_CASE(test_construction)
+{
+    ragged<int, 2> r{{1, 2}, {3}, {}, {4, 5, 6}};
+    BOOST_TEST(r.size() == 4U);
+    BOOST_TEST(r.numel() == 6U);
+    BOOST_CHECK(r.values() == (std::vector<int>{1, 2, 3, 4, 5, 6}));
+    BOOST_CHECK(r.row_splits(0) == (splits_t{0, 2, 3, 3, 6}));
+    BOOST_TEST(r[0].size() == 2U);
+    BOOST_TEST(r[2].empty());
+    BOOST_TEST(r[3][1] == 5);
+    BOOST_TEST(*r[3].data() == 4);
+    BOOST_CHECK_THROW(r.at(4), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_from_nested_vector_3d)
+{
+    std::vector<std::vector<std::vector<int>>> data = {{{1}, {2, 3}}, {}, {{4, 5, 6}}};
+    ragged<int, 3> r(data);
+    BOOST_TEST(r.size() == 3U);
+    BOOST_CHECK(r.values() == (std::vector<int>{1, 2, 3, 4, 5, 6}));
+    BOOST_CHECK(r.row_splits(0) == (splits_t{0, 2, 2, 3}));
+    BOOST_CHECK(r.row_splits(1) == (splits_t{0, 1, 3, 6}));
+    BOOST_TEST(r[0].size() == 2U);
+    BOOST_TEST(r[0].numel() == 3U);
+    BOOST_TEST(r[0][1][1] == 3);
+    BOOST_TEST(r[2][0].size() == 3U);
+    BOOST_CHECK((r == ragged<int, 3>(data)));
+    BOOST_CHECK((r[0] == ragged<int, 2>{{1}, {2, 3}}));
+    BOOST_CHECK((r[0] != ragged<int, 2>{{1}, {2, 4}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_push_back_views)
+{
+    ragged<int, 3> src(std::vector<std::vector<std::vector<int>>>{{{1}, {2, 3}}, {{4, 5, 6}}});
+    ragged<int, 3> dst;
+    dst.reserve(3);
+    dst.push_back(src[1]);
+    dst.push_back(ragged<int, 2>{});
+    dst.push_back(src[0]);
+    BOOST_TEST(dst.size() == 3U);
+    BOOST_CHECK(dst.values() == (std::vector<int>{4, 5, 6, 1, 2, 3}));
+    BOOST_CHECK(dst.row_splits(0) == (splits_t{0, 1, 1, 3}));
+    BOOST_CHECK(dst.row_splits(1) == (splits_t{0, 3, 4, 6}));
+    BOOST_CHECK(dst[2] == src[0]);
+}
+
+BOOST_AUTO_TEST_CASE(test_insert_clear_resize)
+{
+    ragged<int, 2> src{{1, 2}, {3}, {4, 5, 6}};
+    ragged<int, 2> dst{{7}};
+    dst.insert(dst.end(), src.begin() + 1, src.end());
+    BOOST_CHECK(dst == (ragged<int, 2>{{7}, {3}, {4, 5, 6}}));
+    dst.resize(2);
+    BOOST_CHECK(dst == (ragged<int, 2>{{7}, {3}}));
+    BOOST_TEST(dst.numel() == 2U);
+    dst.resize(3);
+    BOOST_TEST(dst[2].empty());
+    dst.clear();
+    BOOST_TEST(dst.empty());
+    BOOST_TEST(dst.numel() == 0U);
+    dst.push_back(std::vector<int>{8, 9});
+    BOOST_CHECK(dst == (ragged<int, 2>{{8, 9}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_copy_view)
+{
+    ragged<int, 2> src{{1, 2}, {3}, {4, 5, 6}};
+    ragged<int, 1> row = src[2];
+    BOOST_CHECK(row.values() == (std::vector<int>{4, 5, 6}));
+    // the mutable view modifies the original data
+    for (int& v : src[0]) v *= 10;
+    BOOST_CHECK(src == (ragged<int, 2>{{10, 20}, {3}, {4, 5, 6}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_to_tensor)
+{
+    ragged<int, 2> r{{1, 2}, {3}, {}, {4, 5, 6}};
+    BOOST_CHECK(r.max_shape() == (std::array<std::size_t, 2>{4, 3}));
+    BOOST_CHECK(r.to_tensor(-1) == (tensor<int, 2>{{1, 2, -1}, {3, -1, -1},
+                                                   {-1, -1, -1}, {4, 5, 6}}));
+    BOOST_CHECK(r.mask<char>() == (tensor<char, 2>{{1, 1, 0}, {1, 0, 0},
+                                                   {0, 0, 0}, {1, 1, 1}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_to_tensor_3d)
+{
+    ragged<int, 3> r(std::vector<std::vector<std::vector<int>>>{{{1}, {2, 3}}, {{4}}});
+    tensor<int, 3> dense = r.to_tensor();
+    BOOST_CHECK(dense == (tensor<int, 3>{{{1, 0}, {2, 3}}, {{4, 0}, {0, 0}}}));
+    tensor<std::uint8_t, 3> mask = r.mask();
+    BOOST_CHECK(mask == (tensor<std::uint8_t, 3>{{{1, 0}, {1, 1}}, {{1, 0}, {0, 0}}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_pad)
+{
+    ragged<int, 2> r{{1, 2}, {3}, {}, {4, 5, 6}};
+    ragged<int, 2> padded;
+    tensor<char, 2> mask;
+    r.pad(-1, padded, mask);
+    BOOST_CHECK(padded.row_splits(0) == (splits_t{0, 3, 6, 9, 12}));
+    BOOST_CHECK(padded == (ragged<int, 2>{{1, 2, -1}, {3, -1, -1}, {-1, -1, -1}, {4, 5, 6}}));
+    BOOST_CHECK(mask == r.mask<char>());
+    tensor<int, 2> dense;
+    ragged<char, 2> ragged_mask;
+    r.pad(-1, dense, ragged_mask);
+    BOOST_CHECK(dense == r.to_tensor(-1));
+    BOOST_CHECK(ragged_mask == (ragged<char, 2>{{1, 1, 0}, {1, 0, 0}, {0, 0, 0}, {1, 1, 1}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_from_shape)
+{
+    ragged<int, 3> r(std::array<std::size_t, 3>{2, 3, 1}, 7);
+    BOOST_CHECK(r.row_splits(0) == (splits_t{0, 3, 6}));
+    BOOST_CHECK(r.row_splits(1) == (splits_t{0, 1, 2, 3, 4, 5, 6}));
+    BOOST_TEST(r.values() == std::vector<int>(6, 7), boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_from_tensor)
+{
+    tensor<int, 2> dense{{1, 2, 3}, {4, 5, 6}};
+    ragged<int, 2> r{dense};
+    BOOST_CHECK(r.row_splits(0) == (splits_t{0, 3, 6}));
+    BOOST_CHECK(r == (ragged<int, 2>{{1, 2, 3}, {4, 5, 6}}));
+    BOOST_CHECK(r.to_tensor() == dense);
+}
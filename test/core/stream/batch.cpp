@@ -166,8 +166,50 @@ BOOST_AUTO_TEST_CASE(test_infinite_batch)
     BOOST_CHECK(++rng_it == rng.end());
     BOOST_TEST(result_unique.size() == 12);
     BOOST_TEST(result_shared.size() == 12);
+    // the storage is not reserved for the infinite batch size
+    BOOST_TEST(std::get<0>(result).value().capacity() < 100U);
 
     auto desired = ranges::view::iota(0, 12);
     test_ranges_equal(result_unique, desired);
     test_ranges_equal(result_shared, desired);
 }
+
+BOOST_AUTO_TEST_CASE(test_batch_recycles_storage)
+{
+    // the storage of the previous batch should be reused for the next one
+    auto data = generate_batched_data({1, 2, 3, 2, 1, 3, 2, 1, 1, 4});
+    auto rng = data | ranges::view::move | batch(4);
+
+    std::vector<int> result;
+    const std::unique_ptr<int>* storage = nullptr;
+    int batch_n = 0;
+    for (auto&& tuple : rng) {
+        auto& uniques = std::get<0>(tuple).value();
+        BOOST_TEST(uniques.size() == 4U);
+        // only the first subbatch is reserved for, the rest grows geometrically
+        BOOST_TEST(uniques.capacity() >= 4U);
+        if (batch_n++ == 0) storage = uniques.data();
+        else BOOST_TEST(uniques.data() == storage);
+        for (auto& ptr : uniques) result.push_back(*ptr);
+    }
+    BOOST_TEST(batch_n == 5);
+    test_ranges_equal(result, ranges::view::iota(0, 20));
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_copied_iterator)
+{
+    // the batch referred to by a copy of the iterator should stay untouched
+    auto data = generate_regular_batched_data(4, 2);
+    auto rng = data | ranges::view::move | batch(3);
+
+    auto it = ranges::begin(rng);
+    auto copy = it;
+    ++it;
+    BOOST_TEST(std::get<0>(*copy).value().size() == 3U);
+    BOOST_TEST(*std::get<0>(*copy).value()[0] == 0);
+    BOOST_TEST(*std::get<0>(*it).value()[0] == 3);
+    ++it;
+    BOOST_TEST(std::get<0>(*it).value().size() == 2U);
+    BOOST_TEST(*std::get<0>(*it).value()[0] == 6);
+    BOOST_TEST(*std::get<0>(*copy).value()[2] == 2);
+}
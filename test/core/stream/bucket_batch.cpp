@@ -0,0 +1,116 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE bucket_batch_test
+
+#include "common.hpp"
+
+#include <cxtream/core/stream/bucket_batch.hpp>
+#include <cxtream/core/stream/create.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/move.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace cxtream::stream;
+
+CXTREAM_DEFINE_COLUMN(sequence, std::vector<int>)
+
+BOOST_AUTO_TEST_CASE(test_full_buckets)
+{
+    auto data = generate_sequences({1, 5, 2, 6, 7, 3, 8, 4});
+    // buckets [0, 5) and [5, inf)
+    auto rng = data | create<sequence>(3) | bucket_batch(from<sequence>, {5}, 2);
+    auto lengths = batch_lengths<sequence>(collect_batches(rng));
+    std::vector<std::vector<std::size_t>> desired = {{1, 2}, {5, 6}, {7, 8}, {3, 4}};
+    BOOST_CHECK(lengths == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_flush)
+{
+    auto data = generate_sequences({1, 5, 2, 6, 7, 3, 9});
+    auto rng = data | create<sequence>(2) | bucket_batch(from<sequence>, {5}, 3);
+    auto lengths = batch_lengths<sequence>(collect_batches(rng));
+    // the full bucket is yielded first, the rest is flushed at the end, the largest first
+    std::vector<std::vector<std::size_t>> desired = {{5, 6, 7}, {1, 2, 3}, {9}};
+    BOOST_CHECK(lengths == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_budget)
+{
+    auto data = generate_sequences({1, 10, 20, 2, 11, 30});
+    // three buckets, at most three buffered examples
+    auto rng = data | create<sequence>(1) | bucket_batch(from<sequence>, {10, 20}, 2, 3);
+    auto lengths = batch_lengths<sequence>(collect_batches(rng));
+    // the budget is reached after the first three examples and again after the fourth,
+    // all the buckets are equally large in both cases, so the first one is yielded
+    std::vector<std::vector<std::size_t>> desired = {{1}, {2}, {10, 11}, {20, 30}};
+    BOOST_CHECK(lengths == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_all_examples_preserved)
+{
+    std::vector<std::size_t> lengths_in;
+    for (std::size_t i = 0; i < 100; ++i) lengths_in.push_back((i * 37) % 50 + 1);
+    auto data = generate_sequences(lengths_in);
+    auto rng = data | create<sequence>(7) | bucket_batch(from<sequence>, {10, 20, 30, 40}, 8);
+    std::vector<int> indices;
+    for (auto&& batch : rng) {
+        auto& seqs = std::get<sequence>(batch).value();
+        BOOST_TEST(seqs.size() <= 8U);
+        for (auto& seq : seqs) {
+            // all the sequences in the batch fall into the same bucket
+            auto bucket = [](std::size_t length) { return std::min<std::size_t>(length / 10, 4); };
+            BOOST_TEST(bucket(seq.size()) == bucket(seqs[0].size()));
+            indices.push_back(seq[0] / 10);
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+    test_ranges_equal(indices, ranges::view::iota(0, 100));
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only)
+{
+    std::vector<std::tuple<Int, UniqueVec>> data;
+    for (int i = 0; i < 6; ++i) {
+        std::vector<std::vector<std::unique_ptr<int>>> batch(1);
+        for (int j = 0; j < i % 3 + 1; ++j) batch[0].push_back(std::make_unique<int>(i));
+        data.emplace_back(Int{i}, UniqueVec{std::move(batch)});
+    }
+    auto rng = data | ranges::view::move | bucket_batch(from<UniqueVec>, {2}, 2);
+    std::vector<std::vector<int>> ids;
+    for (auto&& batch : rng) {
+        ids.push_back(std::get<Int>(batch).value());
+        auto& unique_vecs = std::get<UniqueVec>(batch).value();
+        for (std::size_t i = 0; i < unique_vecs.size(); ++i) {
+            for (auto& ptr : unique_vecs[i]) BOOST_TEST(*ptr == ids.back()[i]);
+        }
+    }
+    std::vector<std::vector<int>> desired = {{1, 2}, {0, 3}, {4, 5}};
+    BOOST_CHECK(ids == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_empty)
+{
+    std::vector<std::vector<int>> data;
+    auto rng = data | create<sequence>(3) | bucket_batch(from<sequence>, {5}, 2);
+    BOOST_TEST(collect_batches(rng).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_unsorted_boundaries)
+{
+    auto data = generate_sequences({1, 2});
+    BOOST_CHECK_THROW(data | create<sequence>(1) | bucket_batch(from<sequence>, {5, 3}, 2),
+                      std::invalid_argument);
+}
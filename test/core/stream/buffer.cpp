@@ -12,15 +12,21 @@
 
 #include "../common.hpp"
 
+#include <cxtream/core/stream/batch.hpp>
 #include <cxtream/core/stream/buffer.hpp>
 #include <cxtream/core/stream/transform.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include <range/v3/view/indirect.hpp>
 #include <range/v3/view/iota.hpp>
+#include <range/v3/to_container.hpp>
+#include <range/v3/view/take.hpp>
 #include <range/v3/view/transform.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 using namespace cxtream::stream;
@@ -41,11 +47,11 @@ BOOST_AUTO_TEST_CASE(test_simple_traverse)
     auto rng2 = data | buffer(2);
 
     auto it1 = ranges::begin(rng1);
-    static_assert(std::is_same<const int&, decltype(*it1)>{});
+    static_assert(std::is_same<int&, decltype(*it1)>{});
     BOOST_TEST(*it1 == 1);
 
     auto it2 = ranges::begin(rng2);
-    static_assert(std::is_same<const int&, decltype(*it2)>{});
+    static_assert(std::is_same<int&, decltype(*it2)>{});
     BOOST_TEST(*it2 == 1);
 
     test_ranges_equal(rng1, data);
@@ -65,6 +71,67 @@ BOOST_AUTO_TEST_CASE(test_move_only_data)
     test_ranges_equal(rng, ranges::view::iota(1, 6));
 }
 
+BOOST_AUTO_TEST_CASE(test_repeated_dereference)
+{
+    // the element is not moved from when it is dereferenced
+    std::vector<std::vector<int>> data = {{1, 2}, {3}};
+    auto rng = data | buffer(2);
+    auto it = ranges::begin(rng);
+    BOOST_TEST(*it == data[0]);
+    BOOST_TEST(*it == data[0]);
+    ++it;
+    BOOST_TEST(*it == data[1]);
+    BOOST_TEST(*it == data[1]);
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only_batch)
+{
+    // check that move only columns can be batched after buffering
+    auto rng = ranges::view::iota(0, 6)
+      | ranges::view::transform([](int i) {
+          return std::make_tuple(Unique{std::make_unique<int>(i)});
+        })
+      | buffer(2)
+      | batch(3);
+
+    int i = 0;
+    for (auto&& batch : rng) {
+        BOOST_TEST(std::get<0>(batch).value().size() == 3U);
+        for (auto& ptr : std::get<0>(batch).value()) BOOST_TEST(*ptr == i++);
+    }
+    BOOST_TEST(i == 6);
+}
+
+// A value counting its copies.
+struct copy_counter {
+    static std::atomic<int> n_copies;
+    copy_counter() = default;
+    copy_counter(copy_counter&&) = default;
+    copy_counter& operator=(copy_counter&&) = default;
+    copy_counter(const copy_counter&) { ++n_copies; }
+    copy_counter& operator=(const copy_counter&) { ++n_copies; return *this; }
+};
+std::atomic<int> copy_counter::n_copies{0};
+
+CXTREAM_DEFINE_COLUMN(Counted, copy_counter)
+
+BOOST_AUTO_TEST_CASE(test_no_batch_copy)
+{
+    // the batches are moved from the buffer to the consumer
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int) {
+          return std::make_tuple(Counted{std::vector<copy_counter>(5)});
+        })
+      | buffer(3)
+      | batch(20);
+
+    copy_counter::n_copies = 0;
+    std::size_t n_examples = 0;
+    for (auto&& batch : rng) n_examples += std::get<0>(batch).value().size();
+    BOOST_TEST(n_examples == 50U);
+    BOOST_TEST(copy_counter::n_copies == 0);
+}
+
 BOOST_AUTO_TEST_CASE(test_check_if_buffered)
 {
     // check if it is really buffer
@@ -100,36 +167,38 @@ BOOST_AUTO_TEST_CASE(test_check_if_buffered)
     // iterate with two iterators at once
     auto it2 = ranges::begin(rng);
     std::this_thread::sleep_for(20ms);
+    // nothing is evaluated until the first access
+    test_use_count(data, {1, 1, 1, 1, 1});
+    BOOST_TEST(**it2 == 0);
+    std::this_thread::sleep_for(20ms);
     test_use_count(data, {2, 2, 1, 1, 1});
     auto it3 = ranges::begin(rng);
+    BOOST_TEST(**it3 == 0);
     std::this_thread::sleep_for(20ms);
     test_use_count(data, {3, 3, 1, 1, 1});
     ++it2;
     std::this_thread::sleep_for(20ms);
     test_use_count(data, {2, 3, 2, 1, 1});
-    static_assert(std::is_same<const std::shared_ptr<int>&, decltype(*it)>{});
+    static_assert(std::is_same<std::shared_ptr<int>&, decltype(*it)>{});
 
     // check values
     test_ranges_equal(rng | ranges::view::indirect, ranges::view::iota(0, 5));
 }
 
-BOOST_AUTO_TEST_CASE(test_buffer_whole_range)
+BOOST_AUTO_TEST_CASE(test_buffer_default_size)
 {
-    // check infinite size buffer
+    // by default, the buffer size is the number of threads
+    cxtream::thread_pool pool{2};
     std::vector<std::shared_ptr<int>> data;
     for (int i = 0; i < 5; ++i) data.emplace_back(std::make_shared<int>(i));
-    auto rng = data | buffer;
+    auto rng = data | buffer(0, pool);
     BOOST_TEST(rng.size() == data.size());
 
-    // iterate through and check not-yet visited elements' use count
-    test_use_count(data, {1, 1, 1, 1, 1});
     auto it = ranges::begin(rng);
     BOOST_CHECK(it != ranges::end(rng));
     std::this_thread::sleep_for(40ms);
-    test_use_count(data, {2, 2, 2, 2, 2});
+    test_use_count(data, {2, 2, 1, 1, 1});
     ++it;
-    std::this_thread::sleep_for(20ms);
-    test_use_count(data, {1, 2, 2, 2, 2});
     ++it;
     ++it;
     ++it;
@@ -139,6 +208,221 @@ BOOST_AUTO_TEST_CASE(test_buffer_whole_range)
     test_use_count(data, {1, 1, 1, 1, 1});
 }
 
+BOOST_AUTO_TEST_CASE(test_lazy_take)
+{
+    // only the taken elements and the buffered elements are evaluated
+    std::atomic<int> n_evaluated{0};
+    auto rng = ranges::view::iota(0, 100)
+      | ranges::view::transform([&n_evaluated](int i) {
+            ++n_evaluated;
+            return i;
+        })
+      | buffer(2);
+    auto it = ranges::begin(rng);
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 0);
+    test_ranges_equal(rng | ranges::view::take(3), ranges::view::iota(0, 3));
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated <= 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_byte_budget)
+{
+    // each element occupies sizeof(std::vector<char>) + 1000 bytes
+    std::atomic<int> n_evaluated{0};
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([&n_evaluated](int i) {
+            ++n_evaluated;
+            return std::vector<char>(1000, (char)i);
+        })
+      | buffer(byte_budget{3 * (sizeof(std::vector<char>) + 1000)});
+    auto it = ranges::begin(rng);
+    // the size of the elements is not known yet, so only a single one is evaluated
+    BOOST_CHECK(it != ranges::end(rng));
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 1);
+    // once the first element is measured, three elements fit into the budget
+    BOOST_TEST((*it)[0] == 0);
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 3);
+    // skipping an element does not wait for it
+    ++it;
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 4);
+    BOOST_TEST((*it)[0] == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_on_destruction)
+{
+    // the elements which are not yet being evaluated are cancelled
+    // when the consumer is destroyed and the running ones are waited for
+    cxtream::thread_pool pool{1};
+    std::atomic<int> n_evaluated{0};
+    std::atomic<bool> running{false};
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([&n_evaluated, &running](int i) {
+            running = true;
+            std::this_thread::sleep_for(20ms);
+            ++n_evaluated;
+            running = false;
+            return i;
+        })
+      | buffer(10, pool);
+    {
+        auto it = ranges::begin(rng);
+        BOOST_TEST(*it == 0);
+    }
+    BOOST_CHECK(!running);
+    int n_after_destruction = n_evaluated;
+    BOOST_TEST(n_after_destruction < 10);
+    std::this_thread::sleep_for(100ms);
+    BOOST_TEST(n_evaluated == n_after_destruction);
+}
+
+BOOST_AUTO_TEST_CASE(test_unordered)
+{
+    // a slow element does not stall the others
+    cxtream::thread_pool pool{2};
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) {
+            if (i == 0) std::this_thread::sleep_for(100ms);
+            return i;
+        })
+      | buffer_unordered(4, pool);
+
+    std::vector<int> generated = rng | ranges::to_vector;
+    BOOST_TEST(generated.size() == 10U);
+    BOOST_TEST(generated.front() != 0);
+    std::sort(generated.begin(), generated.end());
+    test_ranges_equal(generated, ranges::view::iota(0, 10));
+}
+
+BOOST_AUTO_TEST_CASE(test_unordered_bounded)
+{
+    // at most the given number of elements is evaluated in advance
+    std::atomic<int> n_evaluated{0};
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([&n_evaluated](int i) {
+            ++n_evaluated;
+            return i;
+        })
+      | buffer_unordered(3);
+    auto it = ranges::begin(rng);
+    BOOST_CHECK(it != ranges::end(rng));
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 3);
+    ++it;
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_unordered_exception)
+{
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) {
+            if (i == 5) throw std::invalid_argument{"5"};
+            return i;
+        })
+      | buffer_unordered(3);
+    BOOST_CHECK_THROW(rng | ranges::to_vector, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_of_buffer)
+{
+    // a buffer can feed another buffer
+    std::atomic<int> n_evaluated{0};
+    auto rng = ranges::view::iota(0, 20)
+      | ranges::view::transform([&n_evaluated](int i) {
+            ++n_evaluated;
+            return i;
+        })
+      | buffer(2)
+      | ranges::view::transform([](int i) { return 2 * i; })
+      | buffer(3);
+    static_assert(!ranges::ForwardRange<decltype(rng)>());
+    auto it = ranges::begin(rng);
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated == 0);
+    BOOST_TEST(*it == 0);
+    std::this_thread::sleep_for(20ms);
+    // at most the elements buffered by both the buffers are evaluated
+    BOOST_TEST(n_evaluated <= 1 + 3 + 2 + 1);
+    test_ranges_equal(rng, ranges::view::iota(0, 20) | ranges::view::transform([](int i) {
+        return 2 * i;
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_of_buffer_move_only)
+{
+    // the elements of the inner buffer are moved to the outer buffer
+    auto rng = ranges::view::iota(1, 6)
+      | ranges::view::transform([](int i) {
+          return std::make_unique<int>(i);
+        })
+      | buffer(2)
+      | buffer(2)
+      | ranges::view::indirect;
+
+    test_ranges_equal(rng, ranges::view::iota(1, 6));
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_of_buffer_no_batch_copy)
+{
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int) {
+          return std::make_tuple(Counted{std::vector<copy_counter>(5)});
+        })
+      | buffer(3)
+      | batch(20)
+      | buffer(1);
+
+    copy_counter::n_copies = 0;
+    std::size_t n_examples = 0;
+    for (auto&& batch : rng) n_examples += std::get<0>(batch).value().size();
+    BOOST_TEST(n_examples == 50U);
+    BOOST_TEST(copy_counter::n_copies == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_of_buffer_byte_budget)
+{
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) {
+            return std::vector<char>(1000, (char)i);
+        })
+      | buffer(2)
+      | buffer(byte_budget{3 * (sizeof(std::vector<char>) + 1000)});
+
+    int i = 0;
+    for (auto&& elem : rng) {
+        BOOST_TEST(elem.size() == 1000U);
+        BOOST_TEST(elem[0] == i++);
+    }
+    BOOST_TEST(i == 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_of_buffer_exception)
+{
+    // the failed element is skipped and the rest of the elements are still evaluated
+    auto rng = ranges::view::iota(0, 5)
+      | ranges::view::transform([](int i) {
+            if (i == 2) throw std::invalid_argument{"2"};
+            return i;
+        })
+      | buffer_unordered(1)
+      | buffer(2);
+
+    std::vector<int> generated;
+    for (auto it = ranges::begin(rng); it != ranges::end(rng); ++it) {
+        try {
+            generated.push_back(*it);
+        } catch (const std::invalid_argument&) {
+            generated.push_back(-1);
+        }
+    }
+    std::vector<int> desired = {0, 1, -1, 3, 4};
+    BOOST_TEST(generated == desired);
+}
+
 BOOST_AUTO_TEST_CASE(test_buffer_transformed_stream)
 {
     std::vector<std::tuple<Int, Double>> data = {{{3, 7}, {5., 1.}}, {1, 2.}};
@@ -152,3 +436,38 @@ BOOST_AUTO_TEST_CASE(test_buffer_transformed_stream)
     std::vector<std::tuple<Double, Int>> desired = {{{3 + 5., 7 + 1.}, {3, 7}}, {1 + 2., 1}};
     test_ranges_equal(generated, desired);
 }
+
+BOOST_AUTO_TEST_CASE(test_buffer_transformed_buffered_stream)
+{
+    // a buffered stream can be transformed and buffered again
+    auto generated = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) { return std::make_tuple(Int{i}); })
+      | buffer(2)
+      | transform(from<Int>, to<Double>, [](int i) { return (double)i / 2; })
+      | buffer(2);
+
+    int i = 0;
+    for (auto&& [dbl, in] : generated) {
+        BOOST_TEST(in.value() == std::vector<int>{i});
+        BOOST_TEST(dbl.value() == std::vector<double>{(double)i / 2});
+        ++i;
+    }
+    BOOST_TEST(i == 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_transform_after_buffer_no_copy)
+{
+    // the elements of a buffer are moved to the transformation
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) {
+          return std::make_tuple(Counted{std::vector<copy_counter>(5)}, Int{i});
+        })
+      | buffer(2)
+      | transform(from<Int>, to<Double>, [](int i) { return (double)i; });
+
+    copy_counter::n_copies = 0;
+    std::size_t n_examples = 0;
+    for (auto&& tuple : rng) n_examples += std::get<Counted>(tuple).value().size();
+    BOOST_TEST(n_examples == 50U);
+    BOOST_TEST(copy_counter::n_copies == 0);
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#ifndef TEST_STREAM_COMMON_HPP
+#define TEST_STREAM_COMMON_HPP
+
+#include "../common.hpp"
+
+#include <cxtream/core/stream/batch.hpp>
+
+#include <range/v3/core.hpp>
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// generate sequences of the given lengths, the example i contains 10*i, 10*i+1, ...
+std::vector<std::vector<int>> generate_sequences(std::vector<std::size_t> lengths)
+{
+    std::vector<std::vector<int>> data;
+    for (std::size_t i = 0; i < lengths.size(); ++i) {
+        data.emplace_back();
+        for (std::size_t j = 0; j < lengths[i]; ++j) data.back().push_back(10 * i + j);
+    }
+    return data;
+}
+
+// move all the batches of a (possibly single pass) stream to a vector
+template<typename Rng>
+auto collect_batches(Rng&& rng)
+{
+    std::vector<std::decay_t<decltype(*ranges::begin(rng))>> batches;
+    for (auto&& batch : rng) batches.push_back(std::move(batch));
+    return batches;
+}
+
+// get the number of examples in each batch
+template<typename Batches>
+std::vector<std::size_t> batch_sizes(const Batches& batches)
+{
+    std::vector<std::size_t> sizes;
+    for (auto& batch : batches) sizes.push_back(cxtream::stream::batch_size(batch));
+    return sizes;
+}
+
+// get the lengths of the sequences of the given column in each batch
+template<typename Column, typename Batches>
+std::vector<std::vector<std::size_t>> batch_lengths(const Batches& batches)
+{
+    std::vector<std::vector<std::size_t>> lengths;
+    for (auto& batch : batches) {
+        lengths.emplace_back();
+        for (auto& seq : std::get<Column>(batch).value()) lengths.back().push_back(seq.size());
+    }
+    return lengths;
+}
+
+// concatenate the examples of the given column from all the batches
+template<typename Column, typename Batches>
+typename Column::batch_type flatten_column(const Batches& batches)
+{
+    typename Column::batch_type examples;
+    for (auto& batch : batches) {
+        auto& values = std::get<Column>(batch).value();
+        examples.insert(examples.end(), values.begin(), values.end());
+    }
+    return examples;
+}
+
+#endif
@@ -12,6 +12,9 @@
 
 #include "filter.hpp"
 
+#include <cxtream/core/stream/buffer.hpp>
+#include <cxtream/core/stream/pipe.hpp>
+
 using namespace cxtream::stream;
 
 BOOST_AUTO_TEST_CASE(test_mutable)
@@ -97,3 +100,58 @@ BOOST_AUTO_TEST_CASE(test_dim2_move_only)
       | ranges::to_vector;
     BOOST_TEST(i == 3);
 }
+
+BOOST_AUTO_TEST_CASE(test_dim0_single_evaluation)
+{
+    // the transformations before the batch filter should be evaluated only once per batch
+    const std::vector<int> data = {3, 1, 7, 8, 2, 6};
+
+    int n_evaluations = 0;
+    auto generated = data
+      | create<Int>(2)
+      | transform(from<Int>, to<Int>, [&n_evaluations](const std::vector<int>& v) {
+            ++n_evaluations;
+            return v;
+        }, dim<0>)
+      | filter(from<Int>, by<Int>, [](const std::vector<int>& v) { return v.at(0) > 2; }, dim<0>)
+      | ranges::to_vector;
+    BOOST_TEST(n_evaluations == 3);
+    BOOST_TEST(generated.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_dim0_buffer)
+{
+    // the materialized batch filter is still a forward range, so it can be buffered
+    const std::vector<int> data = {3, 1, 7, 8, 2, 6, 5, 4};
+
+    auto rng = data
+      | create<Int>(2)
+      | transform(from<Int>, to<Int>, [](int v) { return v * 10; })
+      | filter(from<Int>, by<Int>, [](const std::vector<int>& v) { return v.at(0) > 20; }, dim<0>);
+    static_assert(ranges::ForwardRange<decltype(rng)>());
+    std::vector<int> generated;
+    for (auto&& batch : rng | buffer(2)) {
+        auto& values = std::get<Int>(batch).value();
+        generated.insert(generated.end(), values.begin(), values.end());
+    }
+    test_ranges_equal(generated, std::vector<int>{30, 10, 70, 80, 50, 40});
+}
+
+BOOST_AUTO_TEST_CASE(test_dim0_pipe_buffer)
+{
+    // the batch filter of a single pass range is a single pass range,
+    // so the buffer does not share its iterator with the evaluation tasks
+    const std::vector<int> data = {3, 1, 7, 8, 2, 6, 5, 4};
+
+    auto rng = data
+      | create<Int>(2)
+      | pipe(2)
+      | filter(from<Int>, by<Int>, [](const std::vector<int>& v) { return v.at(0) > 2; }, dim<0>);
+    static_assert(!ranges::ForwardRange<decltype(rng)>());
+    std::vector<int> generated;
+    for (auto&& batch : rng | buffer(2)) {
+        auto& values = std::get<Int>(batch).value();
+        generated.insert(generated.end(), values.begin(), values.end());
+    }
+    test_ranges_equal(generated, std::vector<int>{3, 1, 7, 8, 5, 4});
+}
@@ -0,0 +1,121 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE from_csv_test
+
+#include "../common.hpp"
+
+#include <cxtream/core/stream/from_csv.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <experimental/filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cxtream::stream;
+namespace fs = std::experimental::filesystem;
+
+CXTREAM_DEFINE_COLUMN(Name, std::string)
+
+const std::string csv{
+  "Id, Name, Value, Note\n"
+  " 1, a, 0.5, \"x, y\"\n"
+  "-2, \"b, c\", 1e3, z\n"
+  " 3, d, -0.25, w\n"
+  " 4, e, 2, v\n"
+  " 5, f, 0, u\n"
+};
+
+BOOST_AUTO_TEST_CASE(test_batches)
+{
+    std::istringstream in{csv};
+    auto rng = from_csv<Int, Double, Name>(in, 2, {"Id", "Value", "Name"});
+    std::vector<std::vector<int>> ids;
+    std::vector<double> values;
+    std::vector<std::string> names;
+    for (auto&& batch : rng) {
+        ids.push_back(std::get<Int>(batch).value());
+        auto& batch_values = std::get<Double>(batch).value();
+        values.insert(values.end(), batch_values.begin(), batch_values.end());
+        auto& batch_names = std::get<Name>(batch).value();
+        names.insert(names.end(), batch_names.begin(), batch_names.end());
+    }
+    BOOST_CHECK(ids == (std::vector<std::vector<int>>{{1, -2}, {3, 4}, {5}}));
+    BOOST_CHECK(values == (std::vector<double>{0.5, 1000., -0.25, 2., 0.}));
+    BOOST_CHECK(names == (std::vector<std::string>{"a", "b, c", "d", "e", "f"}));
+}
+
+BOOST_AUTO_TEST_CASE(test_incremental)
+{
+    std::istringstream in{csv};
+    auto rng = from_csv<Int>(in, 1, {"Id"});
+    auto it = rng.begin();
+    BOOST_CHECK(std::get<Int>(*it).value() == std::vector<int>{1});
+    // only the header and the first row have been read so far
+    BOOST_TEST(static_cast<std::streamoff>(in.tellg())
+               <= static_cast<std::streamoff>(csv.find("-2")));
+}
+
+BOOST_AUTO_TEST_CASE(test_file)
+{
+    fs::path csv_file{"test.core.stream.from_csv.test_file.csv"};
+    {
+        std::ofstream fout{csv_file};
+        fout << "comment\n" << "A|B\n" << "*1*|2\n" << "3|4\n";
+    }
+    std::vector<int> b;
+    for (auto&& batch : from_csv<Int>(csv_file, 10, {"B"}, 1, '|', '*')) {
+        b = std::get<Int>(batch).value();
+    }
+    BOOST_CHECK(b == (std::vector<int>{2, 4}));
+    fs::remove(csv_file);
+    BOOST_CHECK_THROW(from_csv<Int>("no_file.csv", 1, {"A"}), std::ios_base::failure);
+}
+
+#ifdef CXTREAM_BUILD_GZIP
+BOOST_AUTO_TEST_CASE(test_gzip_file)
+{
+    fs::path csv_file{"test.core.stream.from_csv.test_gzip_file.csv.gz"};
+    gzFile gz = gzopen(csv_file.c_str(), "wb");
+    gzwrite(gz, csv.data(), csv.size());
+    gzclose(gz);
+    std::vector<int> ids;
+    for (auto&& batch : from_csv<Int>(csv_file, 2, {"Id"})) {
+        auto& batch_ids = std::get<Int>(batch).value();
+        ids.insert(ids.end(), batch_ids.begin(), batch_ids.end());
+    }
+    BOOST_CHECK(ids == (std::vector<int>{1, -2, 3, 4, 5}));
+    fs::remove(csv_file);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(test_exceptions)
+{
+    std::istringstream in1{"A, B\n1, 2\n3, x\n"};
+    BOOST_CHECK_THROW(from_csv<Int>(in1, 1, {"C"}).begin(), std::out_of_range);
+
+    std::istringstream in2{"A, B\n1, 2\n3, x\n"};
+    auto rng = from_csv<Int>(in2, 1, {"B"});
+    auto it = rng.begin();
+    BOOST_CHECK_THROW(++it, std::ios_base::failure);
+
+    std::istringstream in3{"A, B\n1, 2\n3\n"};
+    auto rng3 = from_csv<Int>(in3, 1, {"A"});
+    auto it3 = rng3.begin();
+    BOOST_CHECK_THROW(++it3, std::ios_base::failure);
+
+    std::istringstream in4{csv};
+    BOOST_CHECK_THROW(from_csv<Int>(in4, 0, {"Id"}), std::invalid_argument);
+    BOOST_CHECK_THROW(from_csv<Int>(in4, 1, {"Id", "Name"}), std::invalid_argument);
+}
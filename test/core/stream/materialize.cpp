@@ -0,0 +1,161 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE materialize_view_test
+
+#include "../common.hpp"
+
+#include <cxtream/core/stream/materialize.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <range/v3/to_container.hpp>
+#include <range/v3/view/any_view.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+using namespace cxtream::stream;
+
+BOOST_AUTO_TEST_CASE(test_single_evaluation)
+{
+    int n_evaluations = 0;
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([&n_evaluations](int i) {
+            ++n_evaluations;
+            return i;
+        })
+      | materialize
+      | ranges::view::filter([](int i) { return i % 2 == 0; });
+
+    std::vector<int> generated = rng | ranges::to_vector;
+    test_ranges_equal(generated, std::vector<int>{0, 2, 4, 6, 8});
+    BOOST_TEST(n_evaluations == 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_repeated_read)
+{
+    int n_evaluations = 0;
+    auto rng = ranges::view::iota(0, 3)
+      | ranges::view::transform([&n_evaluations](int i) {
+            ++n_evaluations;
+            return i;
+        })
+      | materialize;
+
+    auto it = ranges::begin(rng);
+    BOOST_TEST(*it == 0);
+    BOOST_TEST(*it == 0);
+    ++it;
+    BOOST_TEST(*it == 1);
+    BOOST_TEST(n_evaluations == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_independent_iterators)
+{
+    int n_evaluations = 0;
+    auto rng = ranges::view::iota(0, 3)
+      | ranges::view::transform([&n_evaluations](int i) {
+            ++n_evaluations;
+            return i;
+        })
+      | materialize;
+    static_assert(ranges::ForwardRange<decltype(rng)>());
+
+    auto it1 = ranges::begin(rng);
+    BOOST_TEST(*it1 == 0);
+    // a new iterator does not invalidate the cache of the first one
+    auto it2 = ranges::begin(rng);
+    ++it2;
+    BOOST_TEST(*it2 == 1);
+    BOOST_TEST(*it1 == 0);
+    BOOST_TEST(n_evaluations == 2);
+    // a copy at the same position shares the cache
+    auto it3 = it1;
+    BOOST_TEST(*it3 == 0);
+    BOOST_CHECK(it3 == it1);
+    ++it3;
+    BOOST_TEST(*it3 == 1);
+    BOOST_TEST(*it1 == 0);
+    BOOST_TEST(n_evaluations == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_input_range)
+{
+    // the copies of a cursor over a single pass range cannot be compared,
+    // so the result is still a single pass range
+    int n_evaluations = 0;
+    auto rng = ranges::any_view<int, ranges::category::input>{
+        ranges::view::iota(0, 3)
+      | ranges::view::transform([&n_evaluations](int i) {
+            ++n_evaluations;
+            return i;
+        })}
+      | materialize;
+    static_assert(ranges::InputRange<decltype(rng)>());
+    static_assert(!ranges::ForwardRange<decltype(rng)>());
+
+    auto it = ranges::begin(rng);
+    BOOST_TEST(*it == 0);
+    BOOST_TEST(*it == 0);
+    ++it;
+    BOOST_TEST(*it == 1);
+    ++it;
+    BOOST_TEST(*it == 2);
+    ++it;
+    BOOST_CHECK(it == ranges::end(rng));
+    BOOST_TEST(n_evaluations == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_cache_reuse)
+{
+    // the storage of the cache is reused once the previous element is released
+    auto rng = ranges::view::iota(0, 3)
+      | ranges::view::transform([](int i) { return std::vector<int>(100, i); })
+      | materialize;
+
+    auto it = ranges::begin(rng);
+    const std::vector<int>* first = &*it;
+    ++it;
+    BOOST_TEST(&*it == first);
+    BOOST_TEST((*it)[0] == 1);
+    // a copy still refers to the cached element, so a new cache is made
+    auto it2 = it;
+    ++it;
+    BOOST_TEST((*it2)[0] == 1);
+    BOOST_TEST((*it)[0] == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only)
+{
+    auto rng = ranges::view::iota(0, 3)
+      | ranges::view::transform([](int i) { return std::make_unique<int>(i); })
+      | materialize;
+    static_assert(std::is_same<std::unique_ptr<int>&,
+                               ranges::range_reference_t<decltype(rng)>>{});
+
+    // the cached elements are moved out using iter_move
+    std::vector<std::unique_ptr<int>> generated = rng | ranges::view::move | ranges::to_vector;
+    BOOST_TEST(generated.size() == 3);
+    BOOST_TEST(*generated.at(2) == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_reference_passthrough)
+{
+    // ranges of references have nothing to cache
+    std::vector<int> data = {1, 2, 3};
+    auto rng = data | materialize;
+    static_assert(ranges::RandomAccessRange<decltype(rng)>());
+    BOOST_TEST(&*ranges::begin(rng) == &data[0]);
+}
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE pack_test
+
+#include "common.hpp"
+
+#include <cxtream/core/stream/create.hpp>
+#include <cxtream/core/stream/pack.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+using namespace cxtream::stream;
+
+CXTREAM_DEFINE_COLUMN(tokens, std::vector<int>)
+CXTREAM_DEFINE_COLUMN(labels, std::vector<char>)
+CXTREAM_DEFINE_COLUMN(segments, std::vector<int>)
+CXTREAM_DEFINE_COLUMN(positions, std::vector<long>)
+
+// get the indices of the examples packed in each row of each batch
+template<typename Rng>
+std::vector<std::vector<std::vector<int>>> packed_examples(Rng&& rng)
+{
+    std::vector<std::vector<std::vector<int>>> examples;
+    for (auto& batch : collect_batches(rng)) {
+        examples.emplace_back();
+        auto& batch_tokens = std::get<tokens>(batch).value();
+        auto& batch_positions = std::get<positions>(batch).value();
+        for (std::size_t row = 0; row < batch_tokens.size(); ++row) {
+            examples.back().emplace_back();
+            for (std::size_t i = 0; i < batch_tokens[row].size(); ++i) {
+                if (batch_positions[row][i] == 0) {
+                    examples.back().back().push_back(batch_tokens[row][i] / 10);
+                }
+            }
+        }
+    }
+    return examples;
+}
+
+BOOST_AUTO_TEST_CASE(test_greedy)
+{
+    auto data = generate_sequences({3, 2, 4, 1, 5});
+    auto rng = data | create<tokens>(2) | pack(from<tokens>, to<segments, positions>, 6);
+    auto it = rng.begin();
+    BOOST_CHECK(std::get<tokens>(*it).value()
+                == (std::vector<std::vector<int>>{{0, 1, 2, 10, 11}}));
+    BOOST_CHECK(std::get<segments>(*it).value()
+                == (std::vector<std::vector<int>>{{1, 1, 1, 2, 2}}));
+    BOOST_CHECK(std::get<positions>(*it).value()
+                == (std::vector<std::vector<long>>{{0, 1, 2, 0, 1}}));
+    auto examples = packed_examples(rng);
+    std::vector<std::vector<std::vector<int>>> desired = {{{0, 1}}, {{2, 3}}, {{4}}};
+    BOOST_CHECK(examples == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_first_fit)
+{
+    auto data = generate_sequences({4, 4, 2, 2, 3, 1});
+    auto rng = data | create<tokens>(3) | pack(from<tokens>, to<segments, positions>, 6, 2);
+    auto examples = packed_examples(rng);
+    // the third example fits to the first row and the fourth to the second row
+    std::vector<std::vector<std::vector<int>>> desired = {{{0, 2}, {1, 3}}, {{4, 5}}};
+    BOOST_CHECK(examples == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_multiple_columns)
+{
+    std::vector<std::tuple<Int, tokens, labels>> data;
+    data.emplace_back(Int{0}, tokens{{1, 2}}, labels{{'a', 'b'}});
+    data.emplace_back(Int{1}, tokens{{3}}, labels{{'c'}});
+    data.emplace_back(Int{2}, tokens{{4, 5, 6}}, labels{{'d', 'e', 'f'}});
+    auto rng = data | pack(from<tokens, labels>, to<segments, positions>, 4);
+    // the columns which are not packed are dropped
+    using batch_type = std::decay_t<decltype(*rng.begin())>;
+    static_assert(std::is_same<batch_type, std::tuple<tokens, labels, segments, positions>>{});
+    auto batches = collect_batches(rng);
+    std::vector<std::vector<char>> all_labels = flatten_column<labels>(batches);
+    std::vector<std::vector<int>> all_segments = flatten_column<segments>(batches);
+    BOOST_CHECK(all_labels == (std::vector<std::vector<char>>{{'a', 'b', 'c'}, {'d', 'e', 'f'}}));
+    BOOST_CHECK(all_segments == (std::vector<std::vector<int>>{{1, 1, 2}, {1, 1, 1}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_empty_examples)
+{
+    auto data = generate_sequences({0, 2, 0, 0, 1});
+    auto rng = data | create<tokens>(2) | pack(from<tokens>, to<segments, positions>, 3);
+    auto examples = packed_examples(rng);
+    std::vector<std::vector<std::vector<int>>> desired = {{{1, 4}}};
+    BOOST_CHECK(examples == desired);
+
+    std::vector<std::vector<int>> no_data;
+    auto empty_rng = no_data | create<tokens>(2) | pack(from<tokens>, to<segments, positions>, 3);
+    BOOST_TEST(packed_examples(empty_rng).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_too_long)
+{
+    auto data = generate_sequences({2, 7});
+    auto rng = data | create<tokens>(2) | pack(from<tokens>, to<segments, positions>, 6);
+    BOOST_CHECK_THROW(rng.begin(), std::length_error);
+    BOOST_CHECK_THROW(data | create<tokens>(2) | pack(from<tokens>, to<segments, positions>, 0),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_recycling)
+{
+    auto data = generate_sequences({4, 4, 4, 4});
+    auto rng = data | create<tokens>(1) | pack(from<tokens>, to<segments, positions>, 6);
+    std::vector<const int*> row_data;
+    for (auto&& batch : rng) {
+        auto& row = std::get<tokens>(batch).value().at(0);
+        BOOST_TEST(row.capacity() >= 6U);
+        row_data.push_back(row.data());
+    }
+    BOOST_TEST(row_data.size() == 4U);
+    // the rows of the previous batch are reused once the batch is released
+    BOOST_TEST(row_data[2] == row_data[0]);
+    BOOST_TEST(row_data[3] == row_data[1]);
+}
@@ -25,6 +25,8 @@ using namespace cxtream::utility;
 CXTREAM_DEFINE_COLUMN(sequences_2d, std::vector<int>)
 CXTREAM_DEFINE_COLUMN(sequences_3d, std::list<std::vector<double>>)
 CXTREAM_DEFINE_COLUMN(masks_2d, std::vector<bool>)
+CXTREAM_DEFINE_COLUMN(ragged_2d, cxtream::ragged<int, 1>)
+CXTREAM_DEFINE_COLUMN(ragged_masks_2d, cxtream::ragged<char, 1>)
 
 BOOST_AUTO_TEST_CASE(test_seq_2d_mask_2d)
 {
@@ -88,3 +90,38 @@ BOOST_AUTO_TEST_CASE(test_seq_3d_mask_2d)
         ++batch_i;
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_ragged_2d)
+{
+    std::vector<std::vector<int>> data = {{1, 2}, {3, 4, 5}, {}, {6, 7}};
+    auto stream = data
+      | create<ragged_2d>(2)
+      | pad(from<ragged_2d>, mask<masks_2d>, -1)
+      | pad(from<ragged_2d>, mask<ragged_masks_2d>, -1);
+
+    int batch_i = 0;
+    for (auto batch : stream) {
+        auto seqs = std::get<ragged_2d>(batch).value();
+        auto mask = std::get<masks_2d>(batch).value();
+        auto ragged_mask = std::get<ragged_masks_2d>(batch).value();
+
+        // check the contents
+        switch (batch_i) {
+        case 0: BOOST_CHECK((seqs ==
+                  cxtream::ragged<int, 2>{{1, 2, -1}, {3, 4, 5}}));
+                BOOST_CHECK((mask ==
+                  std::vector<std::vector<bool>>{{true, true, false}, {true, true, true}}));
+                break;
+        case 1: BOOST_CHECK((seqs ==
+                  cxtream::ragged<int, 2>{{-1, -1}, {6, 7}}));
+                BOOST_CHECK((mask ==
+                  std::vector<std::vector<bool>>{{false, false}, {true, true}}));
+                break;
+        default: BOOST_FAIL("Only two batches should be provided");
+        }
+        // the second padding does not change anything
+        BOOST_TEST(ragged_mask.values() == std::vector<char>(seqs.numel(), 1),
+                   boost::test_tools::per_element());
+        ++batch_i;
+    }
+}
@@ -0,0 +1,140 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE pipe_view_test
+
+#include "../common.hpp"
+
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/stream/pipe.hpp>
+#include <cxtream/core/stream/transform.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <range/v3/to_container.hpp>
+#include <range/v3/view/indirect.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/take.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cxtream::stream;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(test_simple_traverse)
+{
+    std::vector<int> data = {1, 2, 3, 4, 5};
+    auto rng1 = pipe(data, 2);
+    auto rng2 = data | pipe;
+
+    auto it1 = ranges::begin(rng1);
+    static_assert(std::is_same<int&, decltype(*it1)>{});
+    BOOST_TEST(*it1 == 1);
+
+    test_ranges_equal(rng1, data);
+    test_ranges_equal(rng2, data);
+}
+
+BOOST_AUTO_TEST_CASE(test_repeated_dereference)
+{
+    // the element is not moved from when it is dereferenced
+    std::vector<std::vector<int>> data = {{1, 2}, {3}};
+    auto rng = data | pipe(2);
+    auto it = ranges::begin(rng);
+    BOOST_TEST(*it == data[0]);
+    BOOST_TEST(*it == data[0]);
+    ++it;
+    BOOST_TEST(*it == data[1]);
+    BOOST_TEST(*it == data[1]);
+}
+
+BOOST_AUTO_TEST_CASE(test_dedicated_thread)
+{
+    // the upstream range is evaluated by another thread
+    std::vector<std::thread::id> ids;
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([&ids](int i) {
+            ids.push_back(std::this_thread::get_id());
+            return i;
+        })
+      | pipe(3);
+    test_ranges_equal(rng, ranges::view::iota(0, 10));
+    BOOST_TEST(ids.size() == 10U);
+    for (auto id : ids) BOOST_CHECK(id != std::this_thread::get_id());
+}
+
+BOOST_AUTO_TEST_CASE(test_bounded)
+{
+    // the producer is at most the capacity of the queue (and the element
+    // being pushed) ahead of the consumer
+    std::atomic<int> n_evaluated{0};
+    auto rng = ranges::view::iota(0, 100)
+      | ranges::view::transform([&n_evaluated](int i) {
+            ++n_evaluated;
+            return i;
+        })
+      | pipe(4);
+    auto it = ranges::begin(rng);
+    std::this_thread::sleep_for(20ms);
+    // nothing is evaluated before the first access
+    BOOST_TEST(n_evaluated == 0);
+    BOOST_TEST(*it == 0);
+    std::this_thread::sleep_for(20ms);
+    BOOST_TEST(n_evaluated <= 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_early_destruction)
+{
+    // the producer of an infinite range is stopped when the consumer is destroyed
+    auto rng = ranges::view::iota(0)
+      | ranges::view::transform([](int i) { return i; })
+      | pipe(2);
+    test_ranges_equal(rng | ranges::view::take(5), ranges::view::iota(0, 5));
+}
+
+BOOST_AUTO_TEST_CASE(test_exception)
+{
+    auto rng = ranges::view::iota(0, 10)
+      | ranges::view::transform([](int i) {
+            if (i == 5) throw std::invalid_argument{"5"};
+            return i;
+        })
+      | pipe(2);
+    auto it = ranges::begin(rng);
+    for (int i = 0; i < 5; ++i, ++it) BOOST_TEST(*it == i);
+    BOOST_CHECK_THROW(it != ranges::end(rng), std::invalid_argument);
+    // the range ends after the exception
+    BOOST_CHECK(it == ranges::end(rng));
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only_stream)
+{
+    // move only columns go through a chain of pipes
+    auto rng = ranges::view::iota(0, 6)
+      | ranges::view::transform([](int i) {
+            return std::make_tuple(Unique{std::make_unique<int>(i)});
+        })
+      | pipe(2)
+      | transform(from<Unique>, to<Unique>, [](const std::unique_ptr<int>& ptr) {
+            return std::make_unique<int>(*ptr + 1);
+        })
+      | pipe(2)
+      | batch(3);
+
+    int i = 1;
+    for (auto&& batch : rng) {
+        for (auto& ptr : std::get<0>(batch).value()) BOOST_TEST(*ptr == i++);
+    }
+    BOOST_TEST(i == 7);
+}
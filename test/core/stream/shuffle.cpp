@@ -0,0 +1,115 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE shuffle_test
+
+#include "common.hpp"
+
+#include <cxtream/core/stream/create.hpp>
+#include <cxtream/core/stream/shuffle.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/move.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace cxtream::stream;
+
+BOOST_AUTO_TEST_CASE(test_all_examples_preserved)
+{
+    std::mt19937 prng{42};
+    auto rng = ranges::view::iota(0, 1000) | create<Int>(10) | shuffle(100, prng);
+    std::vector<int> result = flatten_column<Int>(collect_batches(rng));
+    BOOST_TEST(result.size() == 1000U);
+    BOOST_TEST(!std::is_sorted(result.begin(), result.end()));
+    std::sort(result.begin(), result.end());
+    test_ranges_equal(result, ranges::view::iota(0, 1000));
+}
+
+BOOST_AUTO_TEST_CASE(test_deterministic)
+{
+    auto shuffled = [](unsigned seed) {
+        std::mt19937 prng{seed};
+        auto rng = ranges::view::iota(0, 1000) | create<Int>(7) | shuffle(50, prng);
+        return flatten_column<Int>(collect_batches(rng));
+    };
+    BOOST_CHECK(shuffled(3) == shuffled(3));
+    BOOST_CHECK(shuffled(3) != shuffled(4));
+}
+
+BOOST_AUTO_TEST_CASE(test_bounded_buffer)
+{
+    std::mt19937 prng{42};
+    auto rng = ranges::view::iota(0, 1000) | create<Int>(10) | shuffle(100, prng);
+    std::vector<int> result = flatten_column<Int>(collect_batches(rng));
+    // an example can not be yielded before it is read from the stream
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        BOOST_TEST(result[i] < static_cast<int>(i + 100));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_sizes)
+{
+    std::mt19937 prng{42};
+    auto rng = ranges::view::iota(0, 100) | create<Int>(10) | shuffle(25, prng);
+    std::vector<std::size_t> sizes = batch_sizes(collect_batches(rng));
+    // nothing is yielded until the buffer is full, then the incoming
+    // batch sizes are preserved and the buffer is drained at the end
+    std::vector<std::size_t> desired = {5, 10, 10, 10, 10, 10, 10, 10, 10, 10, 5};
+    BOOST_CHECK(sizes == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_larger_than_stream)
+{
+    std::mt19937 prng{42};
+    auto batches = collect_batches(ranges::view::iota(0, 15) | create<Int>(4) | shuffle(100, prng));
+    BOOST_CHECK(batch_sizes(batches) == (std::vector<std::size_t>{4, 4, 4, 3}));
+    std::vector<int> result = flatten_column<Int>(batches);
+    std::sort(result.begin(), result.end());
+    test_ranges_equal(result, ranges::view::iota(0, 15));
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only)
+{
+    std::vector<std::tuple<Int, Unique>> data;
+    for (int i = 0; i < 20; ++i) {
+        std::vector<std::unique_ptr<int>> batch;
+        batch.push_back(std::make_unique<int>(i));
+        data.emplace_back(Int{i}, Unique{std::move(batch)});
+    }
+    std::mt19937 prng{42};
+    auto rng = data | ranges::view::move | shuffle(5, prng);
+    std::vector<int> result;
+    for (auto&& batch : rng) {
+        auto& ids = std::get<Int>(batch).value();
+        auto& ptrs = std::get<Unique>(batch).value();
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            // the columns are shuffled together
+            BOOST_TEST(*ptrs[i] == ids[i]);
+            result.push_back(ids[i]);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    test_ranges_equal(result, ranges::view::iota(0, 20));
+}
+
+BOOST_AUTO_TEST_CASE(test_empty)
+{
+    std::vector<int> data;
+    std::mt19937 prng{42};
+    auto rng = data | create<Int>(2) | shuffle(5, prng);
+    BOOST_CHECK(rng.begin() == rng.end());
+    BOOST_CHECK_THROW(data | create<Int>(2) | shuffle(0, prng), std::invalid_argument);
+}
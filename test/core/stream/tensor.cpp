@@ -0,0 +1,117 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE stream_tensor_test
+
+#include "../common.hpp"
+
+#include <cxtream/core/stream/batch.hpp>
+#include <cxtream/core/stream/create.hpp>
+#include <cxtream/core/stream/pad.hpp>
+#include <cxtream/core/stream/transform.hpp>
+#include <cxtream/core/stream/unpack.hpp>
+#include <cxtream/core/tensor.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <range/v3/to_container.hpp>
+
+#include <numeric>
+#include <vector>
+
+using namespace cxtream;
+using namespace cxtream::stream;
+
+CXTREAM_DEFINE_COLUMN(image, tensor<int, 2>)
+CXTREAM_DEFINE_COLUMN(image_sum, int)
+CXTREAM_DEFINE_COLUMN(image_mask, std::vector<bool>)
+
+std::vector<tensor<int, 2>> generate_images()
+{
+    return {tensor<int, 2>({2, 2}, 1), tensor<int, 2>({2, 2}, 2), tensor<int, 2>({2, 2}, 3)};
+}
+
+BOOST_AUTO_TEST_CASE(test_create)
+{
+    auto rng = generate_images() | create<image>(2) | ranges::to_vector;
+    BOOST_TEST(rng.size() == 2);
+    auto batch1 = std::get<image>(rng[0]).value();
+    auto batch2 = std::get<image>(rng[1]).value();
+    static_assert(std::is_same<decltype(batch1), tensor<int, 3>>{});
+    BOOST_CHECK((batch1.shape() == std::array<std::size_t, 3>{2, 2, 2}));
+    BOOST_CHECK((batch2.shape() == std::array<std::size_t, 3>{1, 2, 2}));
+    BOOST_TEST(batch1(1, 0, 1) == 2);
+    BOOST_TEST(batch2(0, 1, 1) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_transform_dim1)
+{
+    auto rng = generate_images()
+      | create<image>(2)
+      | transform(from<image>, to<image_sum>, [](tensor_view<int, 2> img) {
+            return std::accumulate(img.data(), img.data() + img.numel(), 0);
+        })
+      | transform(from<image>, to<image>, [](tensor_view<int, 2> img) {
+            tensor<int, 2> res = img;
+            res(0, 0) = -1;
+            return res;
+        });
+    std::vector<int> sums;
+    std::vector<tensor<int, 2>> images;
+    std::tie(sums, images) = unpack(rng, from<image_sum, image>);
+    test_ranges_equal(sums, std::vector<int>{4, 8, 12});
+    BOOST_TEST(images.size() == 3);
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        BOOST_TEST(images[i](0, 0) == -1);
+        BOOST_TEST(images[i](1, 1) == (int)i + 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_transform_dim0)
+{
+    auto rng = generate_images()
+      | create<image>(3)
+      | transform(from<image>, to<image_sum>, [](const tensor<int, 3>& batch) {
+            std::vector<int> sums;
+            for (auto img : batch) {
+                sums.push_back(std::accumulate(img.data(), img.data() + img.numel(), 0));
+            }
+            return sums;
+        }, dim<0>);
+    test_ranges_equal(unpack(rng, from<image_sum>), std::vector<int>{4, 8, 12});
+}
+
+BOOST_AUTO_TEST_CASE(test_batch)
+{
+    auto rng = generate_images()
+      | create<image>(1)
+      | batch(2)
+      | ranges::to_vector;
+    BOOST_TEST(rng.size() == 2);
+    auto batch1 = std::get<image>(rng[0]).value();
+    BOOST_CHECK((batch1.shape() == std::array<std::size_t, 3>{2, 2, 2}));
+    BOOST_TEST(batch1(0, 0, 0) == 1);
+    BOOST_TEST(batch1(1, 0, 0) == 2);
+    auto batch2 = std::get<image>(rng[1]).value();
+    BOOST_CHECK((batch2.shape() == std::array<std::size_t, 3>{1, 2, 2}));
+    BOOST_TEST(batch2(0, 0, 0) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_pad)
+{
+    auto rng = generate_images()
+      | create<image>(2)
+      | pad(from<image>, mask<image_mask>)
+      | ranges::to_vector;
+    auto mask1 = std::get<image_mask>(rng[0]).value();
+    auto mask2 = std::get<image_mask>(rng[1]).value();
+    BOOST_CHECK((mask1 == std::vector<std::vector<bool>>{{true, true}, {true, true}}));
+    BOOST_CHECK((mask2 == std::vector<std::vector<bool>>{{true, true}}));
+    BOOST_CHECK((std::get<image>(rng[0]).value().shape() == std::array<std::size_t, 3>{2, 2, 2}));
+}
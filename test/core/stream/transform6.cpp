@@ -0,0 +1,118 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// The tests for stream::transform are split to multiple
+// files to speed up compilation in case of multiple CPUs.
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE transform6_test
+
+#include "transform.hpp"
+
+#include <cxtream/core/stream/buffer.hpp>
+
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using namespace cxtream::stream;
+
+BOOST_AUTO_TEST_CASE(test_parallel_preserves_order)
+{
+    // transform a large batch in parallel and check that the order is kept
+    std::vector<int> data = ranges::view::iota(0, 1000) | ranges::to_vector;
+    auto rng = data
+      | create<Int>(250)
+      | transform(from<Int>, to<Double>, [](int i) { return i * 2.; }, dim<1>, parallel<7>);
+
+    std::vector<double> generated = unpack(rng, from<Double>);
+    std::vector<double> desired = ranges::view::iota(0, 1000)
+      | ranges::view::transform([](int i) { return i * 2.; })
+      | ranges::to_vector;
+    BOOST_CHECK(generated == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_uses_multiple_threads)
+{
+    // the chunks should be processed by more than a single thread
+    std::vector<int> data = ranges::view::iota(0, 64) | ranges::to_vector;
+    std::mutex ids_mutex;
+    std::set<std::thread::id> ids;
+    auto rng = data
+      | create<Int>(64)
+      | transform(from<Int>, to<Int>, [&ids, &ids_mutex](int i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            std::lock_guard<std::mutex> lock{ids_mutex};
+            ids.insert(std::this_thread::get_id());
+            return i + 1;
+        }, dim<1>, parallel<4>);
+
+    std::vector<int> generated = unpack(rng, from<Int>);
+    test_ranges_equal(generated, ranges::view::iota(1, 65));
+    if (cxtream::global_thread_pool().n_threads() > 1) BOOST_TEST(ids.size() > 1U);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_one_to_two)
+{
+    // transform a single column to two columns
+    std::vector<std::tuple<Int>> data = {{{3, 4, 5}}, {{1}}};
+
+    auto generated = data
+      | transform(from<Int>, to<Int, Double>, [](int i) {
+            return std::make_tuple(i + i, (double)(i * i));
+        }, dim<1>, parallel<2>);
+
+    std::vector<std::tuple<Int, Double>> desired = {{{6, 8, 10}, {9., 16., 25.}}, {2, 1.}};
+    test_ranges_equal(generated, desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_dim2_move_only)
+{
+    auto data = generate_move_only_data();
+
+    auto rng = data
+      | ranges::view::move
+      | create<Int, UniqueVec>(2)
+      | transform(from<UniqueVec>, to<UniqueVec>, [](std::unique_ptr<int>& ptr) {
+            return std::make_unique<int>(*ptr + 1);
+        }, dim<2>, parallel<>)
+      | drop<Int>
+      | unique_vec_to_int_vec();
+
+    std::vector<std::vector<std::vector<int>>> generated = unpack(rng, from<IntVec>, dim<0>);
+    std::vector<std::vector<std::vector<int>>> desired = {{{2, 5}, {9, 3}}, {{3, 6}}};
+    BOOST_CHECK(generated == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_exception)
+{
+    // exception thrown in a chunk is propagated to the caller
+    std::vector<int> data = ranges::view::iota(0, 100) | ranges::to_vector;
+    auto rng = data
+      | create<Int>(100)
+      | transform(from<Int>, to<Int>, [](int i) {
+            if (i == 77) throw std::invalid_argument{"77"};
+            return i;
+        }, dim<1>, parallel<4>);
+
+    BOOST_CHECK_THROW(unpack(rng, from<Int>), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_inside_buffer)
+{
+    // parallel transforms evaluated by the thread pool itself must not deadlock
+    std::vector<int> data = ranges::view::iota(0, 1000) | ranges::to_vector;
+    auto rng = data
+      | create<Int>(10)
+      | transform(from<Int>, to<Int>, [](int i) { return i + 1; }, dim<1>, parallel<3>)
+      | buffer(50);
+
+    std::vector<int> generated = unpack(rng, from<Int>);
+    test_ranges_equal(generated, ranges::view::iota(1, 1001));
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+// The tests for stream::transform are split to multiple
+// files to speed up compilation in case of multiple CPUs.
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE transform7_test
+
+#include "transform.hpp"
+
+using namespace cxtream::stream;
+
+BOOST_AUTO_TEST_CASE(test_typed_preserves_random_access)
+{
+    std::vector<std::tuple<Int, Double>> data = {{3, 5.}, {1, 2.}, {7, 4.}};
+    auto rng = data
+      | transform(from<Int>, to<Double>, [](int i) { return i * 2.; }, dim<1>, typed)
+      | transform(from<Double>, to<Int>, [](double d) { return (int)d + 1; }, dim<1>, typed);
+    static_assert(ranges::RandomAccessRange<decltype(rng)>());
+
+    BOOST_TEST(ranges::size(rng) == 3U);
+    BOOST_TEST(std::get<Int>(rng[2]).value()[0] == 15);
+    BOOST_TEST(std::get<Double>(rng[0]).value()[0] == 6.);
+}
+
+BOOST_AUTO_TEST_CASE(test_typed_long_chain)
+{
+    std::vector<int> data = ranges::view::iota(0, 100) | ranges::to_vector;
+    auto add_one = transform(from<Int>, to<Int>, [](int i) { return i + 1; }, dim<1>, typed);
+    auto rng = data
+      | create<Int>(7)
+      | add_one | add_one | add_one | add_one | add_one
+      | add_one | add_one | add_one | add_one | add_one;
+
+    std::vector<int> generated = unpack(rng, from<Int>);
+    test_ranges_equal(generated, ranges::view::iota(10, 110));
+}
+
+BOOST_AUTO_TEST_CASE(test_typed_multidim)
+{
+    std::vector<std::vector<int>> data = {{1, 2}, {4}};
+    auto rng = data
+      | create<IntVec>(1)
+      | transform(from<IntVec>, to<IntVec>, [](int i) { return i * 3; }, dim<2>, typed);
+    std::vector<std::vector<int>> generated = unpack(rng, from<IntVec>);
+    std::vector<std::vector<int>> desired = {{3, 6}, {12}};
+    BOOST_CHECK(generated == desired);
+}
+
+BOOST_AUTO_TEST_CASE(test_typed_parallel)
+{
+    std::vector<std::tuple<Int>> data = {{{1, 2, 3}}, {{4, 5}}};
+    auto rng = data
+      | transform(from<Int>, to<Int>, [](int i) { return i * i; }, dim<1>, parallel<2>, typed);
+    static_assert(ranges::RandomAccessRange<decltype(rng)>());
+    std::vector<int> generated = unpack(rng, from<Int>);
+    test_ranges_equal(generated, std::vector<int>{1, 4, 9, 16, 25});
+}
+
+BOOST_AUTO_TEST_CASE(test_typed_and_erased_together)
+{
+    // both paths can be used in a single translation unit
+    std::vector<std::tuple<Int>> data = {{{1, 2}}, {{3}}};
+    auto fun = [](int i) { return i - 1; };
+    auto typed_rng = data | transform(from<Int>, to<Int>, fun, dim<1>, typed);
+    auto erased_rng = data | transform(from<Int>, to<Int>, fun);
+    static_assert(ranges::RandomAccessRange<decltype(typed_rng)>());
+    static_assert(!ranges::RandomAccessRange<decltype(erased_rng)>());
+    std::vector<int> typed_generated = unpack(typed_rng, from<Int>);
+    std::vector<int> erased_generated = unpack(erased_rng, from<Int>);
+    test_ranges_equal(typed_generated, erased_generated);
+}
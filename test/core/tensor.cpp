@@ -0,0 +1,140 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE tensor_test
+
+#include <cxtream/core/tensor.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+using namespace cxtream;
+
+using shape2 = std::array<std::size_t, 2>;
+using shape3 = std::array<std::size_t, 3>;
+
+BOOST_AUTO_TEST_CASE(test_construction)
+{
+    tensor<float, 2> t{{1, 2, 3}, {4, 5, 6}};
+    BOOST_CHECK(t.shape() == (shape2{2, 3}));
+    BOOST_TEST(t.size() == 2U);
+    BOOST_TEST(t.numel() == 6U);
+    BOOST_TEST(t(1, 2) == 6);
+    BOOST_TEST(t[0][1] == 2);
+    // the data are contiguous and aligned
+    BOOST_TEST(t.data()[4] == 5);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(t.data()) % 64 == 0U);
+
+    tensor<int, 3> z(shape3{2, 3, 4}, 7);
+    BOOST_TEST(z.numel() == 24U);
+    BOOST_TEST(z(1, 2, 3) == 7);
+}
+
+BOOST_AUTO_TEST_CASE(test_from_nested_vector)
+{
+    std::vector<std::vector<int>> vec = {{1, 2}, {3, 4}, {5, 6}};
+    tensor<int, 2> t = vec;
+    BOOST_CHECK(t.shape() == (shape2{3, 2}));
+    BOOST_TEST(t(2, 0) == 5);
+
+    std::vector<std::vector<int>> ragged = {{1, 2}, {3}};
+    BOOST_CHECK_THROW((tensor<int, 2>(ragged)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_iteration)
+{
+    tensor<int, 3> t(shape3{3, 2, 2});
+    int i = 0;
+    for (tensor_view<int, 2> sub : t) {
+        BOOST_CHECK(sub.shape() == (shape2{2, 2}));
+        for (tensor_view<int, 1> row : sub) {
+            for (int& elem : row) elem = i++;
+        }
+    }
+    BOOST_TEST(i == 12);
+    for (int j = 0; j < 12; ++j) BOOST_TEST(t.data()[j] == j);
+    BOOST_TEST(std::distance(t.begin(), t.end()) == 3);
+    BOOST_TEST(t[2](1, 0) == 10);
+
+    const tensor<int, 3>& ct = t;
+    tensor_view<const int, 2> csub = ct[1];
+    BOOST_TEST(csub(0, 1) == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_empty_subtensors)
+{
+    // the iteration works even if the subtensors have no elements
+    tensor<int, 2> t(shape2{4, 0});
+    BOOST_TEST(std::distance(t.begin(), t.end()) == 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_push_back)
+{
+    tensor<double, 3> batch;
+    batch.reserve(4);
+    BOOST_TEST(batch.empty());
+    batch.push_back(tensor<double, 2>{{1, 2}, {3, 4}});
+    batch.push_back(tensor<double, 2>{{5, 6}, {7, 8}});
+    BOOST_CHECK(batch.shape() == (shape3{2, 2, 2}));
+    BOOST_TEST(batch.capacity() >= 4U);
+    BOOST_TEST(batch(1, 0, 1) == 6);
+    BOOST_CHECK_THROW(batch.push_back(tensor<double, 2>{{1, 2, 3}}), std::invalid_argument);
+
+    // the subtensor shape is forgotten when the tensor is cleared
+    const double* data = batch.data();
+    batch.clear();
+    batch.push_back(tensor<double, 2>{{1, 2, 3}});
+    BOOST_CHECK(batch.shape() == (shape3{1, 1, 3}));
+    BOOST_TEST(batch.data() == data);
+}
+
+BOOST_AUTO_TEST_CASE(test_insert)
+{
+    tensor<int, 2> from{{1, 2}, {3, 4}, {5, 6}};
+    tensor<int, 2> to{{0, 0}};
+    to.insert(to.end(), std::make_move_iterator(from.begin() + 1),
+                        std::make_move_iterator(from.end()));
+    BOOST_CHECK(to == (tensor<int, 2>{{0, 0}, {3, 4}, {5, 6}}));
+
+    tensor<int, 1> flat{1, 2};
+    std::vector<int> more = {3, 4};
+    flat.insert(flat.end(), more.begin(), more.end());
+    BOOST_CHECK(flat == (tensor<int, 1>{1, 2, 3, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(test_view_copy)
+{
+    tensor<int, 2> t{{1, 2}, {3, 4}};
+    // converting a view to a tensor copies the data
+    tensor<int, 1> row = t[1];
+    row[0] = 10;
+    BOOST_TEST(t(1, 0) == 3);
+    // the view refers to the original data
+    tensor_view<int, 1> row_view = t[1];
+    row_view[0] = 10;
+    BOOST_TEST(t(1, 0) == 10);
+    BOOST_CHECK(t[1] == (tensor<int, 1>{10, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(test_reshape)
+{
+    tensor<int, 2> t{{1, 2, 3}, {4, 5, 6}};
+    t.reshape({3, 2});
+    BOOST_TEST(t(2, 1) == 6);
+    BOOST_CHECK_THROW(t.reshape({4, 2}), std::invalid_argument);
+    t.resize(4);
+    BOOST_CHECK(t.shape() == (shape2{4, 2}));
+    BOOST_TEST(t(3, 1) == 0);
+}
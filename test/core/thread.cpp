@@ -14,9 +14,14 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <cstdlib>
+#include <functional>
 #include <future>
 #include <memory>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -38,9 +43,9 @@ BOOST_AUTO_TEST_CASE(test_enqueue)
     std::shared_ptr<int> ptr3 = std::make_shared<int>(2);
 
     // run the tasks
-    std::future<int> f1 = tp.enqueue(task, ptr1);
-    std::future<int> f2 = tp.enqueue(task, ptr2);
-    std::future<int> f3 = tp.enqueue(task, ptr3);
+    cxtream::future<int> f1 = tp.enqueue(task, ptr1);
+    cxtream::future<int> f2 = tp.enqueue(task, ptr2);
+    cxtream::future<int> f3 = tp.enqueue(task, ptr3);
 
     // test that the processes run in parallel
     std::this_thread::sleep_for(20ms);
@@ -71,13 +76,22 @@ BOOST_AUTO_TEST_CASE(test_enqueue_move)
     // test that thread_pool.enqueue accepts move-only arguments
     cxtream::thread_pool tp{2};
     auto task = [](std::unique_ptr<int> ptr) { return *ptr; };
-    std::future<int> f = tp.enqueue(std::move(task), std::make_unique<int>(10));
+    cxtream::future<int> f = tp.enqueue(std::move(task), std::make_unique<int>(10));
     BOOST_TEST(f.get() == 10);
 }
 
+BOOST_AUTO_TEST_CASE(test_enqueue_reference)
+{
+    // test that thread_pool.enqueue accepts functions returning a reference
+    cxtream::thread_pool tp{2};
+    int value = 10;
+    cxtream::future<int&> f = tp.enqueue([&value]() -> int& { return value; });
+    BOOST_TEST(&f.get() == &value);
+}
+
 BOOST_AUTO_TEST_CASE(test_graceful_destruction)
 {
-    std::vector<std::future<int>> futures;
+    std::vector<cxtream::future<int>> futures;
     auto task = [](int i) {
         std::this_thread::sleep_for(50ms);
         return i;
@@ -94,3 +108,88 @@ BOOST_AUTO_TEST_CASE(test_graceful_destruction)
         BOOST_TEST(futures[i].get() == i);
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_global_thread_pool_size_from_env)
+{
+    unsigned hardware_threads = std::thread::hardware_concurrency();
+    setenv("CXTREAM_NUM_THREADS", "5", true);
+    BOOST_TEST(cxtream::detail::deduce_global_thread_pool_size() == 5U);
+    // invalid and absurd values fall back to the hardware concurrency
+    for (const char* env : {"-1", "0", "x", "3x", "", "99999999999999999999", "4294967295"}) {
+        setenv("CXTREAM_NUM_THREADS", env, true);
+        BOOST_TEST(cxtream::detail::deduce_global_thread_pool_size() == hardware_threads);
+    }
+    unsetenv("CXTREAM_NUM_THREADS");
+}
+
+BOOST_AUTO_TEST_CASE(test_global_thread_pool)
+{
+    // the size of the global thread pool can be set by an environment variable
+    setenv("CXTREAM_NUM_THREADS", "3", true);
+    cxtream::thread_pool& pool = cxtream::global_thread_pool();
+    BOOST_TEST(pool.n_threads() == 3U);
+    // there is only a single global pool
+    BOOST_TEST(&pool == &cxtream::global_thread_pool());
+    // the size cannot be changed once the pool exists
+    BOOST_CHECK_THROW(cxtream::set_global_thread_pool_size(2), std::logic_error);
+    BOOST_TEST(pool.enqueue([](int i) { return i + 1; }, 1).get() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_for)
+{
+    cxtream::thread_pool tp{3};
+    std::vector<int> data(1000, 0);
+    tp.parallel_for(data.size(), [&data](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) data[i] += i;
+    }, 7);
+    for (std::size_t i = 0; i < data.size(); ++i) BOOST_TEST_REQUIRE(data[i] == (int)i);
+    // the chunks are processed even if the pool is busy
+    tp.enqueue([]() { std::this_thread::sleep_for(50ms); });
+    tp.parallel_for(3, [&data](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) data[i] = -1;
+    });
+    BOOST_TEST(data[2] == -1);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_for_exception)
+{
+    cxtream::thread_pool tp{2};
+    std::atomic<int> n_done{0};
+    auto fun = [&n_done](std::size_t begin, std::size_t end) {
+        if (begin == 0) throw std::runtime_error{"fail"};
+        n_done += end - begin;
+    };
+    BOOST_CHECK_THROW(tp.parallel_for(10, fun, 5), std::runtime_error);
+    // the other chunks are finished before the exception is propagated
+    BOOST_TEST(n_done == 8);
+}
+
+BOOST_AUTO_TEST_CASE(test_fork_join)
+{
+    cxtream::thread_pool tp{2};
+    int a = 0, b = 0, c = 0;
+    tp.fork_join([&a]() { a = 1; }, [&b]() { b = 2; }, [&c]() { c = 3; });
+    BOOST_TEST(a == 1);
+    BOOST_TEST(b == 2);
+    BOOST_TEST(c == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_nested_wait)
+{
+    // a task waiting for its subtasks does not deadlock even a single thread
+    cxtream::thread_pool tp{1};
+    std::function<int(int)> fib = [&tp, &fib](int n) {
+        if (n < 2) return n;
+        cxtream::future<int> f1 = tp.enqueue(fib, n - 1);
+        cxtream::future<int> f2 = tp.enqueue(fib, n - 2);
+        return f1.get() + f2.get();
+    };
+    BOOST_TEST(tp.enqueue(fib, 15).get() == 610);
+
+    // nested parallel_for from inside the pool tasks
+    std::atomic<int> sum{0};
+    tp.parallel_for(4, [&tp, &sum](std::size_t begin, std::size_t end) {
+        tp.parallel_for(10, [&sum](std::size_t b, std::size_t e) { sum += e - b; });
+    }, 4);
+    BOOST_TEST(sum == 40);
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE future_test
+
+#include <cxtream/core/thread/future.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace cxtream;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(test_value)
+{
+    promise<std::unique_ptr<int>> prom;
+    future<std::unique_ptr<int>> fut = prom.get_future();
+    BOOST_CHECK(fut.valid());
+    BOOST_CHECK(!fut.is_ready());
+    BOOST_CHECK(fut.wait_for(1ms) == std::future_status::timeout);
+    std::thread thread{[prom = std::move(prom)]() mutable {
+        prom.set_value(std::make_unique<int>(3));
+    }};
+    BOOST_TEST(*fut.get() == 3);
+    BOOST_CHECK(!fut.valid());
+    thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_void)
+{
+    promise<void> prom;
+    future<void> fut = prom.get_future();
+    prom.set_value();
+    BOOST_CHECK(fut.is_ready());
+    fut.get();
+}
+
+BOOST_AUTO_TEST_CASE(test_exception)
+{
+    promise<int> prom;
+    future<int> fut = prom.get_future();
+    prom.set_from([]() -> int { throw std::runtime_error{"fail"}; });
+    BOOST_CHECK_THROW(fut.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_broken_promise)
+{
+    future<int> fut;
+    {
+        promise<int> prom;
+        fut = prom.get_future();
+        BOOST_CHECK_THROW(prom.get_future(), std::future_error);
+    }
+    BOOST_CHECK_THROW(fut.get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_reference)
+{
+    int value = 1;
+    promise<int&> prom;
+    future<int&> fut = prom.get_future();
+    prom.set_value(value);
+    int& result = fut.get();
+    BOOST_TEST(&result == &value);
+
+    promise<int&> prom2;
+    shared_future<int&> fut2 = prom2.get_future().share();
+    prom2.set_from([&value]() -> int& { return value; });
+    fut2.get() = 3;
+    BOOST_TEST(value == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_no_state)
+{
+    auto error_code = [](auto&& fun) {
+        try {
+            fun();
+        } catch (const std::future_error& e) {
+            return e.code();
+        }
+        return std::error_code{};
+    };
+
+    promise<int> prom;
+    promise<int> prom2 = std::move(prom);
+    BOOST_CHECK(error_code([&prom]() { prom.get_future(); })
+                == std::future_errc::no_state);
+    future<int> fut = prom2.get_future();
+    BOOST_CHECK(error_code([&prom2]() { prom2.get_future(); })
+                == std::future_errc::future_already_retrieved);
+    prom2.set_value(1);
+    BOOST_CHECK(error_code([&prom2]() { prom2.get_future(); })
+                == std::future_errc::no_state);
+    BOOST_TEST(fut.get() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared)
+{
+    promise<int> prom;
+    shared_future<int> fut1 = prom.get_future().share();
+    shared_future<int> fut2 = fut1;
+    prom.set_value(5);
+    BOOST_TEST(fut1.get() == 5);
+    BOOST_TEST(fut2.get() == 5);
+    BOOST_TEST(fut1.get() == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_recycled)
+{
+    // states are reused and a recycled state does not carry the old result
+    for (int i = 0; i < 1000; ++i) {
+        promise<int> prom;
+        future<int> fut = prom.get_future();
+        if (i % 2) prom.set_value(i);
+        else prom.set_exception(std::make_exception_ptr(std::runtime_error{"fail"}));
+        if (i % 2) BOOST_TEST(fut.get() == i);
+        else BOOST_CHECK_THROW(fut.get(), std::runtime_error);
+    }
+}
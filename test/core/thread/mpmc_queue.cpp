@@ -0,0 +1,87 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE mpmc_queue_test
+
+#include <cxtream/core/thread/mpmc_queue.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using cxtream::detail::mpmc_queue;
+
+BOOST_AUTO_TEST_CASE(test_push_pop)
+{
+    mpmc_queue<int> queue{3};
+    BOOST_TEST(queue.capacity() == 4U);
+    int val = -1;
+    BOOST_TEST(!queue.try_pop(val));
+    // fill the queue several times to check the wrap around
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) BOOST_TEST(queue.try_push(int{i}));
+        BOOST_TEST(!queue.try_push(5));
+        for (int i = 0; i < 4; ++i) {
+            BOOST_TEST(queue.try_pop(val));
+            BOOST_TEST(val == i);
+        }
+        BOOST_TEST(!queue.try_pop(val));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only)
+{
+    mpmc_queue<std::unique_ptr<int>> queue{2};
+    auto ptr = std::make_unique<int>(1);
+    BOOST_TEST(queue.try_push(std::move(ptr)));
+    BOOST_TEST(queue.try_push(std::make_unique<int>(2)));
+    // failed push does not move from the value
+    auto ptr3 = std::make_unique<int>(3);
+    BOOST_TEST(!queue.try_push(std::move(ptr3)));
+    BOOST_CHECK(ptr3 != nullptr);
+    std::unique_ptr<int> out;
+    BOOST_TEST(queue.try_pop(out));
+    BOOST_TEST(*out == 1);
+    // the remaining element is destroyed with the queue
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent)
+{
+    // multiple producers and consumers transfer all the values exactly once
+    const int n_threads = 4;
+    const int n_values = 10000;
+    mpmc_queue<int> queue{64};
+    std::vector<std::vector<int>> popped(n_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&queue, t]() {
+            for (int i = t * n_values; i < (t + 1) * n_values; ++i) {
+                while (!queue.try_push(int{i})) std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&queue, &popped, t]() {
+            int val;
+            while ((int)popped[t].size() < n_values) {
+                if (queue.try_pop(val)) popped[t].push_back(val);
+                else std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    std::vector<int> all;
+    for (auto& vals : popped) all.insert(all.end(), vals.begin(), vals.end());
+    std::sort(all.begin(), all.end());
+    BOOST_TEST(all.size() == (std::size_t)n_threads * n_values);
+    for (int i = 0; i < (int)all.size(); ++i) BOOST_TEST_REQUIRE(all[i] == i);
+}
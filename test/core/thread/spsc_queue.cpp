@@ -0,0 +1,61 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE spsc_queue_test
+
+#include <cxtream/core/thread/spsc_queue.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <thread>
+
+using cxtream::detail::spsc_queue;
+
+BOOST_AUTO_TEST_CASE(test_push_pop)
+{
+    spsc_queue<std::unique_ptr<int>> queue{3};
+    BOOST_TEST(queue.capacity() == 4U);
+    std::unique_ptr<int> val;
+    BOOST_TEST(!queue.try_pop(val));
+    BOOST_CHECK(queue.empty());
+    // fill the queue several times to check the wrap around
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) BOOST_TEST(queue.try_push(std::make_unique<int>(i)));
+        auto rejected = std::make_unique<int>(4);
+        BOOST_TEST(!queue.try_push(std::move(rejected)));
+        BOOST_CHECK(rejected != nullptr);
+        for (int i = 0; i < 4; ++i) {
+            BOOST_TEST(queue.try_pop(val));
+            BOOST_TEST(*val == i);
+        }
+        BOOST_CHECK(queue.empty());
+    }
+    // the remaining elements are destroyed with the queue
+    queue.try_push(std::make_unique<int>(5));
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent)
+{
+    // all the values are transferred exactly once and in order
+    const int n_values = 100000;
+    spsc_queue<int> queue{16};
+    std::thread producer{[&queue]() {
+        for (int i = 0; i < n_values; ++i) {
+            while (!queue.try_push(int{i})) std::this_thread::yield();
+        }
+    }};
+    int val;
+    for (int i = 0; i < n_values; ++i) {
+        while (!queue.try_pop(val)) std::this_thread::yield();
+        BOOST_TEST_REQUIRE(val == i);
+    }
+    producer.join();
+}
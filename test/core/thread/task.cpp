@@ -0,0 +1,53 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE task_test
+
+#include <cxtream/core/thread/task.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <memory>
+
+using cxtream::detail::small_task;
+
+BOOST_AUTO_TEST_CASE(test_small_move_only)
+{
+    int result = 0;
+    auto ptr = std::make_shared<int>(5);
+    small_task task{[&result, uptr = std::make_unique<int>(5), ptr]() { result = *uptr + *ptr; }};
+    BOOST_TEST(ptr.use_count() == 2);
+    small_task task2 = std::move(task);
+    BOOST_CHECK(!task);
+    BOOST_CHECK(static_cast<bool>(task2));
+    BOOST_TEST(ptr.use_count() == 2);
+    task2();
+    BOOST_TEST(result == 10);
+    task2.reset();
+    BOOST_TEST(ptr.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_large)
+{
+    // functions larger than the inline storage are stored on the heap
+    std::array<char, small_task::inline_size + 1> data{};
+    data.back() = 7;
+    auto ptr = std::make_shared<int>(5);
+    int result = 0;
+    small_task task{[&result, data, ptr]() { result = data.back() + *ptr; }};
+    small_task task2;
+    task2 = std::move(task);
+    BOOST_TEST(ptr.use_count() == 2);
+    task2();
+    BOOST_TEST(result == 12);
+    task2 = small_task{};
+    BOOST_TEST(ptr.use_count() == 1);
+}
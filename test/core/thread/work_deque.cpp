@@ -0,0 +1,78 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE work_deque_test
+
+#include <cxtream/core/thread/work_deque.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using cxtream::detail::work_deque;
+
+BOOST_AUTO_TEST_CASE(test_pop_and_steal)
+{
+    work_deque<int> deque{3};
+    int val = -1;
+    BOOST_TEST(!deque.try_pop(val));
+    BOOST_TEST(!deque.try_steal(val));
+    // wrap around the ring several times
+    for (int round = 0; round < 3; ++round) {
+        BOOST_TEST(deque.try_push(1));
+        BOOST_TEST(deque.try_push(2));
+        BOOST_TEST(deque.try_push(3));
+        BOOST_TEST(!deque.try_push(4));
+        BOOST_TEST(deque.size() == 3U);
+        // the owner takes the newest value, the thieves take the oldest
+        BOOST_TEST(deque.try_pop(val));
+        BOOST_TEST(val == 3);
+        BOOST_TEST(deque.try_steal(val));
+        BOOST_TEST(val == 1);
+        BOOST_TEST(deque.try_pop(val));
+        BOOST_TEST(val == 2);
+        BOOST_TEST(!deque.try_pop(val));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_steal)
+{
+    // the values popped by the owner and stolen by the thieves are all distinct
+    const int n_values = 10000;
+    work_deque<int> deque{64};
+    std::vector<std::vector<int>> taken(3);
+    std::vector<std::thread> thieves;
+    std::atomic<bool> done{false};
+    for (int t = 1; t < 3; ++t) {
+        thieves.emplace_back([&deque, &taken, &done, t]() {
+            int val;
+            while (!done || deque.size() > 0) {
+                if (deque.try_steal(val)) taken[t].push_back(val);
+            }
+        });
+    }
+    int val;
+    for (int i = 0; i < n_values; ++i) {
+        while (!deque.try_push(int{i})) {
+            if (deque.try_pop(val)) taken[0].push_back(val);
+        }
+    }
+    done = true;
+    for (auto& thief : thieves) thief.join();
+
+    std::vector<int> all;
+    for (auto& vals : taken) all.insert(all.end(), vals.begin(), vals.end());
+    std::sort(all.begin(), all.end());
+    BOOST_TEST(all.size() == (std::size_t)n_values);
+    for (int i = 0; i < (int)all.size(); ++i) BOOST_TEST_REQUIRE(all[i] == i);
+}
@@ -0,0 +1,215 @@
+/****************************************************************************
+ *  cxtream library
+ *  Copyright (c) 2017, Cognexa Solutions s.r.o.
+ *  Author(s) Filip Matzner
+ *
+ *  This file is distributed under the MIT License.
+ *  See the accompanying file LICENSE.txt for the complete license agreement.
+ ****************************************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utility_compression_test
+
+#include <cxtream/core/utility/compression.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cxtream;
+using namespace cxtream::utility;
+
+// generate a compressible text of the given size
+std::string generate_text(std::size_t size)
+{
+    std::string text;
+    for (std::size_t i = 0; text.size() < size; ++i) {
+        text += std::to_string(i) + ", " + std::to_string(i * i % 1000) + ", \"field\"\n";
+    }
+    text.resize(size);
+    return text;
+}
+
+// read the whole stream using a small buffer
+std::string read_all(const std::string& data, std::size_t buffer_size)
+{
+    std::istringstream source{data};
+    decompressing_streambuf buffer{source, buffer_size};
+    std::istream in{&buffer};
+    in.exceptions(std::istream::badbit);
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+BOOST_AUTO_TEST_CASE(test_detect_compression)
+{
+    BOOST_CHECK(detect_compression("") == compression::none);
+    BOOST_CHECK(detect_compression("Id,A\n1,2\n") == compression::none);
+    BOOST_CHECK(detect_compression(std::string{"\x1f\x8b\x08\x00", 4}) == compression::gzip);
+    BOOST_CHECK(detect_compression(std::string{"\x28\xb5\x2f\xfd\x00", 5}) == compression::zstd);
+    BOOST_CHECK(detect_compression(std::string{"\x28\xb5", 2}) == compression::none);
+}
+
+BOOST_AUTO_TEST_CASE(test_uncompressed)
+{
+    std::string text = generate_text(100000);
+    BOOST_TEST(decompress(text) == text);
+    BOOST_TEST(decompress("") == "");
+    BOOST_TEST(read_all(text, 100) == text);
+    std::istringstream source{text};
+    decompressing_istream in{source};
+    std::string line;
+    std::getline(in, line);
+    BOOST_TEST(line == "0, 0, \"field\"");
+}
+
+#ifdef CXTREAM_BUILD_GZIP
+
+// compress the data to a single gzip member
+std::string gzip_compress(const std::string& data, int level = Z_DEFAULT_COMPRESSION)
+{
+    z_stream stream{};
+    deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string result(deflateBound(&stream, data.size()) + 32, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+    stream.avail_out = result.size();
+    BOOST_REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+// compress the data to bgzip blocks of the given size (and the empty end-of-file block)
+std::string bgzip_compress(const std::string& data, std::size_t block_size)
+{
+    std::string result;
+    auto put_le = [&result](std::size_t value, int n_bytes) {
+        for (int i = 0; i < n_bytes; ++i) result.push_back(static_cast<char>(value >> (8 * i)));
+    };
+    for (std::size_t pos = 0; pos <= data.size(); pos += block_size) {
+        std::string block = data.substr(pos, block_size);
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        std::string deflated(deflateBound(&stream, block.size()) + 32, '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(&block[0]);
+        stream.avail_in = block.size();
+        stream.next_out = reinterpret_cast<Bytef*>(&deflated[0]);
+        stream.avail_out = deflated.size();
+        BOOST_REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+        deflated.resize(stream.total_out);
+        deflateEnd(&stream);
+        result += std::string{"\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00" "BC\x02\x00", 16};
+        put_le(18 + deflated.size() + 8 - 1, 2);
+        result += deflated;
+        put_le(crc32(0, reinterpret_cast<const Bytef*>(block.data()), block.size()), 4);
+        put_le(block.size(), 4);
+        if (block.empty()) break;
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_gzip)
+{
+    std::string text = generate_text(1000000);
+    std::string gz = gzip_compress(text);
+    BOOST_CHECK(detect_compression(gz) == compression::gzip);
+    BOOST_CHECK(decompress(gz) == text);
+    BOOST_CHECK(read_all(gz, 100) == text);
+    // concatenated members
+    std::string gz2 = gz + gzip_compress("tail\n");
+    BOOST_CHECK(decompress(gz2) == text + "tail\n");
+    BOOST_CHECK(read_all(gz2, 1000) == text + "tail\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_gzip_exact_buffer)
+{
+    // the decompressed data exactly fill the initial output buffer
+    for (std::size_t size : {1UL << 16, 1UL << 17, 1UL << 19}) {
+        std::string zeros(size, '\0');
+        std::string gz = gzip_compress(zeros, 9);
+        BOOST_CHECK(decompress(gz) == zeros);
+        BOOST_CHECK(read_all(gz, size / 4) == zeros);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_bgzip)
+{
+    std::string text = generate_text(1000000);
+    std::string bgz = bgzip_compress(text, 50000);
+    thread_pool pool{3};
+    BOOST_CHECK(detect_compression(bgz) == compression::gzip);
+    BOOST_CHECK(decompress(bgz, pool) == text);
+    BOOST_CHECK(read_all(bgz, 1000) == text);
+    BOOST_CHECK(decompress(bgzip_compress("", 10), pool) == "");
+    // the blocks are read ahead and decompressed in parallel by the stream as well
+    std::istringstream source{bgz};
+    decompressing_istream in{source, pool};
+    BOOST_CHECK(std::string(std::istreambuf_iterator<char>{in}, {}) == text);
+    // a plain gzip member after the blocks is decompressed sequentially
+    std::string mixed = bgz + gzip_compress("tail\n");
+    BOOST_CHECK(read_all(mixed, 1000) == text + "tail\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_gzip_exceptions)
+{
+    std::string text = generate_text(100000);
+    std::string gz = gzip_compress(text);
+    std::string bgz = bgzip_compress(text, 10000);
+    // truncated data
+    BOOST_CHECK_THROW(decompress(gz.substr(0, gz.size() / 2)), std::ios_base::failure);
+    BOOST_CHECK_THROW(read_all(gz.substr(0, gz.size() - 1), 100), std::ios_base::failure);
+    // corrupted data
+    gz[gz.size() / 2] ^= 0x55;
+    BOOST_CHECK_THROW(decompress(gz), std::ios_base::failure);
+    BOOST_CHECK_THROW(read_all(bgz.substr(0, bgz.size() / 2), 1000), std::ios_base::failure);
+    // wrong decompressed size of a block
+    bgz[bgz.find("\x1f\x8b", 1) - 4] ^= 1;
+    BOOST_CHECK_THROW(decompress(bgz), std::ios_base::failure);
+    BOOST_CHECK_THROW(read_all(bgz, 1000), std::ios_base::failure);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(test_gzip_not_supported)
+{
+    BOOST_CHECK_THROW(decompress(std::string{"\x1f\x8b\x08\x00", 4}), std::ios_base::failure);
+}
+
+#endif
+
+#ifdef CXTREAM_BUILD_ZSTD
+
+BOOST_AUTO_TEST_CASE(test_zstd)
+{
+    std::string text = generate_text(1000000);
+    // compress the text to multiple frames
+    std::string zst;
+    for (std::size_t pos = 0; pos < text.size(); pos += 100000) {
+        std::size_t n = std::min<std::size_t>(100000, text.size() - pos);
+        std::string frame(ZSTD_compressBound(n), '\0');
+        std::size_t size = ZSTD_compress(&frame[0], frame.size(), text.data() + pos, n, 3);
+        BOOST_REQUIRE(!ZSTD_isError(size));
+        zst += frame.substr(0, size);
+    }
+    thread_pool pool{3};
+    BOOST_CHECK(detect_compression(zst) == compression::zstd);
+    BOOST_CHECK(decompress(zst, pool) == text);
+    BOOST_CHECK(read_all(zst, 1000) == text);
+    BOOST_CHECK_THROW(decompress(zst.substr(0, zst.size() - 1)), std::ios_base::failure);
+    BOOST_CHECK_THROW(read_all(zst.substr(0, zst.size() - 1), 1000), std::ios_base::failure);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(test_zstd_not_supported)
+{
+    BOOST_CHECK_THROW(decompress(std::string{"\x28\xb5\x2f\xfd\x00", 5}), std::ios_base::failure);
+}
+
+#endif
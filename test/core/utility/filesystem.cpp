@@ -14,6 +14,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
 #include <set>
 #include <string>
 
@@ -61,3 +62,35 @@ BOOST_AUTO_TEST_CASE(test_throws_when_pattern_unsatisfiable)
     BOOST_CHECK_THROW(create_temp_directory(temp_dir.filename()), std::runtime_error);
     fs::remove(temp_dir);
 }
+
+BOOST_AUTO_TEST_CASE(test_mapped_file)
+{
+    fs::path temp_dir = create_temp_directory(pattern);
+    fs::path file = temp_dir / "file.txt";
+    {
+        std::ofstream fout{file};
+        fout << "mapped\ncontents";
+    }
+    mapped_file mapping{file};
+    BOOST_TEST(mapping.view() == "mapped\ncontents");
+    mapped_file moved = std::move(mapping);
+    BOOST_TEST(moved.size() == 15UL);
+    BOOST_TEST(mapping.view().empty());
+    // the mapping stays valid after the file is removed
+    fs::remove(file);
+    BOOST_TEST(moved.view() == "mapped\ncontents");
+    BOOST_CHECK_THROW(mapped_file{file}, std::ios_base::failure);
+    BOOST_CHECK_THROW(mapped_file{temp_dir}, std::ios_base::failure);
+    fs::remove(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_empty_file)
+{
+    fs::path temp_dir = create_temp_directory(pattern);
+    fs::path file = temp_dir / "empty.txt";
+    std::ofstream{file};
+    mapped_file mapping{file};
+    BOOST_TEST(mapping.view().empty());
+    fs::remove(file);
+    fs::remove(temp_dir);
+}
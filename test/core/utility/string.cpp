@@ -16,6 +16,7 @@
 
 #include <experimental/filesystem>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -65,6 +66,38 @@ BOOST_AUTO_TEST_CASE(test_string_to__bool)
     BOOST_CHECK_THROW(string_to<bool>("2"), std::ios_base::failure);
 }
 
+BOOST_AUTO_TEST_CASE(test_string_view_to__arithmetic)
+{
+    auto i = string_view_to<long>("-42");
+    static_assert(std::is_same<long, decltype(i)>{});
+    BOOST_TEST(i == -42);
+    BOOST_TEST(string_view_to<int>("+7") == 7);
+    BOOST_TEST(string_view_to<double>("0.25") == 0.25);
+    BOOST_TEST(string_view_to<double>("-1e3") == -1000.);
+    BOOST_TEST(string_view_to<float>("+0.5") == 0.5);
+    // the string does not have to be null terminated
+    std::string_view view = std::string_view{"123,456"}.substr(0, 3);
+    BOOST_TEST(string_view_to<int>(view) == 123);
+    // the whole string has to be a number
+    BOOST_CHECK_THROW(string_view_to<int>(""), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<int>("+"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<int>("+-1"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<int>("12a"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<int>(" 12"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<int>("1.5"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<unsigned char>("256"), std::ios_base::failure);
+    BOOST_CHECK_THROW(string_view_to<double>("0,25"), std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(test_string_view_to__other)
+{
+    auto str = string_view_to<std::string>("test");
+    static_assert(std::is_same<std::string, decltype(str)>{});
+    BOOST_TEST(str == "test");
+    BOOST_TEST(string_view_to<bool>("yes") == true);
+    BOOST_CHECK_THROW(string_view_to<bool>("abc"), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(test_string__to_string)
 {
     std::string str1 = "test";
@@ -192,6 +192,52 @@ BOOST_AUTO_TEST_CASE(test_ndim_pad)
     BOOST_CHECK(v_3d == v_3d_gold);
 }
 
+BOOST_AUTO_TEST_CASE(test_ndim_max_size)
+{
+    std::vector<std::list<std::vector<int>>> vec = {{{1}, {2, 3}}, {}, {{4, 5, 6}}};
+    BOOST_CHECK((ndim_max_size<1>(vec) == std::vector<long>{3}));
+    BOOST_CHECK((ndim_max_size<2>(vec) == std::vector<long>{3, 2}));
+    BOOST_CHECK((ndim_max_size<3>(vec) == std::vector<long>{3, 2, 3}));
+    BOOST_CHECK((ndim_max_size<2>(std::vector<std::vector<int>>{}) == std::vector<long>{0, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(test_ndim_pad_mask)
+{
+    std::vector<std::vector<int>> v_2d =
+      {{1, 2    }, {3, 4, 5}, {          }, {6        }};
+    std::vector<std::vector<int>> v_2d_gold =
+      {{1, 2, -1}, {3, 4, 5}, {-1, -1, -1}, {6, -1, -1}};
+    std::vector<std::vector<bool>> m_2d_gold =
+      {{true, true, false}, {true, true, true}, {false, false, false}, {true, false, false}};
+    std::vector<std::vector<bool>> m_2d;
+    ndim_pad_mask<2>(v_2d, m_2d, -1);
+    BOOST_CHECK(v_2d == v_2d_gold);
+    BOOST_CHECK(m_2d == m_2d_gold);
+
+    // pad only the first two dimensions of a 3d vector
+    std::vector<std::list<std::vector<int>>> v_3d =
+      {{{1}, {2, 3}}, {{4, 5, 6}          }, {}};
+    std::vector<std::list<std::vector<int>>> v_3d_gold =
+      {{{1}, {2, 3}}, {{4, 5, 6}, {-1, -1}}, {{-1, -1}, {-1, -1}}};
+    std::vector<std::vector<char>> m_3d_gold = {{1, 1}, {1, 0}, {0, 0}};
+    // the previous content of the mask is discarded
+    std::vector<std::vector<char>> m_3d = {{1, 1, 1}};
+    ndim_pad_mask<2>(v_3d, m_3d, {-1, -1});
+    BOOST_CHECK(v_3d == v_3d_gold);
+    BOOST_CHECK(m_3d == m_3d_gold);
+
+    // pad all three dimensions
+    std::vector<std::list<std::vector<int>>> v_3d_full = {{{1}, {2, 3}}, {}};
+    std::vector<std::list<std::vector<int>>> v_3d_full_gold =
+      {{{1, 0}, {2, 3}}, {{0, 0}, {0, 0}}};
+    std::vector<std::vector<std::vector<int>>> m_3d_full;
+    std::vector<std::vector<std::vector<int>>> m_3d_full_gold =
+      {{{1, 0}, {1, 1}}, {{0, 0}, {0, 0}}};
+    ndim_pad_mask<3>(v_3d_full, m_3d_full);
+    BOOST_CHECK(v_3d_full == v_3d_full_gold);
+    BOOST_CHECK(m_3d_full == m_3d_full_gold);
+}
+
 BOOST_AUTO_TEST_CASE(test_flatten)
 {
     const std::vector<std::list<std::vector<int>>> vec = {
@@ -41,6 +41,20 @@ def main():
     assert(np.array_equal(pycpp.py_vector1d()[-1: 7], [3]))
     assert(np.array_equal(pycpp.py_vector1d()[-2:-1], [2]))
 
+    # tensors are converted to a single multidimensional ndarray
+    assert(isinstance(pycpp.py_tensor3d(), np.ndarray))
+    assert(pycpp.py_tensor3d().dtype == np.int32)
+    assert(pycpp.py_tensor3d().shape == (3, 3, 3))
+    assert(np.array_equal(pycpp.py_tensor3d(), [[[1, 2, 3]] * 3] * 3))
+    assert(pycpp.py_tensor_empty().shape == (0, 0))
+
+    # ragged arrays are converted to the flat values and the row splits
+    values, row_splits = pycpp.py_ragged2d()
+    assert(values.dtype == np.int32)
+    assert(np.array_equal(values, [1, 2, 3]))
+    assert(len(row_splits) == 1)
+    assert(np.array_equal(row_splits[0], [0, 2, 2, 3]))
+
     # It is not necessary to test the conversion more in here, since it is
     # already covered by cxtream::python::range,
     # cxtream::python::utility::to_ndarray or python's list.
@@ -50,6 +64,11 @@ def main():
     assert(list(columns["Int"]) == [1, 2])
     assert(list(columns["Double"]) == [9., 10.])
 
+    columns = pycpp.tensor_columns()
+    assert(isinstance(columns["Image"], np.ndarray))
+    assert(columns["Image"].dtype == np.float32)
+    assert(np.array_equal(columns["Image"], np.ones((2, 2, 3))))
+
 
 if __name__ == '__main__':
     main()
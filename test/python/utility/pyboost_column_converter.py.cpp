@@ -8,6 +8,8 @@
  ****************************************************************************/
 
 #include <cxtream/core/stream/column.hpp>
+#include <cxtream/core/ragged.hpp>
+#include <cxtream/core/tensor.hpp>
 #include <cxtream/python/initialize.hpp>
 #include <cxtream/python/utility/pyboost_column_converter.hpp>
 
@@ -42,10 +44,26 @@ auto py_vector3d()
     return cxtream::python::utility::to_python(vec3d);
 }
 
+auto py_tensor3d()
+{
+    return cxtream::python::utility::to_python(cxtream::tensor<std::int32_t, 3>(vec3d));
+}
+
+auto py_tensor_empty()
+{
+    return cxtream::python::utility::to_python(cxtream::tensor<double, 2>{});
+}
+
+auto py_ragged2d()
+{
+    return cxtream::python::utility::to_python(cxtream::ragged<std::int32_t, 2>{{1, 2}, {}, {3}});
+}
+
 // test columns_to_python //
 
 CXTREAM_DEFINE_COLUMN(Int, int)
 CXTREAM_DEFINE_COLUMN(Double, double)
+CXTREAM_DEFINE_COLUMN(Image, cxtream::tensor<float, 2>)
 
 py::dict columns()
 {
@@ -53,6 +71,12 @@ py::dict columns()
     return columns_to_python(std::tuple<Int, Double>{{1, 2}, {9., 10.}});
 }
 
+py::dict tensor_columns()
+{
+    using cxtream::python::utility::columns_to_python;
+    return columns_to_python(std::tuple<Image>{cxtream::tensor<float, 3>({2, 2, 3}, 1.f)});
+}
+
 BOOST_PYTHON_MODULE(pyboost_column_converter_py_cpp)
 {
     // initialize cxtream OpenCV converters, exceptions, etc.
@@ -63,5 +87,9 @@ BOOST_PYTHON_MODULE(pyboost_column_converter_py_cpp)
     py::def("py_vector1d", py_vector1d);
     py::def("py_vector2d", py_vector2d);
     py::def("py_vector3d", py_vector3d);
+    py::def("py_tensor3d", py_tensor3d);
+    py::def("py_tensor_empty", py_tensor_empty);
+    py::def("py_ragged2d", py_ragged2d);
     py::def("columns", columns);
+    py::def("tensor_columns", tensor_columns);
 }